@@ -48,6 +48,7 @@ BufferPoolManager::~BufferPoolManager() {
  * pointer
  */
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
   assert(page_id != INVALID_PAGE_ID);
   Page * page = nullptr;
   if (page_table_->Find(page_id, page)) {
@@ -101,6 +102,7 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
  * dirty flag of this page
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::lock_guard<std::mutex> lock(latch_);
   Page * page = nullptr;
   if (page_table_->Find(page_id, page)) {
     if (page->pin_count_ <= 0) {
@@ -131,6 +133,7 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
  * NOTE: make sure page_id != INVALID_PAGE_ID
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) { 
+  std::lock_guard<std::mutex> lock(latch_);
   Page * page = nullptr;
   if (page_id == INVALID_PAGE_ID || !page_table_->Find(page_id, page)) {
     return false;
@@ -148,6 +151,7 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
  * the page is found within page table, but pin_count != 0, return false
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id) { 
+  std::lock_guard<std::mutex> lock(latch_);
   Page * page = nullptr;
   if (page_id == INVALID_PAGE_ID || !page_table_->Find(page_id, page)) {
     return false;
@@ -158,6 +162,8 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   }
 
   page->ResetMemory();
+  // a stale page id read later finds a zeroed page, not what it used to hold
+  disk_manager_->WritePage(page_id, page->GetData());
   // add to free list, remove from lRU, and hashtable
   
   replacer_->Erase(page);
@@ -180,6 +186,7 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
  * into page table. return nullptr if all the pages in pool are pinned
  */
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {  
+  std::lock_guard<std::mutex> lock(latch_);
   Page * res = nullptr;
   if (!free_list_->empty()) {
     res = free_list_->front();
@@ -195,7 +202,8 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
   assert(res->pin_count_ == 0);
     
   if (res->is_dirty_) {
-    if (ENABLE_LOGGING) {
+    // header page has no LSN, record names sit where other pages keep it
+    if (ENABLE_LOGGING && res->page_id_ != HEADER_PAGE_ID) {
       while (res->GetLSN() > log_manager_->GetPersistentLSN()) {
         log_manager_->wakeUpFlushThread();
       }
@@ -17,13 +17,12 @@ bool LockManager::LockShared(Transaction *txn, const RID &rid) {
     // Grant it    
     req.granted_ids.insert(txnId);
     req.oldest_id_ = txnId;
+    req.lock_state_ = SHARED;
     LOG_INFO("LockShared granted for txn id %d, rid: %s", txnId, rid.ToString().c_str());
-    return true;
   } else {
     if (req.lock_state_ == SHARED) {
       req.granted_ids.insert(txnId);
       LOG_INFO("LockShared granted for txn id %d, rid: %s", txnId, rid.ToString().c_str());
-      return true;
     } else {
       
       // abort if tx id ls younger than current one. Number bigger means younger
@@ -181,7 +180,7 @@ bool LockManager::Unlock(Transaction *txn, const RID &rid) {
       }
   }
 
-  if (txn->GetState() != TransactionState::ABORTED) {
+  if (txn->GetState() == TransactionState::GROWING) {
     txn->SetState(TransactionState::SHRINKING);
   }  
 
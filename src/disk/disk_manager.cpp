@@ -27,6 +27,9 @@ DiskManager::DiskManager(const std::string &db_file)
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  // log buffers of a new log manager may sit where freed ones of an earlier
+  // disk manager did
+  buffer_used = nullptr;
 
   log_io_.open(log_name_,
                std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
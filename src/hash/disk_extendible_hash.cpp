@@ -0,0 +1,722 @@
+/**
+ * disk_extendible_hash.cpp
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/logger.h"
+#include "common/rid.h"
+#include "hash/disk_extendible_hash.h"
+#include "index/generic_key.h"
+#include "page/header_page.h"
+
+namespace cmudb {
+
+template <typename KeyType, typename ValueType>
+DISK_EXTENDIBLE_HASH_TYPE::DiskExtendibleHash(
+    const std::string &name, BufferPoolManager *buffer_pool_manager,
+    page_id_t directory_page_id, bool unique_key)
+    : index_name_(name), buffer_pool_manager_(buffer_pool_manager),
+      directory_page_id_(directory_page_id), unique_key_(unique_key) {}
+
+/*
+ * Helper function to decide whether current hash table is empty
+ */
+template <typename KeyType, typename ValueType>
+bool DISK_EXTENDIBLE_HASH_TYPE::IsEmpty() const {
+  return directory_page_id_ == INVALID_PAGE_ID;
+}
+
+/*
+ * helper function to calculate the hashing address of input key
+ * Trailing zero bytes are left out as bucket pages do, the directory uses
+ * the low bits of hash.
+ */
+template <typename KeyType, typename ValueType>
+uint32_t DISK_EXTENDIBLE_HASH_TYPE::HashKey(const KeyType &key) {
+  const char *data = reinterpret_cast<const char *>(&key);
+  int size = sizeof(KeyType);
+  while (size > 0 && data[size - 1] == 0) {
+    size--;
+  }
+  uint64_t hash = size;
+  for (int i = 0; i < size; i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, data + i, std::min<int>(sizeof(uint64_t), size - i));
+    hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+    hash ^= hash >> 29;
+  }
+  // finalizer of MurmurHash3 mixes every bit into the low ones
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDULL;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53ULL;
+  hash ^= hash >> 33;
+  return static_cast<uint32_t>(hash);
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the values associated with input key, scanning every page of its
+ * bucket under read latch of the first one
+ * @return : true means key exists
+ */
+template <typename KeyType, typename ValueType>
+bool DISK_EXTENDIBLE_HASH_TYPE::GetValue(const KeyType &key,
+                                         std::vector<ValueType> &result) {
+  table_latch_.RLock();
+  if (IsEmpty()) {
+    table_latch_.RUnlock();
+    return false;
+  }
+  page_id_t bucket_page_id = GetBucketPageId(HashKey(key));
+  Page *head = buffer_pool_manager_->FetchPage(bucket_page_id);
+  head->RLatch();
+  int found = 0;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID;) {
+    Page *page = (page_id == bucket_page_id)
+                     ? head
+                     : buffer_pool_manager_->FetchPage(page_id);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    found += bucket->GetValue(key, result);
+    page_id = bucket->GetNextPageId();
+    if (page != head) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+    // a unique key is stored once
+    if (unique_key_ && found > 0) {
+      break;
+    }
+  }
+  head->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  table_latch_.RUnlock();
+  return found > 0;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair into hash table
+ * A bucket with room for the pair takes it under shared table latch, a full
+ * one is split(or grows an overflow page) under exclusive table latch.
+ * @return: for unique key, if user try to insert duplicate keys return false,
+ * otherwise return true.
+ */
+template <typename KeyType, typename ValueType>
+bool DISK_EXTENDIBLE_HASH_TYPE::Insert(const KeyType &key,
+                                       const ValueType &value) {
+  uint32_t hash = HashKey(key);
+  InsertResult result = BUCKET_FULL;
+  table_latch_.RLock();
+  if (!IsEmpty()) {
+    page_id_t bucket_page_id = GetBucketPageId(hash);
+    Page *head = buffer_pool_manager_->FetchPage(bucket_page_id);
+    head->WLatch();
+    result = InsertIntoBucket(head, key, value, false);
+    head->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, result == INSERTED);
+  }
+  table_latch_.RUnlock();
+  if (result != BUCKET_FULL) {
+    return result == INSERTED;
+  }
+
+  table_latch_.WLock();
+  if (IsEmpty()) {
+    StartNewTable();
+  }
+  while (true) {
+    int local_depth;
+    page_id_t bucket_page_id = GetBucketPageId(hash, &local_depth);
+    Page *head = buffer_pool_manager_->FetchPage(bucket_page_id);
+    result = InsertIntoBucket(head, key, value, false);
+    if (result == BUCKET_FULL && !SplitHelps(head, hash, local_depth)) {
+      result = InsertIntoBucket(head, key, value, true);
+    }
+    buffer_pool_manager_->UnpinPage(bucket_page_id, result == INSERTED);
+    if (result != BUCKET_FULL) {
+      break;
+    }
+    SplitBucket(hash);
+  }
+  table_latch_.WUnlock();
+  return result == INSERTED;
+}
+
+/*
+ * Create the directory page, its first segment page and a single bucket of
+ * local depth zero, and record directory page id in header page
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::StartNewTable() {
+  LOG_INFO("Start new hash table");
+  page_id_t directory_page_id;
+  page_id_t segment_page_id;
+  page_id_t bucket_page_id;
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(
+      NewPage(directory_page_id)->GetData());
+  auto *segment = reinterpret_cast<HashTableSegmentPage *>(
+      NewPage(segment_page_id)->GetData());
+  auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(
+      NewPage(bucket_page_id)->GetData());
+
+  directory->Init(directory_page_id);
+  directory->PushSegment(segment_page_id);
+  segment->Init(segment_page_id);
+  segment->SetBucketPageId(0, bucket_page_id);
+  bucket->Init(bucket_page_id);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(segment_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id, true);
+
+  directory_page_id_ = directory_page_id;
+  UpdateDirectoryPageId();
+}
+
+/*
+ * Add key & value pair to the bucket starting at head page, unless the key
+ * (or the pair, for non-unique key) is in one of its pages already. Without
+ * room in any of them a new overflow page goes right behind head page if
+ * may_overflow, caller unpins head page dirty if the pair went in.
+ */
+template <typename KeyType, typename ValueType>
+typename DISK_EXTENDIBLE_HASH_TYPE::InsertResult
+DISK_EXTENDIBLE_HASH_TYPE::InsertIntoBucket(Page *head, const KeyType &key,
+                                            const ValueType &value,
+                                            bool may_overflow) {
+  page_id_t room_page_id = INVALID_PAGE_ID;
+  for (page_id_t page_id = head->GetPageId(); page_id != INVALID_PAGE_ID;) {
+    Page *page = (page_id == head->GetPageId())
+                     ? head
+                     : buffer_pool_manager_->FetchPage(page_id);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    bool duplicate =
+        unique_key_ ? bucket->Contains(key) : bucket->Contains(key, value);
+    if (room_page_id == INVALID_PAGE_ID && bucket->HasRoomFor(key)) {
+      room_page_id = page_id;
+    }
+    page_id = bucket->GetNextPageId();
+    if (page != head) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+    if (duplicate) {
+      return DUPLICATE;
+    }
+  }
+
+  auto *head_bucket =
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(head->GetData());
+  if (room_page_id == head->GetPageId()) {
+    head_bucket->Insert(key, value);
+    return INSERTED;
+  }
+  Page *page = nullptr;
+  if (room_page_id != INVALID_PAGE_ID) {
+    page = buffer_pool_manager_->FetchPage(room_page_id);
+  } else if (may_overflow) {
+    page = NewPage(room_page_id);
+    reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData())
+        ->Init(room_page_id, head_bucket->GetNextPageId());
+    head_bucket->SetNextPageId(room_page_id);
+  } else {
+    return BUCKET_FULL;
+  }
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData())
+      ->Insert(key, value);
+  buffer_pool_manager_->UnpinPage(room_page_id, true);
+  return INSERTED;
+}
+
+/*
+ * Splitting a full bucket only makes room if some of its keys differ from
+ * input key in the hash bits directory may still grow into
+ */
+template <typename KeyType, typename ValueType>
+bool DISK_EXTENDIBLE_HASH_TYPE::SplitHelps(Page *head, uint32_t hash,
+                                           int local_depth) {
+  int max_depth = HashTableDirectoryPage::GetMaxGlobalDepth();
+  if (local_depth >= max_depth) {
+    return false;
+  }
+  uint32_t mask = (1u << max_depth) - 1;
+  std::vector<MappingType> items;
+  for (page_id_t page_id = head->GetPageId(); page_id != INVALID_PAGE_ID;) {
+    Page *page = (page_id == head->GetPageId())
+                     ? head
+                     : buffer_pool_manager_->FetchPage(page_id);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    bucket->GetItems(items);
+    page_id = bucket->GetNextPageId();
+    if (page != head) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+  }
+  for (auto &item : items) {
+    if ((HashKey(item.first) & mask) != (hash & mask)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Split the bucket of input hash into itself and a new split image, which
+ * takes over the directory slots with bit local depth set. Directory doubles
+ * first if the bucket has as many bits as it does.
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::SplitBucket(uint32_t hash) {
+  page_id_t bucket_page_id;
+  int local_depth;
+  int global_depth = GetGlobalDepth();
+  GetSlot(hash & ((1u << global_depth) - 1), bucket_page_id, local_depth);
+  if (local_depth == global_depth) {
+    GrowDirectory();
+    global_depth++;
+  }
+
+  page_id_t image_page_id;
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(NewPage(image_page_id)->GetData())
+      ->Init(image_page_id);
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+  for (uint32_t i = hash & ((1u << local_depth) - 1); i < (1u << global_depth);
+       i += (1u << local_depth)) {
+    SetSlot(i, ((i >> local_depth) & 1) ? image_page_id : bucket_page_id,
+            local_depth + 1);
+  }
+
+  std::vector<MappingType> items;
+  std::vector<MappingType> stay;
+  std::vector<MappingType> move;
+  TakeItems(bucket_page_id, items);
+  for (auto &item : items) {
+    if ((HashKey(item.first) >> local_depth) & 1) {
+      move.push_back(item);
+    } else {
+      stay.push_back(item);
+    }
+  }
+  FillBucket(bucket_page_id, stay);
+  FillBucket(image_page_id, move);
+}
+
+/*
+ * Double the directory, slot i + 2^global depth points where slot i does
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::GrowDirectory() {
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  uint32_t size = 1u << directory->GetGlobalDepth();
+  int segment_count = (2 * size + HashTableSegmentPage::SLOT_COUNT - 1) /
+                      HashTableSegmentPage::SLOT_COUNT;
+  while (directory->GetSegmentCount() < segment_count) {
+    page_id_t segment_page_id;
+    reinterpret_cast<HashTableSegmentPage *>(
+        NewPage(segment_page_id)->GetData())
+        ->Init(segment_page_id);
+    buffer_pool_manager_->UnpinPage(segment_page_id, true);
+    directory->PushSegment(segment_page_id);
+  }
+  directory->SetGlobalDepth(directory->GetGlobalDepth() + 1);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+
+  for (uint32_t i = 0; i < size; i++) {
+    page_id_t bucket_page_id;
+    int local_depth;
+    GetSlot(i, bucket_page_id, local_depth);
+    SetSlot(i + size, bucket_page_id, local_depth);
+  }
+}
+
+/*
+ * Copy every pair out of a bucket and leave it a single empty page
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::TakeItems(page_id_t bucket_page_id,
+                                          std::vector<MappingType> &items) {
+  Page *head = buffer_pool_manager_->FetchPage(bucket_page_id);
+  auto *head_bucket =
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(head->GetData());
+  head_bucket->GetItems(items);
+  page_id_t page_id = head_bucket->GetNextPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    bucket->GetItems(items);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+  head_bucket->Init(bucket_page_id);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+}
+
+/*
+ * Insert pairs into an empty bucket, adding overflow pages as it fills up
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::FillBucket(
+    page_id_t bucket_page_id, const std::vector<MappingType> &items) {
+  Page *head = buffer_pool_manager_->FetchPage(bucket_page_id);
+  auto *head_bucket =
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(head->GetData());
+  Page *page = head;
+  for (auto &item : items) {
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    if (bucket->Insert(item.first, item.second)) {
+      continue;
+    }
+    if (page != head) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    }
+    page_id_t overflow_page_id;
+    page = NewPage(overflow_page_id);
+    bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    bucket->Init(overflow_page_id, head_bucket->GetNextPageId());
+    head_bucket->SetNextPageId(overflow_page_id);
+    bucket->Insert(item.first, item.second);
+  }
+  if (page != head) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete one value of input key
+ * Nothing happens if the key is not stored with input value. A page left
+ * empty is unlinked from its bucket, and an empty bucket merged with its
+ * split image, under exclusive table latch.
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::Remove(const KeyType &key,
+                                       const ValueType &value) {
+  uint32_t hash = HashKey(key);
+  table_latch_.RLock();
+  if (IsEmpty()) {
+    table_latch_.RUnlock();
+    return;
+  }
+  page_id_t bucket_page_id = GetBucketPageId(hash);
+  Page *head = buffer_pool_manager_->FetchPage(bucket_page_id);
+  head->WLatch();
+  bool removed = false;
+  bool emptied = false;
+  for (page_id_t page_id = bucket_page_id;
+       page_id != INVALID_PAGE_ID && !removed;) {
+    Page *page = (page_id == bucket_page_id)
+                     ? head
+                     : buffer_pool_manager_->FetchPage(page_id);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    removed = bucket->Remove(key, value);
+    emptied = removed && bucket->IsEmpty();
+    page_id = bucket->GetNextPageId();
+    if (page != head) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+    }
+  }
+  head->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  table_latch_.RUnlock();
+  if (!emptied) {
+    return;
+  }
+
+  // pages may have been filled again meanwhile, both steps check
+  table_latch_.WLock();
+  RemoveEmptyPages(GetBucketPageId(hash));
+  MergeBucket(hash);
+  table_latch_.WUnlock();
+}
+
+/*
+ * Unlink empty overflow pages of a bucket, an empty first page takes over
+ * the pairs of the page behind it
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::RemoveEmptyPages(page_id_t bucket_page_id) {
+  Page *head = buffer_pool_manager_->FetchPage(bucket_page_id);
+  auto *head_bucket =
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(head->GetData());
+  Page *prev = head;
+  page_id_t page_id = head_bucket->GetNextPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (bucket->IsEmpty()) {
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(prev->GetData())
+          ->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    } else {
+      if (prev != head) {
+        buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+      }
+      prev = page;
+    }
+    page_id = next_page_id;
+  }
+  if (prev != head) {
+    buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+  }
+
+  page_id = head_bucket->GetNextPageId();
+  if (head_bucket->IsEmpty() && page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    std::vector<MappingType> items;
+    bucket->GetItems(items);
+    head_bucket->Init(bucket_page_id, bucket->GetNextPageId());
+    for (auto &item : items) {
+      head_bucket->Insert(item.first, item.second);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+}
+
+/*
+ * Fold an empty bucket into its split image while both have the same local
+ * depth, the image takes over its directory slots
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::MergeBucket(uint32_t hash) {
+  while (true) {
+    uint32_t slot_index = hash & ((1u << GetGlobalDepth()) - 1);
+    page_id_t bucket_page_id;
+    int local_depth;
+    GetSlot(slot_index, bucket_page_id, local_depth);
+    if (local_depth == 0) {
+      return;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+    bool empty =
+        reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData())->IsEmpty();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (!empty) {
+      return;
+    }
+    page_id_t image_page_id;
+    int image_local_depth;
+    GetSlot(slot_index ^ (1u << (local_depth - 1)), image_page_id,
+            image_local_depth);
+    if (image_local_depth != local_depth) {
+      return;
+    }
+
+    uint32_t size = 1u << GetGlobalDepth();
+    for (uint32_t i = slot_index & ((1u << (local_depth - 1)) - 1); i < size;
+         i += (1u << (local_depth - 1))) {
+      SetSlot(i, image_page_id, local_depth - 1);
+    }
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    ShrinkDirectory();
+  }
+}
+
+/*
+ * Halve the directory while every bucket has fewer bits than it does, and
+ * give back segment pages it no longer needs
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::ShrinkDirectory() {
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  int global_depth = directory->GetGlobalDepth();
+  bool shrink = true;
+  while (global_depth > 0 && shrink) {
+    uint32_t size = 1u << global_depth;
+    for (uint32_t i = 0; i < size && shrink;
+         i += HashTableSegmentPage::SLOT_COUNT) {
+      page_id_t segment_page_id =
+          directory->GetSegmentPageId(i / HashTableSegmentPage::SLOT_COUNT);
+      auto *segment = reinterpret_cast<HashTableSegmentPage *>(
+          buffer_pool_manager_->FetchPage(segment_page_id)->GetData());
+      for (uint32_t slot = 0;
+           slot < (uint32_t)HashTableSegmentPage::SLOT_COUNT &&
+           i + slot < size;
+           slot++) {
+        if (segment->GetLocalDepth(slot) == global_depth) {
+          shrink = false;
+          break;
+        }
+      }
+      buffer_pool_manager_->UnpinPage(segment_page_id, false);
+    }
+    if (shrink) {
+      global_depth--;
+    }
+  }
+  directory->SetGlobalDepth(global_depth);
+  int segment_count = ((1u << global_depth) + HashTableSegmentPage::SLOT_COUNT -
+                       1) / HashTableSegmentPage::SLOT_COUNT;
+  while (directory->GetSegmentCount() > segment_count) {
+    buffer_pool_manager_->DeletePage(directory->PopSegment());
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+/*
+ * Page id of the first page of the bucket input hash belongs to
+ */
+template <typename KeyType, typename ValueType>
+page_id_t DISK_EXTENDIBLE_HASH_TYPE::GetBucketPageId(uint32_t hash,
+                                                     int *local_depth) {
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  uint32_t slot_index = directory->GetSlotIndex(hash);
+  page_id_t segment_page_id =
+      directory->GetSegmentPageId(slot_index / HashTableSegmentPage::SLOT_COUNT);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  page = buffer_pool_manager_->FetchPage(segment_page_id);
+  auto *segment = reinterpret_cast<HashTableSegmentPage *>(page->GetData());
+  int slot = slot_index % HashTableSegmentPage::SLOT_COUNT;
+  page_id_t bucket_page_id = segment->GetBucketPageId(slot);
+  if (local_depth != nullptr) {
+    *local_depth = segment->GetLocalDepth(slot);
+  }
+  buffer_pool_manager_->UnpinPage(segment_page_id, false);
+  return bucket_page_id;
+}
+
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::GetSlot(uint32_t slot_index,
+                                        page_id_t &bucket_page_id,
+                                        int &local_depth) {
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  page_id_t segment_page_id =
+      reinterpret_cast<HashTableDirectoryPage *>(page->GetData())
+          ->GetSegmentPageId(slot_index / HashTableSegmentPage::SLOT_COUNT);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  page = buffer_pool_manager_->FetchPage(segment_page_id);
+  auto *segment = reinterpret_cast<HashTableSegmentPage *>(page->GetData());
+  int slot = slot_index % HashTableSegmentPage::SLOT_COUNT;
+  bucket_page_id = segment->GetBucketPageId(slot);
+  local_depth = segment->GetLocalDepth(slot);
+  buffer_pool_manager_->UnpinPage(segment_page_id, false);
+}
+
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::SetSlot(uint32_t slot_index,
+                                        page_id_t bucket_page_id,
+                                        int local_depth) {
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  page_id_t segment_page_id =
+      reinterpret_cast<HashTableDirectoryPage *>(page->GetData())
+          ->GetSegmentPageId(slot_index / HashTableSegmentPage::SLOT_COUNT);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  page = buffer_pool_manager_->FetchPage(segment_page_id);
+  auto *segment = reinterpret_cast<HashTableSegmentPage *>(page->GetData());
+  int slot = slot_index % HashTableSegmentPage::SLOT_COUNT;
+  segment->SetBucketPageId(slot, bucket_page_id);
+  segment->SetLocalDepth(slot, local_depth);
+  buffer_pool_manager_->UnpinPage(segment_page_id, true);
+}
+
+/*
+ * helper function to return global depth of hash table, zero when empty
+ */
+template <typename KeyType, typename ValueType>
+int DISK_EXTENDIBLE_HASH_TYPE::GetGlobalDepth() {
+  if (IsEmpty()) {
+    return 0;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  int global_depth =
+      reinterpret_cast<HashTableDirectoryPage *>(page->GetData())
+          ->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  return global_depth;
+}
+
+/*
+ * helper function to return local depth of the bucket of one directory slot
+ * @return : -1 if slot is beyond directory
+ */
+template <typename KeyType, typename ValueType>
+int DISK_EXTENDIBLE_HASH_TYPE::GetLocalDepth(uint32_t slot_index) {
+  if (IsEmpty() || slot_index >= (1u << GetGlobalDepth())) {
+    return -1;
+  }
+  page_id_t bucket_page_id;
+  int local_depth;
+  GetSlot(slot_index, bucket_page_id, local_depth);
+  return local_depth;
+}
+
+/*
+ * helper function to return current number of buckets, each is counted at
+ * the lowest of its slots
+ */
+template <typename KeyType, typename ValueType>
+int DISK_EXTENDIBLE_HASH_TYPE::GetNumBuckets() {
+  if (IsEmpty()) {
+    return 0;
+  }
+  int count = 0;
+  uint32_t size = 1u << GetGlobalDepth();
+  for (uint32_t i = 0; i < size; i++) {
+    page_id_t bucket_page_id;
+    int local_depth;
+    GetSlot(i, bucket_page_id, local_depth);
+    if (i < (1u << local_depth)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/*
+ * Update directory page id in header page under index name, the record is
+ * created with the directory
+ */
+template <typename KeyType, typename ValueType>
+void DISK_EXTENDIBLE_HASH_TYPE::UpdateDirectoryPageId() {
+  HeaderPage *header_page = static_cast<HeaderPage *>(
+      buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  if (!header_page->InsertRecord(index_name_, directory_page_id_))
+    header_page->UpdateRecord(index_name_, directory_page_id_);
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+/*
+ * Ask buffer pool manager for a new page(NOTICE: throw an "out of memory"
+ * exception if returned value is nullptr)
+ */
+template <typename KeyType, typename ValueType>
+Page *DISK_EXTENDIBLE_HASH_TYPE::NewPage(page_id_t &page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    LOG_INFO("hash table failed to allocate page, buffer pool out of memory!");
+    throw std::bad_alloc();
+  }
+  return page;
+}
+
+template class DiskExtendibleHash<GenericKey<4>, RID>;
+template class DiskExtendibleHash<GenericKey<8>, RID>;
+template class DiskExtendibleHash<GenericKey<16>, RID>;
+template class DiskExtendibleHash<GenericKey<32>, RID>;
+template class DiskExtendibleHash<GenericKey<64>, RID>;
+template class DiskExtendibleHash<GenericKey<128>, RID>;
+template class DiskExtendibleHash<GenericKey<256>, RID>;
+
+} // namespace cmudb
@@ -0,0 +1,100 @@
+/**
+ * arena.h
+ *
+ * Bump allocator: memory is handed out from large blocks and given back all
+ * at once by Reset(), which keeps the blocks for reuse. Nothing allocated
+ * from an arena is freed or destructed on its own, so only objects that own
+ * no other memory belong in it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace cmudb {
+
+class Arena {
+public:
+  explicit Arena(size_t block_size = 4096) : block_size_(block_size) {}
+
+  ~Arena() {
+    for (auto &block : blocks_)
+      delete[] block.first;
+  }
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // 8-byte aligned memory of size bytes, valid until next Reset()
+  char *Allocate(size_t size) {
+    size = (size + 7) & ~static_cast<size_t>(7);
+    while (current_ < blocks_.size() &&
+           offset_ + size > blocks_[current_].second) {
+      current_++;
+      offset_ = 0;
+    }
+    if (current_ == blocks_.size()) {
+      // a larger allocation gets a block of its own size
+      size_t block_size = size > block_size_ ? size : block_size_;
+      blocks_.emplace_back(new char[block_size], block_size);
+      offset_ = 0;
+    }
+    char *ptr = blocks_[current_].first + offset_;
+    offset_ += size;
+    return ptr;
+  }
+
+  // free everything allocated at once
+  void Reset() {
+    current_ = 0;
+    offset_ = 0;
+  }
+
+  inline size_t GetBlockCount() const { return blocks_.size(); }
+
+private:
+  size_t block_size_;
+  // blocks and their sizes, the one allocated from and offset in it
+  std::vector<std::pair<char *, size_t>> blocks_;
+  size_t current_ = 0;
+  size_t offset_ = 0;
+};
+
+// STL allocator over an arena, or over global heap if arena is null
+template <typename T> class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(Arena *arena) : arena_(arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena_) {}
+
+  T *allocate(size_t n) {
+    if (arena_ == nullptr)
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    return reinterpret_cast<T *>(arena_->Allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T *ptr, size_t) {
+    if (arena_ == nullptr)
+      ::operator delete(ptr);
+  }
+
+  template <typename U> bool operator==(const ArenaAllocator<U> &other) const {
+    return arena_ == other.arena_;
+  }
+
+  template <typename U> bool operator!=(const ArenaAllocator<U> &other) const {
+    return arena_ != other.arena_;
+  }
+
+private:
+  template <typename U> friend class ArenaAllocator;
+
+  Arena *arena_;
+};
+
+} // namespace cmudb
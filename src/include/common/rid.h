@@ -19,7 +19,9 @@ public:
 
   RID(int64_t rid) : page_id_(rid >> 32), slot_num_(rid){};
 
-  inline int64_t Get() const { return ((int64_t)page_id_) << 32 | slot_num_; }
+  inline int64_t Get() const {
+    return ((int64_t)page_id_) << 32 | (uint32_t)slot_num_;
+  }
 
   inline page_id_t GetPageId() const { return page_id_; }
 
@@ -0,0 +1,99 @@
+/**
+ * disk_extendible_hash.h
+ *
+ * Implementation of extendible hashing on pages of the buffer pool, as the
+ * in-memory ExtendibleHash(see include/hash/extendible_hash.h) does with
+ * std::map buckets. A bucket is a chain of bucket pages and the directory is
+ * a directory page over segment pages(see
+ * include/page/hash_table_directory_page.h), whose page id is the root id
+ * kept in header page under index name.
+ * (1) Unique key by default, non-unique key stores one pair per value
+ * (2) A full bucket splits, doubling directory when its local depth reaches
+ *     global depth. Pairs no more hash bits tell apart(e.g. values of one
+ *     non-unique key) go to overflow pages instead.
+ * (3) An emptied bucket merges with its split image, and directory halves
+ *     once no bucket needs all of its bits
+ * (4) Only point queries, keys are equal when their bytes are
+ *
+ * Lookups, and inserts and deletes that leave the directory alone, share the
+ * table latch and latch the first page of their bucket only. Splits, merges
+ * and overflow pages are handled under exclusive table latch.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwmutex.h"
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+
+namespace cmudb {
+
+#define DISK_EXTENDIBLE_HASH_TYPE DiskExtendibleHash<KeyType, ValueType>
+
+template <typename KeyType, typename ValueType> class DiskExtendibleHash {
+public:
+  explicit DiskExtendibleHash(const std::string &name,
+                              BufferPoolManager *buffer_pool_manager,
+                              page_id_t directory_page_id = INVALID_PAGE_ID,
+                              bool unique_key = true);
+
+  // Returns true if this hash table has never stored a key
+  bool IsEmpty() const;
+
+  // Insert a key-value pair, false if a unique key or the pair is already in
+  bool Insert(const KeyType &key, const ValueType &value);
+
+  // Remove a single value of a key
+  void Remove(const KeyType &key, const ValueType &value);
+
+  // return the values associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> &result);
+
+  // helper functions to get global & local depth and number of buckets,
+  // NOTE: for test purpose only, they do not take table latch
+  int GetGlobalDepth();
+  int GetLocalDepth(uint32_t slot_index);
+  int GetNumBuckets();
+
+  // helper function to generate hash addressing
+  static uint32_t HashKey(const KeyType &key);
+
+private:
+  enum InsertResult { INSERTED, DUPLICATE, BUCKET_FULL };
+
+  void StartNewTable();
+  void UpdateDirectoryPageId();
+
+  // directory slot access, fetch and unpin segment page of slot
+  page_id_t GetBucketPageId(uint32_t hash, int *local_depth = nullptr);
+  void GetSlot(uint32_t slot_index, page_id_t &bucket_page_id,
+               int &local_depth);
+  void SetSlot(uint32_t slot_index, page_id_t bucket_page_id,
+               int local_depth);
+
+  InsertResult InsertIntoBucket(Page *head, const KeyType &key,
+                                const ValueType &value, bool may_overflow);
+  bool SplitHelps(Page *head, uint32_t hash, int local_depth);
+  void SplitBucket(uint32_t hash);
+  void GrowDirectory();
+  void RemoveEmptyPages(page_id_t bucket_page_id);
+  void MergeBucket(uint32_t hash);
+  void ShrinkDirectory();
+  void TakeItems(page_id_t bucket_page_id, std::vector<MappingType> &items);
+  void FillBucket(page_id_t bucket_page_id,
+                  const std::vector<MappingType> &items);
+
+  Page *NewPage(page_id_t &page_id);
+
+  // member variable
+  std::string index_name_;
+  BufferPoolManager *buffer_pool_manager_;
+  page_id_t directory_page_id_;
+  bool unique_key_;
+  RWMutex table_latch_;
+};
+
+} // namespace cmudb
@@ -3,20 +3,33 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Unique key by default, non-unique key keeps its values in posting lists
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Pages of a level are linked left to right and bounded by high keys
+ *     (B-link tree), point queries hold one latch at a time
+ * (6) Deletes may leave leaves underfull for a background rebalancer to
+ *     merge(lazy merge)
+ * (7) Point queries descend an in-memory copy of the upper levels, and fetch
+ *     pages from buffer pool only below it(upper level cache)
  */
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
 #include <queue>
+#include <thread>
 #include <vector>
 
 #include "concurrency/transaction.h"
 #include "index/index_iterator.h"
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
+#include "page/b_plus_tree_posting_page.h"
 
 namespace cmudb {
 
@@ -24,13 +37,18 @@ namespace cmudb {
 // Main class providing the API for the Interactive B+ Tree.
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
+  friend INDEXITERATOR_TYPE;
+
 public:
   enum OpType { SEARCH, INSERT, DELETE };
+  enum SeekType { SEEK_KEY, SEEK_BEFORE_KEY, SEEK_FIRST, SEEK_LAST };
 
   explicit BPlusTree(const std::string &name,
                            BufferPoolManager *buffer_pool_manager,
                            const KeyComparator &comparator,
-                           page_id_t root_page_id = INVALID_PAGE_ID);
+                           page_id_t root_page_id = INVALID_PAGE_ID,
+                           bool unique_key = true);
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -39,16 +57,63 @@ public:
   bool Insert(const KeyType &key, const ValueType &value,
               Transaction *transaction = nullptr);
 
+  // Insert key-value pairs in key order, filling pages they append to.
+  int InsertBatch(const std::vector<MappingType> &items,
+                  Transaction *transaction = nullptr);
+
+  // Build this B+ tree bottom-up from key-value pairs sorted by key.
+  bool BulkLoad(const std::vector<MappingType> &items,
+                double fill_factor = 1.0);
+
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove a single value of a key, the key goes with its last value.
+  void Remove(const KeyType &key, const ValueType &value,
+              Transaction *transaction = nullptr);
+
+  // Deletes only record underfull leaves for Rebalance(), set before the
+  // tree is shared between threads.
+  void SetLazyMerge(bool lazy_merge) { lazy_merge_ = lazy_merge; }
+
+  // Copy internal pages of at most max_pages upper levels for point queries
+  // to descend, 0 turns it off. Set before the tree is shared between threads.
+  void SetUpperLevelCache(int max_pages) { upper_level_pages_ = max_pages; }
+
+  // Merge or redistribute leaves left underfull by lazy deletes.
+  int Rebalance();
+
+  // spawn a separate thread to call Rebalance() periodically
+  void RunRebalanceThread(std::chrono::milliseconds interval);
+  void StopRebalanceThread();
+
+  // return the values associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> &result,
+                Transaction *transaction = nullptr);
+
+  // same as above, also copy out the key stored in leaf when its only value
+  // is kept there(not in a posting list)
   bool GetValue(const KeyType &key, std::vector<ValueType> &result,
+                KeyType &stored_key, bool &has_stored_key,
+                Transaction *transaction = nullptr);
+
+  // values of each key of a batch, looked up in one descent
+  void MultiGet(const std::vector<KeyType> &keys,
+                std::vector<std::vector<ValueType>> &result,
                 Transaction *transaction = nullptr);
 
   // index iterator
   INDEXITERATOR_TYPE Begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
+  INDEXITERATOR_TYPE Begin(const KeyType &key, const KeyType &end_key);
+  INDEXITERATOR_TYPE RBegin();
+  INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
+  // split a range into at most count sub-ranges scanned by one iterator each
+  std::vector<INDEXITERATOR_TYPE> BeginPartitions(int count);
+  std::vector<INDEXITERATOR_TYPE> BeginPartitions(const KeyType &key,
+                                                  const KeyType &end_key,
+                                                  int count);
 
   // Print this B+ tree to stdout using a simple command-line
   std::string ToString(bool verbose = false);
@@ -61,8 +126,10 @@ public:
   void RemoveFromFile(const std::string &file_name,
                       Transaction *transaction = nullptr);
   // expose for test purpose
+  int GetHeight();
   B_PLUS_TREE_LEAF_PAGE_TYPE *FindLeafPage(const KeyType &key, page_id_t root_id,
-                  Transaction *transaction = nullptr, OpType op = SEARCH, bool leftMost = false);
+                  Transaction *transaction = nullptr, OpType op = SEARCH, bool leftMost = false,
+                  bool optimistic = false);
 
 private:
   void StartNewTree(const KeyType &key, const ValueType &value);
@@ -70,11 +137,61 @@ private:
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value,
                       Transaction *transaction = nullptr);
 
+  B_PLUS_TREE_LEAF_PAGE_TYPE *FindLeafPageForWrite(const KeyType &key,
+                                                   Transaction *transaction,
+                                                   OpType op);
+
+  Page *FindLeafPageByLinks(const KeyType &key, SeekType seek);
+
+  // read-only copy of internal pages of upper levels, root first
+  struct UpperLevels {
+    struct Node {
+      // keys[0] is invalid like in internal page
+      std::vector<KeyType> keys;
+      std::vector<page_id_t> children;
+      // node of each child, -1 if child page is below the copy
+      std::vector<int> child_nodes;
+      KeyType high_key;
+      page_id_t next_page_id;
+    };
+    uint64_t structure_version;
+    uint64_t split_count;
+    std::vector<Node> nodes;
+  };
+
+  Page *FetchFromUpperLevels(const KeyType &key);
+
+  std::shared_ptr<const UpperLevels> GetUpperLevels();
+
+  std::shared_ptr<const UpperLevels> BuildUpperLevels();
+
+  void MultiGetFromPage(Page *rawPage, const std::vector<KeyType> &keys,
+                        const std::vector<int> &order, int begin, int end,
+                        uint64_t version,
+                        std::vector<std::vector<ValueType>> &result,
+                        std::vector<int> &missed);
+
+  template <typename N>
+  bool MoveRight(N *page, const KeyType &key, SeekType seek) const;
+
+  std::vector<INDEXITERATOR_TYPE> Partition(const KeyType *key,
+                                            const KeyType *end_key, int count);
+
+  void GetSeparators(const KeyType *key, const KeyType *end_key, int count,
+                     std::vector<KeyType> &separators);
+
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key,
                         BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
-  template <typename N> N *Split(N *node);
+  int InsertBatchSplit(const std::vector<MappingType> &items, size_t &next,
+                       Transaction *transaction);
+
+  template <typename N, typename T>
+  void Split(N *node, const std::vector<T> &items);
+
+  template <typename N, typename T>
+  void Split(N *node, const std::vector<T> &items, std::vector<int> points);
 
   template <typename N>
   bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
@@ -85,10 +202,38 @@ private:
       BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *&parent,
       int index, Transaction *transaction = nullptr);
 
-  template <typename N> void Redistribute(N *neighbor_node, N *node, int index);
+  template <typename N>
+  void Redistribute(
+      N *neighbor_node, N *node,
+      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+      int index);
 
   bool AdjustRoot(BPlusTreePage *node);
 
+  void RemoveFromLeaf(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, const KeyType &key,
+                      Transaction *transaction);
+
+  bool InsertIntoPostingList(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf,
+                             const KeyType &key, const ValueType &entry,
+                             const ValueType &value);
+
+  bool RemoveFromPostingList(ValueType &entry, const ValueType &value);
+
+  void GetPostingList(page_id_t page_id, std::vector<ValueType> &result);
+
+  void DeletePostingList(page_id_t page_id);
+
+  template <typename N, typename T>
+  void BulkLoadSplitPoints(N *page, const std::vector<T> &items,
+                           double fill_factor, std::vector<int> &ends) const;
+
+  void BuildLeafLevel(const std::vector<MappingType> &items,
+                      double fill_factor,
+                      std::vector<std::pair<KeyType, page_id_t>> &level);
+
+  void BuildInternalLevel(std::vector<std::pair<KeyType, page_id_t>> &level,
+                          double fill_factor);
+
   void UpdateRootPageId(int insert_record = false);
 
   void UnLockUnPinPages(Transaction *transaction, OpType op, bool dirty = false);
@@ -101,9 +246,31 @@ private:
   page_id_t root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
+  bool unique_key_;
+  // bumped whenever keys may move to a left page, see GetValue()
+  std::atomic<uint64_t> structure_version_;
+  // point query looks again without latch coupling at most this many times
+  static constexpr int MAX_SEARCH_RETRY = 3;
+
+  // upper level cache, replaced as a whole(see GetUpperLevels())
+  int upper_level_pages_;
+  std::shared_ptr<const UpperLevels> upper_levels_;
+  std::mutex upper_levels_latch_;
+  // pages split, and point queries that found the copy out of date
+  std::atomic<uint64_t> split_count_;
+  std::atomic<uint64_t> upper_level_misses_;
+  static constexpr int DEFAULT_UPPER_LEVEL_PAGES = 64;
 
   std::mutex mutex_;
   static thread_local bool root_is_locked;
+
+  // lazy merge: underfull leaves with a key that leads to each of them
+  bool lazy_merge_;
+  std::map<page_id_t, KeyType> underflow_leaves_;
+  std::mutex rebalance_latch_;
+  std::thread rebalance_thread_;
+  bool rebalance_stop_;
+  std::condition_variable rebalance_cv_;
 };
 
 } // namespace cmudb
@@ -28,12 +28,19 @@ public:
   void InsertEntry(const Tuple &key, RID rid,
                    Transaction *transaction = nullptr) override;
 
-  void DeleteEntry(const Tuple &key,
+  void DeleteEntry(const Tuple &key, RID rid,
                    Transaction *transaction = nullptr) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> &result,
                Transaction *transaction = nullptr) override;
 
+  void ScanKey(const Tuple &key, std::vector<RID> &result,
+               std::vector<Tuple> &entries,
+               Transaction *transaction = nullptr) override;
+
+  void BulkLoad(const std::vector<std::pair<Tuple, RID>> &entries,
+                Transaction *transaction = nullptr) override;
+
 protected:
   // comparator for key
   KeyComparator comparator_;
@@ -9,8 +9,10 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 
+#include "common/exception.h"
 #include "table/tuple.h"
 #include "type/value.h"
 
@@ -18,6 +20,8 @@ namespace cmudb {
 template <size_t KeySize> class GenericKey {
 public:
   inline void SetFromKey(const Tuple &tuple) {
+    if (static_cast<size_t>(tuple.GetLength()) > KeySize)
+      throw Exception(EXCEPTION_TYPE_INDEX, "key is longer than index key size");
     // intialize to 0
     memset(data, 0, KeySize);
     memcpy(data, tuple.GetData(), tuple.GetLength());
@@ -62,14 +66,14 @@ public:
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ * Only the first column_count columns of key schema are compared, columns
+ * behind them(included columns of a covering index) ride along in keys
  */
 template <size_t KeySize> class GenericComparator {
 public:
   inline int operator()(const GenericKey<KeySize> &lhs,
                         const GenericKey<KeySize> &rhs) const {
-    int column_count = key_schema_->GetColumnCount();
-
-    for (int i = 0; i < column_count; i++) {
+    for (int i = 0; i < column_count_; i++) {
       Value lhs_value = (lhs.ToValue(key_schema_, i));
       Value rhs_value = (rhs.ToValue(key_schema_, i));
 
@@ -83,15 +87,57 @@ public:
     return 0;
   }
 
+  /**
+   * Return a key k so that lhs < k <= rhs with as many trailing zero bytes as
+   * possible, internal pages do not store them(suffix truncation). Only the
+   * characters of the last varchar are cut, length fields and offsets of
+   * uninlined columns stay as they are in rhs.
+   */
+  inline GenericKey<KeySize> ShortestSeparator(
+      const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    if (key_schema_->GetUnlinedColumnCount() == 0) {
+      return rhs;
+    }
+    int column_id = key_schema_->GetUnlinedColumns().back();
+    int32_t offset = *reinterpret_cast<const int32_t *>(
+        rhs.data + key_schema_->GetOffset(column_id));
+    int key_size = static_cast<int>(KeySize);
+    int size = offset + static_cast<int>(sizeof(uint32_t));
+    if (offset < key_schema_->GetLength() || size > key_size) {
+      return rhs;
+    }
+    // bytes up to the first different one are needed to stay above lhs
+    int diff = 0;
+    while (diff < key_size && lhs.data[diff] == rhs.data[diff]) {
+      diff++;
+    }
+    size = std::max(size, diff + 1);
+
+    GenericKey<KeySize> separator;
+    for (; size < key_size; size++) {
+      memset(separator.data, 0, KeySize);
+      memcpy(separator.data, rhs.data, size);
+      if ((*this)(lhs, separator) < 0 && (*this)(separator, rhs) <= 0) {
+        return separator;
+      }
+    }
+    return rhs;
+  }
+
   GenericComparator(const GenericComparator &other) {
     this->key_schema_ = other.key_schema_;
+    this->column_count_ = other.column_count_;
   }
 
-  // constructor
-  GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  // constructor, every column is compared unless column_count is given
+  GenericComparator(Schema *key_schema, int column_count = -1)
+      : key_schema_(key_schema),
+        column_count_(column_count < 0 ? key_schema->GetColumnCount()
+                                       : column_count) {}
 
 private:
   Schema *key_schema_;
+  int column_count_;
 };
 
 } // namespace cmudb
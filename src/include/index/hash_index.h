@@ -0,0 +1,43 @@
+/**
+ * hash_index.h
+ *
+ * Index over a disk extendible hash table, for equality lookups only
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "hash/disk_extendible_hash.h"
+#include "index/index.h"
+
+namespace cmudb {
+
+#define HASH_INDEX_TYPE HashIndex<KeyType, ValueType>
+
+template <typename KeyType, typename ValueType>
+class HashIndex : public Index {
+
+public:
+  HashIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
+            page_id_t directory_page_id = INVALID_PAGE_ID);
+
+  ~HashIndex() {}
+
+  void InsertEntry(const Tuple &key, RID rid,
+                   Transaction *transaction = nullptr) override;
+
+  void DeleteEntry(const Tuple &key, RID rid,
+                   Transaction *transaction = nullptr) override;
+
+  using Index::ScanKey;
+  void ScanKey(const Tuple &key, std::vector<RID> &result,
+               Transaction *transaction = nullptr) override;
+
+protected:
+  // container
+  DiskExtendibleHash<KeyType, ValueType> container_;
+};
+
+} // namespace cmudb
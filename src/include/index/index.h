@@ -23,17 +23,34 @@ namespace cmudb {
  * mapping relation and does the conversion between tuple key and index key
  */
 class Transaction;
+
+// data structure behind an index
+enum class IndexType { BPLUS_TREE_INDEX = 0, HASH_INDEX };
+
 class IndexMetadata {
   IndexMetadata() = delete;
 
 public:
   IndexMetadata(std::string index_name, std::string table_name,
-                const Schema *tuple_schema, const std::vector<int> &key_attrs)
-      : name_(index_name), table_name_(table_name), key_attrs_(key_attrs) {
+                const Schema *tuple_schema, const std::vector<int> &key_attrs,
+                bool is_unique = true,
+                IndexType index_type = IndexType::BPLUS_TREE_INDEX,
+                const std::vector<int> &included_attrs = std::vector<int>(),
+                bool is_clustered = false)
+      : name_(index_name), table_name_(table_name), key_attrs_(key_attrs),
+        included_attrs_(included_attrs), is_unique_(is_unique),
+        is_clustered_(is_clustered), index_type_(index_type) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
+    std::vector<int> entry_attrs(key_attrs_);
+    entry_attrs.insert(entry_attrs.end(), included_attrs_.begin(),
+                       included_attrs_.end());
+    entry_schema_ = Schema::CopySchema(tuple_schema, entry_attrs);
   }
 
-  ~IndexMetadata() { delete key_schema_; };
+  ~IndexMetadata() {
+    delete key_schema_;
+    delete entry_schema_;
+  };
 
   inline const std::string &GetName() const { return name_; }
 
@@ -42,6 +59,10 @@ public:
   // Returns a schema object pointer that represents the indexed key
   inline Schema *GetKeySchema() const { return key_schema_; }
 
+  // Returns the schema of what index stores for a tuple, indexed key followed
+  // by included columns
+  inline Schema *GetEntrySchema() const { return entry_schema_; }
+
   // Return the number of columns inside index key (not in tuple key)
   // Note that this must be defined inside the cpp source file
   // because it uses the member of catalog::Schema which is not known here
@@ -51,15 +72,34 @@ public:
   //  columns
   inline const std::vector<int> &GetKeyAttrs() const { return key_attrs_; }
 
+  // Base table columns stored next to the key(covering index), they are not
+  // part of the key
+  inline const std::vector<int> &GetIncludedAttrs() const {
+    return included_attrs_;
+  }
+
+  // Whether each key maps to at most one tuple
+  inline bool IsUnique() const { return is_unique_; }
+
+  // Whether index stores the tuples of table instead of a table heap(see
+  // include/table/clustered_table.h)
+  inline bool IsClustered() const { return is_clustered_; }
+
+  inline IndexType GetIndexType() const { return index_type_; }
+
   // Get a string representation for debugging
   const std::string ToString() const {
     std::stringstream os;
 
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
-       << "Type = B+Tree, "
+       << "Type = "
+       << (index_type_ == IndexType::HASH_INDEX ? "Hash" : "B+Tree") << ", "
+       << "Unique = " << (is_unique_ ? "true" : "false") << ", "
+       << "Clustered = " << (is_clustered_ ? "true" : "false") << ", "
+       << "Included columns = " << included_attrs_.size() << ", "
        << "Table name = " << table_name_ << "] :: ";
-    os << key_schema_->ToString();
+    os << entry_schema_->ToString();
 
     return os.str();
   }
@@ -69,8 +109,15 @@ private:
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<int> key_attrs_;
+  const std::vector<int> included_attrs_;
+  // false if many tuples may share one key
+  bool is_unique_;
+  bool is_clustered_;
+  IndexType index_type_;
   // schema of the indexed key
   Schema *key_schema_;
+  // schema of key and included columns
+  Schema *entry_schema_;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -106,10 +153,16 @@ public:
 
   Schema *GetKeySchema() const { return metadata_->GetKeySchema(); }
 
+  Schema *GetEntrySchema() const { return metadata_->GetEntrySchema(); }
+
   const std::vector<int> &GetKeyAttrs() const {
     return metadata_->GetKeyAttrs();
   }
 
+  const std::vector<int> &GetIncludedAttrs() const {
+    return metadata_->GetIncludedAttrs();
+  }
+
   // Get a string representation for debugging
   const std::string ToString() const {
     std::stringstream os;
@@ -122,17 +175,36 @@ public:
   ///////////////////////////////////////////////////////////////////
   // Point Modification
   ///////////////////////////////////////////////////////////////////
-  // designed for secondary indexes.
+  // designed for secondary indexes. key tuple of insert and delete follows
+  // entry schema, the one of a scan key schema
   virtual void InsertEntry(const Tuple &key, RID rid,
                            Transaction *transaction = nullptr) = 0;
 
   // delete the index entry linked to given tuple
-  virtual void DeleteEntry(const Tuple &key,
+  virtual void DeleteEntry(const Tuple &key, RID rid,
                            Transaction *transaction = nullptr) = 0;
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> &result,
                        Transaction *transaction = nullptr) = 0;
 
+  // point scan for index-only scans, entries[i] is the entry stored with
+  // result[i] when the index has it, or left unallocated when the tuple must
+  // be read from table heap instead. Indexes without entries leave them all.
+  virtual void ScanKey(const Tuple &key, std::vector<RID> &result,
+                       std::vector<Tuple> &entries,
+                       Transaction *transaction = nullptr) {
+    ScanKey(key, result, transaction);
+    entries.assign(result.size(), Tuple());
+  }
+
+  // build the index over rows that already exist, entries may come in any
+  // order. Indexes without a faster path insert one entry at a time.
+  virtual void BulkLoad(const std::vector<std::pair<Tuple, RID>> &entries,
+                        Transaction *transaction = nullptr) {
+    for (auto &entry : entries)
+      InsertEntry(entry.first, entry.second, transaction);
+  }
+
 private:
   //===--------------------------------------------------------------------===//
   //  Data members
@@ -1,8 +1,20 @@
 /**
  * index_iterator.h
  * For range scan of b+ tree
+ *
+ * Iterator copies the pairs it needs out of one leaf page at a time, under
+ * read latch, and holds neither latch nor pin in between, so it never blocks
+ * writers and any number of threads may scan at once. Moving to the next
+ * leaf follows its next page id as long as no key has moved left since the
+ * copy(merge or redistribution, see BPlusTree::GetValue()), otherwise it
+ * descends again from root with the last key it returned. Keys inserted or
+ * deleted during the scan may or may not be seen, every other key is seen
+ * exactly once and in order. Every value of a non-unique key is returned as a
+ * pair of its own, one after another.
  */
 #pragma once
+#include <vector>
+
 #include "page/b_plus_tree_leaf_page.h"
 #include "buffer/buffer_pool_manager.h"
 //#include "common/logger.h"
@@ -12,52 +24,60 @@ namespace cmudb {
 #define INDEXITERATOR_TYPE                                                     \
   IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS class BPlusTree;
+
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
 public:
-  // you may define your own constructor based on your member variables
-  IndexIterator(BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *,
-                int, BufferPoolManager *);
+  // key is where iterator starts(first key of tree if nullptr), forward
+  // iterator moves with operator++() and stops after end_key if given(or
+  // before it unless end_inclusive), backward one moves with operator--()
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree,
+                const KeyType *key, bool forward,
+                const KeyType *end_key = nullptr, bool end_inclusive = true);
 
   IndexIterator() {}
   ~IndexIterator();
 
-  bool isEnd() { 
-    // if we go BEYOND our leaf node, and our leaf node does not have next, 
-    // we are at the end
-    if (leaf_->GetNextPageId() == INVALID_PAGE_ID && index_ >= leaf_->GetSize()) {
-      return true;
-    }
-    return false; 
+  bool isEnd() {
+    // if we go BEYOND the pairs copied from our leaf, every leaf left in our
+    // direction had nothing for us
+    return index_ < 0 || index_ >= static_cast<int>(items_.size());
   }
 
-  const MappingType &operator*() {
-    return leaf_->GetItem(index_);
+  MappingType operator*() {
+    return items_[index_];
   }
 
-  IndexIterator &operator++() { 
-    index_++;
-    // check if we need to switch to right sibling leaf node
-    if (index_ >= leaf_->GetSize()) {
-      page_id_t next = leaf_->GetNextPageId();
-      if (next == INVALID_PAGE_ID) {
-        //LOG_INFO("No more sibling in indexItr");
-      } else {
-        index_ = 0;
-        buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-        leaf_ =
-            reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *> (buff_pool_manager_->FetchPage(next)->GetData());
-        
-      }
-    }
-    return *this;
-  }
+  IndexIterator &operator++();
+  IndexIterator &operator--();
 
 private:
+  void LoadNext();
+  void LoadPrev();
+  void CopyItems(Page *page, bool forward);
+  bool PastEndKey(const KeyType &key) const;
+  void Release(Page *page);
+
   // add your own private member variables here
-  BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf_;
-  int index_;
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_;
   BufferPoolManager *buff_pool_manager_;
+  // pairs copied from leaf page page_id_, always in key order
+  std::vector<MappingType> items_;
+  int index_;
+  page_id_t page_id_;
+  // leaf pages on both sides, next page id is invalid past end key
+  page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  // structure version of tree when items were copied
+  uint64_t version_;
+  // pairs still to come are beyond key_(or from key_ on if inclusive_)
+  bool has_key_;
+  bool inclusive_;
+  KeyType key_;
+  bool has_end_key_;
+  bool end_inclusive_;
+  KeyType end_key_;
 };
 
 
@@ -66,6 +66,8 @@ private:
   std::thread *flush_thread_;
   // for notifying flush thread
   std::condition_variable cv_;
+  // for notifying threads waiting for flush buffer to be written
+  std::condition_variable flushed_cv_;
   // disk manager
   DiskManager *disk_manager_;
 
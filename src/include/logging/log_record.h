@@ -23,9 +23,14 @@
  *-------------------------------------------------------------
  * | HEADER | prev_page_id |
  *-------------------------------------------------------------
+ * For new/delete overflow page type log record, data is what the page holds
+ *-------------------------------------------------------------------------
+ * | HEADER | page_id | next_page_id | data_size | data(char[] array) |
+ *-------------------------------------------------------------------------
  */
 #pragma once
 #include <cassert>
+#include <vector>
 
 #include "common/config.h"
 #include "table/tuple.h"
@@ -44,6 +49,9 @@ enum class LogRecordType {
   ABORT,  // 8
   // when create a new page in heap table
   NEWPAGE,  // 9
+  // when write or free a page of an overflow chain(see table/overflow_chain.h)
+  NEWOVERFLOWPAGE,  // 10
+  DELETEOVERFLOWPAGE,  // 11
 };
 
 class LogRecord {
@@ -101,6 +109,20 @@ public:
     size_ = HEADER_SIZE + sizeof(page_id_t);
   }
 
+  // constructor for NEWOVERFLOWPAGE/DELETEOVERFLOWPAGE type, data is kept to
+  // redo a write and to undo a delete
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
+            page_id_t page_id, page_id_t next_page_id, const char *data,
+            int32_t data_size)
+      : lsn_(INVALID_LSN), txn_id_(txn_id), prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type), overflow_page_id_(page_id),
+        next_page_id_(next_page_id), overflow_data_(data, data + data_size) {
+    assert(log_record_type == LogRecordType::NEWOVERFLOWPAGE ||
+           log_record_type == LogRecordType::DELETEOVERFLOWPAGE);
+    // calculate log record size
+    size_ = HEADER_SIZE + 2 * sizeof(page_id_t) + sizeof(int32_t) + data_size;
+  }
+
   ~LogRecord() {}
 
   inline RID &GetDeleteRID() { return delete_rid_; }
@@ -158,6 +180,11 @@ public:
 
   // case4: for new page opeartion
   page_id_t prev_page_id_ = INVALID_PAGE_ID;
+
+  // case5: for new/delete overflow page opeartion
+  page_id_t overflow_page_id_ = INVALID_PAGE_ID;
+  page_id_t next_page_id_ = INVALID_PAGE_ID;
+  std::vector<char> overflow_data_;
   const static int HEADER_SIZE = 20;
 }; // namespace cmudb
 
@@ -47,6 +47,9 @@ private:
   char *log_buffer_;
 
   void UndoInternal(LogRecord &log_record);
+  // redo/undo of overflow chain pages
+  void WriteOverflowPage(LogRecord &log_record);
+  void DeleteOverflowPage(page_id_t page_id);
 };
 
 } // namespace cmudb
@@ -7,18 +7,32 @@
  * NOTE: since the number of keys does not equal to number of child pointers,
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
+ * Like a leaf page, internal page links to the next page of its level and
+ * keeps a high key(B-link tree), so a reader that got here before a split
+ * finds moved children by moving right.
  *
- * Internal page format (keys are stored in increasing order):
+ * Internal page format (keys are stored in increasing order, see
+ * include/page/b_plus_tree_slotted_area.h for the slotted area format):
  *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
+ * | HEADER | SLOTTED AREA(KEY(1)+PAGE_ID(1) | ... | KEY(n)+PAGE_ID(n)) |
  *  --------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 28 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  -----------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4)
+ *  -----------------------------------------------
  */
 
 #pragma once
 
 #include <queue>
+#include <vector>
 
 #include "page/b_plus_tree_page.h"
+#include "page/b_plus_tree_slotted_area.h"
 
 namespace cmudb {
 
@@ -31,46 +45,55 @@ public:
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
 
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  KeyType GetHighKey() const;
   KeyType KeyAt(int index) const;
-  void SetKeyAt(int index, const KeyType &key);
+  bool SetKeyAt(int index, const KeyType &key);
   int ValueIndex(const ValueType &value) const;
   ValueType ValueAt(int index) const;
+  int GetUsedSize() const;
+  bool IsSafe(int type) const;
+  bool IsUnderflow() const;
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  ValueType LookupBefore(const KeyType &key,
+                         const KeyComparator &comparator) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                        const ValueType &new_value);
-  int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
-                      const ValueType &new_value);
+  bool InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                       const ValueType &new_value);
   void Remove(int index);
   ValueType RemoveAndReturnOnlyChild();
 
-  void MoveHalfTo(BPlusTreeInternalPage *recipient,
-                  BufferPoolManager *buffer_pool_manager);
-  void MoveAllTo(BPlusTreeInternalPage *recipient, int index_in_parent,
+  // Split and Merge utility methods
+  void GetItems(std::vector<MappingType> &items) const;
+  int GetEncodedSize(const MappingType *items, int size) const;
+  int GetEncodedSize(const MappingType *items, int size,
+                     const KeyType &high_key) const;
+  void SplitPoints(const std::vector<MappingType> &items,
+                   std::vector<int> &points) const;
+  bool PopulateFrom(const MappingType *items, int size,
+                    BufferPoolManager *buffer_pool_manager);
+  bool PopulateFrom(const MappingType *items, int size,
+                    const KeyType &high_key,
+                    BufferPoolManager *buffer_pool_manager);
+  bool MoveAllTo(BPlusTreeInternalPage *recipient, int index_in_parent,
                  BufferPoolManager *buffer_pool_manager);
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient,
+  bool RedistributeWith(BPlusTreeInternalPage *sibling,
+                        BPlusTreeInternalPage *parent, int index_in_parent,
+                        const KeyComparator & /* Unused */,
                         BufferPoolManager *buffer_pool_manager);
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient,
-                         int parent_index,
-                         BufferPoolManager *buffer_pool_manager);
   // DEUBG and PRINT
   std::string ToString(bool verbose = false) const;
 
   void QueueUpChildren(std::queue<BPlusTreePage *> *queue,
                        BufferPoolManager *buffer_pool_manager);
 
-  MappingType PushUpIndex();
-
 private:
-  void CopyHalfFrom(MappingType *items, int size,
-                    BufferPoolManager *buffer_pool_manager);
-  void CopyAllFrom(MappingType *items, int size,
-                   BufferPoolManager *buffer_pool_manager);
-  void CopyLastFrom(const MappingType &pair,
-                    BufferPoolManager *buffer_pool_manager);
-  void CopyFirstFrom(const MappingType &pair, int parent_index,
-                     BufferPoolManager *buffer_pool_manager);
+  void AdoptChildren(BufferPoolManager *buffer_pool_manager);
 
-  MappingType array[0];
+  page_id_t next_page_id_;
+  BPlusTreeSlottedArea<KeyType, ValueType> area_;
 };
 } // namespace cmudb
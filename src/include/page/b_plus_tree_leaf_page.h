@@ -3,26 +3,32 @@
  *
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Keys are unique within the page, a non-unique key keeps its record
+ * ids in posting pages(see include/page/b_plus_tree_posting_page.h).
+ * Every key is smaller than the high key of the page, a key at least as large
+ * has moved to the right by a split(B-link tree, see GetHighKey()).
 
- * Leaf page format (keys are stored in order):
+ * Leaf page format (keys are stored in order, see
+ * include/page/b_plus_tree_slotted_area.h for the slotted area format):
  *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ * | HEADER | SLOTTED AREA(KEY(1) + RID(1) | ... | KEY(n) + RID(n))
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  ----------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4)
+ *  ----------------------------------------------------------------
  */
 #pragma once
 #include <utility>
 #include <vector>
 
+#include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_page.h"
+#include "page/b_plus_tree_slotted_area.h"
 
 namespace cmudb {
 #define B_PLUS_TREE_LEAF_PAGE_TYPE                                             \
@@ -38,38 +44,51 @@ public:
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
+  KeyType GetHighKey() const;
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+  int GetUsedSize() const;
+  bool IsSafe(int type) const;
+  bool IsUnderflow() const;
 
   // insert and delete methods
-  int Insert(const KeyType &key, const ValueType &value,
-             const KeyComparator &comparator);
+  bool Insert(const KeyType &key, const ValueType &value,
+              const KeyComparator &comparator);
   bool Lookup(const KeyType &key, ValueType &value,
-              const KeyComparator &comparator) const;
+              const KeyComparator &comparator,
+              KeyType *stored_key = nullptr) const;
+  bool Update(const KeyType &key, const ValueType &value,
+              const KeyComparator &comparator);
   int RemoveAndDeleteRecord(const KeyType &key,
                             const KeyComparator &comparator);
   // Split and Merge utility methods
-  void MoveHalfTo(BPlusTreeLeafPage *recipient,
-                  BufferPoolManager *buffer_pool_manager /* Unused */);
-  void MoveAllTo(BPlusTreeLeafPage *recipient, int /* Unused */,
+  void GetItems(std::vector<MappingType> &items) const;
+  int GetEncodedSize(const MappingType *items, int size) const;
+  int GetEncodedSize(const MappingType *items, int size,
+                     const KeyType &high_key) const;
+  void SplitPoints(const std::vector<MappingType> &items,
+                   std::vector<int> &points) const;
+  bool PopulateFrom(const MappingType *items, int size,
+                    BufferPoolManager * /* Unused */ = nullptr);
+  bool PopulateFrom(const MappingType *items, int size,
+                    const KeyType &high_key,
+                    BufferPoolManager * /* Unused */ = nullptr);
+  bool MoveAllTo(BPlusTreeLeafPage *recipient, int /* Unused */,
                  BufferPoolManager * /* Unused */);
-  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient,
-                        BufferPoolManager *buffer_pool_manager);
-  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient, int parentIndex,
-                         BufferPoolManager *buffer_pool_manager);
+  bool RedistributeWith(
+      BPlusTreeLeafPage *sibling,
+      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+      int index_in_parent, const KeyComparator &comparator,
+      BufferPoolManager * /* Unused */);
   // Debug
   std::string ToString(bool verbose = false) const;
 
 private:
-  void CopyHalfFrom(MappingType *items, int size);
-  void CopyAllFrom(MappingType *items, int size);
-  void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item, int parentIndex,
-                     BufferPoolManager *buffer_pool_manager);
-  
-
   page_id_t next_page_id_;
-  MappingType array[0];
+  page_id_t prev_page_id_;
+  BPlusTreeSlottedArea<KeyType, ValueType> area_;
 };
 } // namespace cmudb
@@ -5,8 +5,10 @@
  *
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
+ * CurrentSize counts key & value pairs, while MaxSize counts bytes available
+ * to them since keys are stored with variable length.
  *
- * Header format (size in byte, 20 bytes in total):
+ * Header format (size in byte, 24 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
@@ -39,6 +41,7 @@ class BPlusTreePage {
 public:
   bool IsLeafPage() const;
   bool IsRootPage() const;
+  bool IsMergedAway() const;
   void SetPageType(IndexPageType page_type);
 
   int GetSize() const;
@@ -59,15 +62,6 @@ public:
 
   std::string ToString(bool verbose = false) const { return "empty"; }
 
-  bool IsSafe(int type) {
-    if (type == 1) { // insert
-      return (GetSize() < GetMaxSize());
-    } else if (type == 2) { // delete
-      return (GetSize() >= GetMinSize());
-    }
-    return false;
-  }
-
 private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_;
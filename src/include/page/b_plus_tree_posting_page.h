@@ -0,0 +1,68 @@
+/**
+ * b_plus_tree_posting_page.h
+ *
+ * Store record ids of one non-unique key. While a key has a single record id
+ * it stays inline in the leaf page, once a second one arrives the leaf value
+ * is replaced by a reference(see MakeReference()) to a chain of posting pages.
+ * Only the head page of a chain may be partially filled, new pages are pushed
+ * in front of it.
+ *
+ * Posting page format (record ids are not ordered):
+ *  -------------------------------------------------
+ * | HEADER | RID(1) | RID(2) | ... | RID(n)
+ *  -------------------------------------------------
+ *
+ *  Header format (size in byte, 12 bytes in total):
+ *  -------------------------------------------------
+ * | PageId (4) | NextPageId (4) | CurrentSize (4) |
+ *  -------------------------------------------------
+ */
+#pragma once
+
+#include <string>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace cmudb {
+
+// slot number no tuple can have, marks a leaf value as posting list reference
+#define POSTING_LIST_SLOT_NUM -2
+
+class BPlusTreePostingPage {
+public:
+  // After creating a new posting page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, page_id_t next_page_id = INVALID_PAGE_ID);
+  // helper methods
+  page_id_t GetPageId() const;
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  int GetSize() const;
+  int GetMaxSize() const;
+  RID RidAt(int index) const;
+  void SetRidAt(int index, const RID &rid);
+  int RidIndex(const RID &rid) const;
+
+  // insert and delete methods
+  bool Append(const RID &rid);
+  RID RemoveLast();
+
+  // leaf value pointing at the chain starting from page_id
+  static inline RID MakeReference(page_id_t page_id) {
+    return RID(page_id, POSTING_LIST_SLOT_NUM);
+  }
+  static inline bool IsReference(const RID &rid) {
+    return rid.GetSlotNum() == POSTING_LIST_SLOT_NUM;
+  }
+
+  // Debug
+  std::string ToString() const;
+
+private:
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int size_;
+  RID array[0];
+};
+} // namespace cmudb
@@ -0,0 +1,91 @@
+/**
+ * b_plus_tree_slotted_area.h
+ *
+ * Variable length storage for the key & value pairs of a B+ tree page. The
+ * longest prefix shared by every key of the area is stored only once, and
+ * trailing zero bytes of a key(GenericKey is zero filled, see
+ * include/index/generic_key.h) are never stored. What is left of a key, its
+ * suffix, is stored next to its value and slots keep entries in key order.
+ * NOTE: the first key of an internal page is invalid, it is not taken into
+ * account when prefix is computed(see skip_first_key)
+ * The high key, upper bound of every key the page may hold(B-link tree), is
+ * stored whole(trailing zero bytes aside) right behind the prefix.
+ *
+ * Slotted area format (slots grow forward and entries grow backward):
+ *  ----------------------------------------------------------------------------
+ * | HEADER | PREFIX | HIGH KEY | SLOT(1)..SLOT(n) | FREE | ENTRY(n)..ENTRY(1) |
+ *  ----------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 8 bytes in total):
+ *  -----------------------------------------------------------------------
+ * | DataSize (2) | PrefixSize (2) | HighKeySize (2) | FreeSpacePointer (2) |
+ *  -----------------------------------------------------------------------
+ *
+ *  Slot format (size in byte, 4 bytes in total) and entry format:
+ *  --------------------------------------   ----------------------
+ * | EntryOffset (2) | SuffixSize (2) |   | VALUE | KEY SUFFIX |
+ *  --------------------------------------   ----------------------
+ */
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace cmudb {
+
+#define MappingType std::pair<KeyType, ValueType>
+
+template <typename KeyType, typename ValueType>
+class BPlusTreeSlottedArea {
+public:
+  // must call initialize method before the area is used, data_size is the
+  // number of bytes behind the area header
+  void Init(int data_size);
+
+  int GetDataSize() const;
+  int GetPrefixSize() const;
+  int GetUsedSize(int size) const;
+  int GetEncodedSize(const MappingType *items, int size,
+                     bool skip_first_key) const;
+  // bytes taken by key once stored as a high key
+  static int GetHighKeySize(const KeyType &key);
+  // bytes taken by one entry of the longest key, including its slot
+  static constexpr int GetMaxEntrySize() {
+    return sizeof(uint16_t) * 2 + sizeof(ValueType) + sizeof(KeyType);
+  }
+
+  KeyType HighKey() const;
+  KeyType KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
+  void GetItems(int size, std::vector<MappingType> &items) const;
+
+  // insert and delete methods
+  bool InsertAt(int size, int index, const MappingType &item,
+                bool skip_first_key);
+  void RemoveAt(int size, int index);
+  bool PopulateFrom(const MappingType *items, int size, bool skip_first_key,
+                    const KeyType &high_key);
+
+  // Split utility method
+  void SplitPoints(const std::vector<MappingType> &items, bool skip_first_key,
+                   const KeyType &high_key, std::vector<int> &points) const;
+
+private:
+  int PrefixSize(const MappingType *items, int size,
+                 bool skip_first_key) const;
+  bool RunFits(const std::vector<MappingType> &items, int begin, int end,
+               bool skip_first_key, const KeyType &high_key) const;
+  void WriteEntry(int index, const MappingType &item, int suffix_size);
+  char *SlotAt(int index);
+  const char *SlotAt(int index) const;
+
+  uint16_t data_size_;
+  uint16_t prefix_size_;
+  uint16_t high_key_size_;
+  uint16_t free_space_pointer_;
+  char data_[0];
+};
+
+} // namespace cmudb
@@ -0,0 +1,55 @@
+/**
+ * free_space_map_page.h
+ *
+ * Page of the free-space map of a table heap(see
+ * include/table/free_space_map.h). Slot i records a heap page id and how
+ * much room that page had when last changed, as a bucket of free bytes. Map
+ * pages are linked by next page id, and heap pages are recorded in the order
+ * they were appended to the table heap.
+ *
+ * Free-space map page format (size in byte):
+ *  ---------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | NextPageId (4) | SlotCount (4) | HeapPageId(1) (4) |
+ *  ---------------------------------------------------------------------------
+ * | ... | HeapPageId(n) (4) | Bucket(1) (1) | ... | Bucket(n) (1) |
+ *  ---------------------------------------------------------------
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class FreeSpaceMapPage {
+public:
+  // number of heap pages one map page records
+  static constexpr int SLOT_COUNT =
+      (PAGE_SIZE - sizeof(page_id_t) * 2 - sizeof(lsn_t) - sizeof(int)) /
+      (sizeof(page_id_t) + sizeof(uint8_t));
+
+  // After creating a new map page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id);
+  page_id_t GetPageId() const;
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+
+  int GetSlotCount() const;
+  page_id_t GetHeapPageId(int slot) const;
+  int GetBucket(int slot) const;
+  void SetBucket(int slot, int bucket);
+  // record one more heap page, false if map page is full
+  bool Append(page_id_t heap_page_id, int bucket);
+
+private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  page_id_t next_page_id_;
+  int slot_count_;
+  page_id_t heap_page_ids_[SLOT_COUNT];
+  uint8_t buckets_[SLOT_COUNT];
+};
+
+} // namespace cmudb
@@ -0,0 +1,78 @@
+/**
+ * hash_table_bucket_page.h
+ *
+ * Store key & value pairs of one bucket of a disk extendible hash table(see
+ * include/hash/disk_extendible_hash.h). Pairs are kept in no particular order
+ * and looked up by bytes of the key, trailing zero bytes of a key(GenericKey is
+ * zero filled, see include/index/generic_key.h) are never stored. A bucket
+ * whose pairs can not be told apart by more hash bits goes on in a chain of
+ * overflow pages linked by next page id.
+ *
+ * Bucket page format (entries grow forward):
+ *  ----------------------------------------------------------
+ * | HEADER | ENTRY(1) | ENTRY(2) | ... | ENTRY(n) | FREE |
+ *  ----------------------------------------------------------
+ *
+ *  Header format (size in byte, 16 bytes in total):
+ *  --------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | NextPageId (4) | CurrentSize (2) | UsedSize (2) |
+ *  --------------------------------------------------------------------------
+ *
+ *  Entry format:
+ *  -------------------------------------
+ * | VALUE | KeySize (2) | KEY(KeySize) |
+ *  -------------------------------------
+ */
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+#define MappingType std::pair<KeyType, ValueType>
+
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType>
+
+template <typename KeyType, typename ValueType> class HashTableBucketPage {
+public:
+  // After creating a new bucket page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, page_id_t next_page_id = INVALID_PAGE_ID);
+  // helper methods
+  page_id_t GetPageId() const;
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  int GetSize() const;
+  bool IsEmpty() const { return size_ == 0; }
+  bool HasRoomFor(const KeyType &key) const;
+  // bytes taken by the entry of key
+  static int GetEntrySize(const KeyType &key);
+
+  // lookup methods, return the number of pairs found
+  int GetValue(const KeyType &key, std::vector<ValueType> &result) const;
+  bool Contains(const KeyType &key) const;
+  bool Contains(const KeyType &key, const ValueType &value) const;
+  void GetItems(std::vector<MappingType> &items) const;
+
+  // insert and delete methods
+  bool Insert(const KeyType &key, const ValueType &value);
+  bool Remove(const KeyType &key, const ValueType &value);
+
+private:
+  static int KeySize(const KeyType &key);
+  bool KeyMatches(const char *entry, const KeyType &key, int key_size) const;
+  const char *NextEntry(const char *entry) const;
+
+  page_id_t page_id_;
+  lsn_t lsn_;
+  page_id_t next_page_id_;
+  uint16_t size_;
+  uint16_t used_size_;
+  char data_[0];
+};
+
+} // namespace cmudb
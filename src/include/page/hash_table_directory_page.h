@@ -0,0 +1,89 @@
+/**
+ * hash_table_directory_page.h
+ *
+ * Directory of a disk extendible hash table(see
+ * include/hash/disk_extendible_hash.h). Slot i of the directory holds the
+ * bucket page id and local depth of keys whose hash ends with the global depth
+ * low bits of i. One page holds only about a hundred slots, so slots are
+ * stored in segment pages and the directory page, root of the hash table,
+ * keeps global depth and the segment page ids in slot order.
+ *
+ * Directory page format (size in byte):
+ *  --------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | GlobalDepth (4) | SegmentCount (4) | SegmentId(1) |
+ *  --------------------------------------------------------------------------
+ * | SegmentId(2) | ... | SegmentId(n) |
+ *  -------------------------------------
+ *
+ * Segment page format (size in byte):
+ *  ---------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | LocalDepth(1) (1) | ... | LocalDepth(n) (1) |
+ *  ---------------------------------------------------------------------------
+ * | BucketPageId(1) (4) | ... | BucketPageId(n) (4) |
+ *  ---------------------------------------------------
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class HashTableSegmentPage {
+public:
+  // number of directory slots one segment page holds
+  static constexpr int SLOT_COUNT =
+      (PAGE_SIZE - sizeof(page_id_t) - sizeof(lsn_t)) /
+      (sizeof(page_id_t) + sizeof(uint8_t));
+
+  // After creating a new segment page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id);
+  page_id_t GetPageId() const;
+
+  page_id_t GetBucketPageId(int slot) const;
+  void SetBucketPageId(int slot, page_id_t bucket_page_id);
+  int GetLocalDepth(int slot) const;
+  void SetLocalDepth(int slot, int local_depth);
+
+private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint8_t local_depths_[SLOT_COUNT];
+  page_id_t bucket_page_ids_[SLOT_COUNT];
+};
+
+class HashTableDirectoryPage {
+public:
+  // number of segment pages the directory page may point to
+  static constexpr int MAX_SEGMENT_COUNT =
+      (PAGE_SIZE - sizeof(page_id_t) - sizeof(lsn_t) - sizeof(int) * 2) /
+      sizeof(page_id_t);
+
+  // After creating a new directory page from buffer pool, must call
+  // initialize method to set default values
+  void Init(page_id_t page_id);
+  page_id_t GetPageId() const;
+
+  int GetGlobalDepth() const;
+  void SetGlobalDepth(int global_depth);
+  // largest global depth whose slots fit in MAX_SEGMENT_COUNT segments
+  static int GetMaxGlobalDepth();
+  // low global depth bits of hash
+  uint32_t GetSlotIndex(uint32_t hash) const;
+
+  int GetSegmentCount() const;
+  page_id_t GetSegmentPageId(int segment) const;
+  void PushSegment(page_id_t segment_page_id);
+  page_id_t PopSegment();
+
+private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  int global_depth_;
+  int segment_count_;
+  page_id_t segment_page_ids_[MAX_SEGMENT_COUNT];
+};
+
+} // namespace cmudb
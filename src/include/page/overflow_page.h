@@ -0,0 +1,50 @@
+/**
+ * overflow_page.h
+ *
+ * Store bytes of one value too long for the page that refers to it(e.g. a
+ * row of a clustered table or a long varchar value of a table heap tuple).
+ * The value is cut into pieces kept in a chain of overflow pages linked by
+ * next page id, in order(see include/table/overflow_chain.h).
+ *
+ * Overflow page format:
+ *  ------------------------------------
+ * | HEADER | DATA(CurrentSize) | FREE |
+ *  ------------------------------------
+ *
+ *  Header format (size in byte, 16 bytes in total):
+ *  ------------------------------------------------------------
+ * | PageId (4) | LSN (4) | NextPageId (4) | CurrentSize (4) |
+ *  ------------------------------------------------------------
+ */
+#pragma once
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class OverflowPage {
+public:
+  // After creating a new overflow page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, page_id_t next_page_id = INVALID_PAGE_ID);
+  // helper methods
+  page_id_t GetPageId() const;
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  int GetSize() const;
+  // bytes one page holds
+  static int GetMaxSize();
+
+  const char *GetData() const;
+  // copy as much of data as fits, return the number of bytes copied
+  int Write(const char *data, int size);
+
+private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  page_id_t next_page_id_;
+  int size_;
+  char data_[0];
+};
+
+} // namespace cmudb
@@ -0,0 +1,125 @@
+/**
+ * pax_page.h
+ *
+ * Heap page in PAX layout(partition attributes across), the alternative to
+ * TablePage for scans reading a few columns of wide tuples: values of each
+ * column are kept next to each other in a minipage of their own, so such a
+ * scan copies only the minipages of columns it reads(see GetTuples()).
+ * A varchar value takes a slot of its declared length in its minipage, so
+ * every row of schema takes as many bytes(see GetRowSize()), an update
+ * always stays in place and no page needs compaction. A tuple is given and
+ * taken in row format(see include/table/tuple.h). Changes take locks as
+ * TablePage does, but write no log records, so a PAX heap can't be recovered
+ * and TableHeap refuses to create or open one while ENABLE_LOGGING is on.
+ * Header begins with the same fields as the one of TablePage, so a page chain
+ * is walked the same way whatever the layout of its pages.
+ *
+ * PAX page format:
+ *  ------------------------------------------------------------------
+ * | HEADER | USED BITMAP | DELETED BITMAP | MINIPAGE_1 | MINIPAGE_2 | ...
+ *  ------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 24 bytes in total):
+ *  --------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | PrevPageId (4) | NextPageId (4) | Capacity (4)
+ *  --------------------------------------------------------------------
+ *  ------------------
+ * | TupleCount (4) |
+ *  ------------------
+ *
+ *  Each bitmap has a bit for each of Capacity slots, in 64-bit words. Used
+ *  bit of a slot is set if it holds a tuple, deleted bit if that tuple is
+ *  marked deleted. Minipage i holds value of column i of each slot, a
+ *  varchar one as its length followed by data.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "concurrency/lock_manager.h"
+#include "page/page.h"
+#include "table/tuple.h"
+#include "table/tuple_view.h"
+
+namespace cmudb {
+
+class PaxPage : public Page {
+public:
+  static constexpr int HEADER_SIZE = 24;
+
+  /**
+   * Header related
+   */
+  void Init(page_id_t page_id, page_id_t prev_page_id, Schema *schema);
+  page_id_t GetPageId();
+  page_id_t GetPrevPageId();
+  page_id_t GetNextPageId();
+  void SetPrevPageId(page_id_t prev_page_id);
+  void SetNextPageId(page_id_t next_page_id);
+
+  // bytes a row of schema takes in minipages
+  static int32_t GetRowSize(Schema *schema);
+  // rows of schema a page holds, 0 if a row does not fit in a page
+  static int GetCapacity(Schema *schema);
+  // whether varchar values of tuple are no longer than declared
+  static bool IsStorable(Schema *schema, const Tuple &tuple);
+
+  /**
+   * Tuple related, same as the ones of TablePage. Tuple must be storable
+   */
+  bool InsertTuple(Schema *schema, const Tuple &tuple, RID &rid,
+                   Transaction *txn, LockManager *lock_manager);
+  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager);
+  bool UpdateTuple(Schema *schema, const Tuple &new_tuple, Tuple &old_tuple,
+                   const RID &rid, Transaction *txn, LockManager *lock_manager);
+  void ApplyDelete(const RID &rid, Transaction *txn);
+  void RollbackDelete(const RID &rid, Transaction *txn);
+  bool GetTuple(Schema *schema, const RID &rid, Tuple &tuple, Transaction *txn,
+                LockManager *lock_manager);
+
+  // rebuild every visible tuple in row format in buffer(resized as needed),
+  // and append a view of it to tuples. Only columns in column_ids are read
+  // from minipages, the others are null(all of them if column_ids is empty)
+  void GetTuples(Schema *schema, const std::vector<int> &column_ids,
+                 std::vector<char> &buffer, std::vector<TupleView> &tuples,
+                 Transaction *txn, LockManager *lock_manager);
+
+  // size of the largest tuple InsertTuple() takes now: any storable one while
+  // a slot is free(PAGE_SIZE), none once page is full
+  int32_t GetMaxInsertSize();
+
+  /**
+   * Tuple iterator
+   */
+  bool GetFirstTupleRid(RID &first_rid);
+  bool GetNextTupleRid(const RID &cur_rid, RID &next_rid);
+
+private:
+  /**
+   * helper functions
+   */
+  static int32_t GetSlotSize(Schema *schema, int column_id);
+  int32_t GetCapacityField();
+  int32_t GetTupleCount();
+  void SetTupleCount(int32_t tuple_count);
+  uint64_t *GetUsedBitmap();
+  uint64_t *GetDeletedBitmap();
+  bool IsVisible(int slot_num);
+  // first visible slot from slot_num on, capacity if none
+  int GetNextVisibleSlot(int slot_num);
+  // where minipage of each column begins
+  std::vector<char *> GetMinipages(Schema *schema);
+  // copy tuple into minipages, or out of them in row format
+  void Scatter(Schema *schema, const std::vector<char *> &minipages,
+               const Tuple &tuple, int slot_num);
+  int32_t GetGatherSize(Schema *schema, const std::vector<char *> &minipages,
+                        const std::vector<bool> &is_read, int slot_num);
+  void Gather(Schema *schema, const std::vector<char *> &minipages,
+              const std::vector<bool> &is_read, int slot_num, char *data);
+  static void SetNull(TypeId type, char *column);
+};
+
+} // namespace cmudb
@@ -12,26 +12,38 @@
  *  --------------------------------------------------------------------------
  * | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  --------------------------------------------------------------------------
- *  --------------------------------------------------------------
- * | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  --------------------------------------------------------------
+ *  ---------------------------------------------------------------------
+ * | TupleCount (4) | SlotBitmap (8 * BITMAP_WORD_COUNT) | Tuple_1 offset (4)
+ *  ---------------------------------------------------------------------
+ *  ----------------------------
+ * | Tuple_1 size (4) | ... |
+ *  ----------------------------
  *
+ *  Bit i of slot bitmap is set if slot i is not empty(tuple size is not 0), so
+ *  a free slot or the next tuple is found a 64-bit word at a time.
  */
 
 #pragma once
 
+#include <cstdint>
 #include <cstring>
+#include <vector>
 
 #include "common/rid.h"
 #include "concurrency/lock_manager.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
 #include "table/tuple.h"
+#include "table/tuple_view.h"
 
 namespace cmudb {
 
 class TablePage : public Page {
 public:
+  // a bit for each slot a page has room for
+  static constexpr int BITMAP_WORD_COUNT = (PAGE_SIZE / 8 + 63) / 64;
+  static constexpr int HEADER_SIZE = 24 + 8 * BITMAP_WORD_COUNT;
+
   /**
    * Header related
    */
@@ -56,8 +68,9 @@ public:
                    LogManager *log_manager);
 
   // commit/abort time
-  void ApplyDelete(const RID &rid, Transaction *txn,
-                   LogManager *log_manager); // when commit success
+  // deleted tuple is copied into deleted_tuple if one is given
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager,
+                   Tuple *deleted_tuple = nullptr); // when commit success
   void RollbackDelete(const RID &rid, Transaction *txn,
                       LogManager *log_manager); // when commit abort
 
@@ -65,6 +78,25 @@ public:
   bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
                 LockManager *lock_manager);
 
+  // copy tuple area of page into buffer(PAGE_SIZE bytes) and append a view
+  // of every visible tuple in buffer to tuples, without locking them
+  void GetTuples(char *buffer, std::vector<TupleView> &tuples);
+
+  // lock tuples of page as GetTuple() does, drop those not granted
+  void LockTuples(std::vector<TupleView> &tuples, Transaction *txn,
+                  LockManager *lock_manager);
+
+  // size of the largest tuple InsertTuple() takes now
+  int32_t GetMaxInsertSize();
+
+  /**
+   * Compaction
+   * ApplyDelete() and UpdateTuple() leave holes between tuples, packed lazily
+   * when an insert or a growing update does not fit in free space otherwise
+   */
+  void Compact();
+  int32_t GetFragmentedSize();
+
   /**
    * Tuple iterator
    */
@@ -75,6 +107,11 @@ private:
   /**
    * helper functions
    */
+  void PackTuples();
+  int GetFreeSlot();
+  // first slot from slot_num on that is not empty, tuple count if none
+  int GetNextUsedSlot(int slot_num);
+  uint64_t *GetSlotBitmap();
   int32_t GetTupleOffset(int slot_num);
   int32_t GetTupleSize(int slot_num);
   void SetTupleOffset(int slot_num, int32_t offset);
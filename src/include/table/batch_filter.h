@@ -0,0 +1,59 @@
+/**
+ * batch_filter.h
+ *
+ * Comparisons of integer and decimal columns with constants, evaluated over a
+ * batch of tuples of a page(see TableBatchIterator) a column at a time
+ * instead of a tuple at a time: values of a column are copied out of the
+ * batch into an array first, then each predicate on it is a loop over the
+ * array without branches, which compiler turns into SIMD instructions. Tuples
+ * failing a predicate are dropped from batch.
+ * A null value fails every predicate, as it does in SQL.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "table/tuple_view.h"
+
+namespace cmudb {
+
+enum class CompareOp { EQ, LT, LE, GT, GE };
+
+// column <op> constant
+struct ScanPredicate {
+  int column_id;
+  CompareOp op;
+  // constant, integer one for an integer column, decimal one otherwise
+  int64_t integer = 0;
+  double decimal = 0;
+};
+
+class BatchFilter {
+public:
+  BatchFilter(Schema *schema, const std::vector<ScanPredicate> &predicates);
+
+  // whether predicates on column can be evaluated
+  static bool IsSupported(Schema *schema, int column_id);
+
+  // drop tuples failing any predicate from batch, keeping order of the rest
+  void Apply(std::vector<TupleView> &batch);
+
+private:
+  // copy values of a column into integers_ or decimals_, deselecting nulls
+  void ExtractIntegers(const std::vector<TupleView> &batch, int column_id);
+  void ExtractDecimals(const std::vector<TupleView> &batch, int column_id);
+
+  Schema *schema_;
+  // sorted by column, so that values of a column are extracted once
+  std::vector<ScanPredicate> predicates_;
+  // whether each tuple of batch passes so far, and values of current column,
+  // kept across batches so that they are allocated once
+  std::vector<uint8_t> selection_;
+  std::vector<int64_t> integers_;
+  std::vector<double> decimals_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,121 @@
+/**
+ * clustered_table.h
+ *
+ * Index-organized table: rows live in leaf pages of a B+ tree on primary key
+ * instead of a table heap next to an index, so a lookup by key reads one path
+ * of the tree and a scan reads rows in key order.
+ * (1) A leaf key is the row itself, primary key column first and the others
+ *     behind it(see IndexMetadata::GetEntrySchema()), compared by primary key
+ *     only. Its value is an invalid RID.
+ * (2) A row longer than CLUSTERED_INLINE_SIZE keeps just its primary key in
+ *     leaf, its value refers to a chain of overflow pages holding the row(see
+ *     include/table/overflow_chain.h)
+ * (3) Primary key is a single integer column, and rowid of its row as well
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
+#include "index/index.h"
+#include "table/tuple.h"
+
+namespace cmudb {
+
+// key size of the tree and longest row a leaf stores, a leaf of 512 byte page
+// holds one such row next to a high key that may be as long
+#define CLUSTERED_KEY_SIZE 256
+#define CLUSTERED_INLINE_SIZE 224
+
+#define CLUSTERED_TREE_TYPE                                                    \
+  BPlusTree<GenericKey<CLUSTERED_KEY_SIZE>, RID,                               \
+            GenericComparator<CLUSTERED_KEY_SIZE>>
+
+class ClusteredTableIterator;
+
+class ClusteredTable {
+  friend class ClusteredTableIterator;
+
+public:
+  // open a clustered table, or create one if root page id is invalid.
+  // metadata(primary key followed by every other column of schema) is owned
+  // by table from now on
+  ClusteredTable(IndexMetadata *metadata, Schema *schema,
+                 BufferPoolManager *buffer_pool_manager,
+                 page_id_t root_page_id = INVALID_PAGE_ID);
+
+  ~ClusteredTable() { delete metadata_; }
+
+  // primary key of tuple, which is its rowid
+  int64_t GetRowId(const Tuple &tuple) const;
+
+  // false if a row with the same primary key exists
+  bool InsertTuple(const Tuple &tuple, Transaction *txn);
+
+  bool DeleteTuple(int64_t row_id, Transaction *txn);
+
+  // false if primary key changes to the one of another row, nothing is
+  // changed then
+  bool UpdateTuple(const Tuple &tuple, int64_t row_id, Transaction *txn);
+
+  bool GetTuple(int64_t row_id, Tuple &tuple, Transaction *txn);
+
+  // same as above, primary key given as a tuple of key schema
+  bool GetTuple(const Tuple &key, Tuple &tuple, Transaction *txn);
+
+  ClusteredTableIterator begin();
+
+  inline IndexMetadata *GetMetadata() const { return metadata_; }
+
+private:
+  GenericKey<CLUSTERED_KEY_SIZE> MakeKey(int64_t row_id) const;
+  bool Lookup(const GenericKey<CLUSTERED_KEY_SIZE> &key, Tuple &tuple,
+              Transaction *txn);
+  void ReadRow(const GenericKey<CLUSTERED_KEY_SIZE> &key, const RID &value,
+               Tuple &tuple) const;
+
+  // overflow page chain of a row
+  page_id_t WriteOverflow(const Tuple &tuple);
+  void ReadOverflow(page_id_t page_id, Tuple &tuple) const;
+
+  IndexMetadata *metadata_;
+  Schema *schema_;
+  BufferPoolManager *buffer_pool_manager_;
+  GenericComparator<CLUSTERED_KEY_SIZE> comparator_;
+  CLUSTERED_TREE_TYPE tree_;
+  // column of entry schema each table column is stored in
+  std::vector<int> entry_columns_;
+};
+
+// For scan of clustered table in primary key order
+class ClusteredTableIterator {
+public:
+  ClusteredTableIterator(
+      ClusteredTable *table,
+      const IndexIterator<GenericKey<CLUSTERED_KEY_SIZE>, RID,
+                          GenericComparator<CLUSTERED_KEY_SIZE>> &iterator);
+
+  inline bool IsEnd() { return iterator_.isEnd(); }
+
+  inline const Tuple &operator*() { return tuple_; }
+
+  inline const Tuple *operator->() { return &tuple_; }
+
+  inline int64_t GetRowId() const { return table_->GetRowId(tuple_); }
+
+  ClusteredTableIterator &operator++();
+
+private:
+  void Load();
+
+  ClusteredTable *table_;
+  IndexIterator<GenericKey<CLUSTERED_KEY_SIZE>, RID,
+                GenericComparator<CLUSTERED_KEY_SIZE>>
+      iterator_;
+  // row iterator is at
+  Tuple tuple_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,75 @@
+/**
+ * free_space_map.h
+ *
+ * Free-space map of a table heap: how large a tuple each heap page takes,
+ * kept in buckets of BYTES_PER_BUCKET bytes, so an insert goes straight to a
+ * page with room instead of walking the page chain(see
+ * TableHeap::InsertTuple()).
+ * The map is persisted in a chain of free-space map pages(see
+ * include/page/free_space_map_page.h), and read into memory when opened.
+ * A bucket rounds free bytes down, so a page found has at least the room
+ * asked for as long as the map is up to date. The map is a hint only: map
+ * pages are not logged, and a page found without room is recorded again.
+ * A page found is claimed by one inserter until released(see
+ * TableHeap::InsertTuple()), so concurrent inserts go to different pages.
+ */
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/free_space_map_page.h"
+
+namespace cmudb {
+
+class FreeSpaceMap {
+public:
+  // bytes one bucket stands for, a bucket fits in one byte
+  static constexpr int BYTES_PER_BUCKET =
+      (PAGE_SIZE + UINT8_MAX) / (UINT8_MAX + 1);
+
+  // open the map whose first map page is first_page_id
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
+  // create an empty map
+  explicit FreeSpaceMap(BufferPoolManager *buffer_pool_manager);
+
+  // claim the first heap page recorded that takes a tuple of size bytes and
+  // is not claimed, INVALID_PAGE_ID if there is none
+  page_id_t ClaimPage(int size);
+
+  // record free bytes of a heap page(see TablePage::GetMaxInsertSize()), a
+  // page not recorded yet is appended, and claimed if claim is set
+  void Update(page_id_t page_id, int free_size, bool claim = false);
+
+  // record free bytes of a claimed heap page, and let it be claimed again
+  void ReleasePage(page_id_t page_id, int free_size);
+
+  // heap page recorded last, INVALID_PAGE_ID if map is empty
+  page_id_t GetLastPageId();
+
+  inline page_id_t GetFirstPageId() const { return map_page_ids_[0]; }
+
+private:
+  static int GetBucket(int free_size);
+  void Append(page_id_t page_id, int bucket);
+  void SetBucket(int slot, int bucket);
+
+  std::mutex latch_;
+  BufferPoolManager *buffer_pool_manager_;
+  // map pages in order, and the largest bucket each one records
+  std::vector<page_id_t> map_page_ids_;
+  std::vector<int> max_buckets_;
+  // heap pages and their buckets in slot order, slot i is kept in map page
+  // i / SLOT_COUNT
+  std::vector<page_id_t> heap_page_ids_;
+  std::vector<uint8_t> buckets_;
+  std::unordered_map<page_id_t, int> slots_;
+  // heap pages claimed by an inserter, in memory only
+  std::vector<bool> claimed_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,41 @@
+/**
+ * overflow_chain.h
+ *
+ * Chains of overflow pages(see include/page/overflow_page.h) holding bytes
+ * too long for the page that refers to them, e.g. a row of a clustered table
+ * or a long varchar value of a table heap tuple. Given a log manager, each
+ * page written or freed is logged while ENABLE_LOGGING is on, with what it
+ * holds, so that recovery redoes and undoes chains along with the tuples
+ * referring to them(see NEWOVERFLOWPAGE in include/logging/log_record.h).
+ * Clustered tables give none, as their B+ tree pages are not logged either.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "logging/log_manager.h"
+
+namespace cmudb {
+
+class OverflowChain {
+public:
+  // store size bytes of data in a new chain
+  // @return : page id of the first page
+  static page_id_t Write(BufferPoolManager *buffer_pool_manager,
+                         const char *data, int size,
+                         Transaction *txn = nullptr,
+                         LogManager *log_manager = nullptr);
+
+  // append bytes stored in chain to data
+  static void Read(BufferPoolManager *buffer_pool_manager, page_id_t page_id,
+                   std::vector<char> &data);
+
+  static void Delete(BufferPoolManager *buffer_pool_manager,
+                     page_id_t page_id, Transaction *txn = nullptr,
+                     LogManager *log_manager = nullptr);
+};
+
+} // namespace cmudb
@@ -1,34 +1,80 @@
 /**
  * table_heap.h
  *
- * doubly-linked list of heap pages
+ * doubly-linked list of heap pages, with a free-space map that tells which
+ * page an insert goes to(see include/table/free_space_map.h)
+ *
+ * Given schema of its tuples, a table heap stores a tuple longer than
+ * TOAST_THRESHOLD with its longest varchar values moved out to overflow page
+ * chains(see include/table/overflow_chain.h), longest first, until it is
+ * short enough. Such a value leaves a toast pointer behind, serialized in
+ * place of its length and data:
+ *  ------------------------------------------------------
+ * | TOAST_MARKER (4) | FirstPageId (4) | ValueLength (4) |
+ *  ------------------------------------------------------
+ * Tuples given out by GetTuple() and TableIterator have their values read back
+ * from overflow pages, a TupleView of a table page(see TableBatchIterator) is
+ * left as stored, so that GetValue() reads a chain only for a column asked
+ * for. Each version of a tuple owns its chains, freed when the version is
+ * gone for good: at commit of a delete or an update, at rollback of an insert
+ * or an update. Overflow pages are written and freed with log records of the
+ * transaction, so recovery restores the chains of the tuples it redoes and
+ * undoes.
+ *
+ * Pages of a table heap are either row pages(see include/page/table_page.h)
+ * or PAX pages(see include/page/pax_page.h), given by its PageLayout. A PAX
+ * heap needs a schema, stores every varchar value inline up to its declared
+ * length and toasts nothing. Its pages are not logged, so it is not created
+ * nor opened while ENABLE_LOGGING is on: the virtual table, which always logs,
+ * keeps row pages, and PAX is for heaps loaded and scanned with logging off
+ * until PaxPage writes log records of its own.
  */
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "logging/log_manager.h"
+#include "page/pax_page.h"
 #include "page/table_page.h"
+#include "table/free_space_map.h"
 #include "table/table_iterator.h"
 #include "table/tuple.h"
 
 namespace cmudb {
 
+enum class PageLayout { ROW, PAX };
+
 class TableHeap {
   friend class TableIterator;
+  friend class TableBatchIterator;
 
 public:
-  ~TableHeap() {}
-
-  // open a table heap
+  ~TableHeap() {
+    StopVacuumThread();
+    delete free_space_map_;
+  }
+
+  // open a table heap, its free-space map is rebuilt from the page chain if
+  // map page id is not given. Long tuples are toasted if schema is given.
+  // Layout has to be the one heap was created with
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
-            LogManager *log_manager, page_id_t first_page_id);
+            LogManager *log_manager, page_id_t first_page_id,
+            page_id_t free_space_map_page_id = INVALID_PAGE_ID,
+            Schema *schema = nullptr, PageLayout layout = PageLayout::ROW);
 
   // create table heap
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
-            LogManager *log_manager, Transaction *txn);
+            LogManager *log_manager, Transaction *txn,
+            Schema *schema = nullptr, PageLayout layout = PageLayout::ROW);
 
-  // for insert, if tuple is too large (>~page_size), return false
+  // for insert, if tuple is too large (>~page_size) even when toasted, or
+  // longer than declared in a PAX heap, return false
   bool InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn);
 
   bool MarkDelete(const RID &rid, Transaction *txn); // for delete
@@ -41,18 +87,55 @@ public:
   void ApplyDelete(const RID &rid,
                    Transaction *txn); // when commit delete or rollback insert
   void RollbackDelete(const RID &rid, Transaction *txn); // when rollback delete
+  void ApplyUpdate(const Tuple &old_tuple,
+                   Transaction *txn); // when commit update
 
   bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn);
 
+  // value of a column of a tuple as stored in a table page, read from its
+  // overflow pages if toasted
+  Value GetValue(const TupleView &tuple, int column_id);
+
   bool DeleteTableHeap();
 
+  // compact pages with at least VACUUM_THRESHOLD bytes of holes(see
+  // TablePage::Compact()), return number of pages compacted
+  int Vacuum();
+
+  // spawn a separate thread that vacuums once every interval, until stopped
+  void RunVacuumThread(std::chrono::milliseconds interval);
+  void StopVacuumThread();
+
   TableIterator begin(Transaction *txn);
 
   TableIterator end();
 
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  inline PageLayout GetLayout() const { return layout_; }
+
+  inline page_id_t GetFreeSpaceMapPageId() const {
+    return free_space_map_->GetFirstPageId();
+  }
+
 private:
+  TablePage *ClaimPage(int size, Transaction *txn);
+
+  // page operations that differ between layouts
+  void CheckLayout();
+  void InitPage(TablePage *page, page_id_t page_id, page_id_t prev_page_id,
+                Transaction *txn);
+  int32_t GetMaxInsertSize(TablePage *page);
+  inline PaxPage *AsPax(TablePage *page) {
+    return reinterpret_cast<PaxPage *>(page);
+  }
+
+  // toast
+  bool Toast(const Tuple &tuple, Tuple &toasted, Transaction *txn);
+  void Detoast(Tuple &tuple);
+  void DeleteToast(const Tuple &tuple, Transaction *txn);
+  bool IsToasted(const TupleView &tuple, int column_id);
+
   /**
    * Members
    */
@@ -60,6 +143,27 @@ private:
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_;
+  FreeSpaceMap *free_space_map_;
+  // tuples are not toasted without one
+  Schema *schema_;
+  PageLayout layout_;
+  // one thread appends pages to page chain at a time
+  std::mutex append_latch_;
+  // page each thread inserts into, threads take turns over the targets(see
+  // InsertTuple())
+  static constexpr int INSERT_TARGET_COUNT = 16;
+  std::vector<page_id_t> insert_targets_;
+  std::vector<std::mutex> insert_target_latches_;
+  // toast pointer(see above)
+  static constexpr int TOAST_THRESHOLD = PAGE_SIZE / 4;
+  static constexpr uint32_t TOAST_MARKER = PELOTON_VALUE_NULL - 1;
+  static constexpr int TOAST_POINTER_SIZE = 12;
+  // vacuum thread
+  static constexpr int VACUUM_THRESHOLD = PAGE_SIZE / 4;
+  std::thread *vacuum_thread_ = nullptr;
+  std::mutex vacuum_latch_;
+  std::condition_variable vacuum_cv_;
+  bool vacuum_stopped_ = false;
 };
 
 } // namespace cmudb
@@ -7,9 +7,13 @@
 #pragma once
 
 #include <cassert>
+#include <vector>
 
+#include "common/config.h"
 #include "common/rid.h"
+#include "table/batch_filter.h"
 #include "table/tuple.h"
+#include "table/tuple_view.h"
 
 namespace cmudb {
 
@@ -45,4 +49,47 @@ private:
   Transaction *txn_;
 };
 
+// For seq scan of table heap a page at a time: visible tuples of a page are
+// read into a batch under one pin and latch of it, as views into a copy of
+// the page instead of being copied one by one. A view and values read from
+// it are valid until iterator moves to next page.
+// Of a PAX heap, only columns in column_ids are read, the others are null(all
+// of them if column_ids is empty). A row heap reads every column regardless.
+// Given a filter, only tuples passing it are in batches, and only those are
+// locked(PAX pages lock as they read, but are never read while logging): a
+// tuple another transaction is writing is filtered on the value it wrote.
+class TableBatchIterator {
+public:
+  TableBatchIterator(TableHeap *table_heap, Transaction *txn,
+                     const std::vector<int> &column_ids = {},
+                     BatchFilter *filter = nullptr);
+
+  // tuples of batch are views into page_data_ or pax_data_
+  TableBatchIterator(const TableBatchIterator &) = delete;
+  TableBatchIterator &operator=(const TableBatchIterator &) = delete;
+
+  inline bool IsEnd() const { return offset_ == batch_.size(); }
+
+  inline const TupleView &operator*() const { return batch_[offset_]; }
+
+  inline const TupleView *operator->() const { return &batch_[offset_]; }
+
+  TableBatchIterator &operator++();
+
+private:
+  // read pages from next_page_id_ on until one has a visible tuple
+  void LoadBatch();
+
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  std::vector<int> column_ids_;
+  BatchFilter *filter_;
+  page_id_t next_page_id_;
+  std::vector<TupleView> batch_;
+  size_t offset_ = 0;
+  char page_data_[PAGE_SIZE];
+  // tuples of a PAX page rebuilt in row format
+  std::vector<char> pax_data_;
+};
+
 } // namespace cmudb
\ No newline at end of file
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "catalog/schema.h"
+#include "common/arena.h"
 #include "common/rid.h"
 #include "type/value.h"
 
@@ -18,6 +19,8 @@ namespace cmudb {
 class Tuple {
   friend class TablePage;
 
+  friend class PaxPage;
+
   friend class TableHeap;
 
   friend class TableIterator;
@@ -32,6 +35,11 @@ public:
   // constructor for creating a new tuple based on input value
   Tuple(std::vector<Value> values, Schema *schema);
 
+  // same as above, one value for each column of schema. Data comes from arena
+  // if one is given: tuple does not own it then, copies of tuple are shallow
+  // and all of them are valid until arena is reset
+  Tuple(const Value *values, Schema *schema, Arena *arena);
+
   // copy constructor, deep copy
   Tuple(const Tuple &other);
 
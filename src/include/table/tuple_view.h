@@ -0,0 +1,52 @@
+/**
+ * tuple_view.h
+ *
+ * Non-owning view of a tuple(see include/table/tuple.h), for read paths that
+ * need no copy of their own. Data viewed must outlive the view, and so must
+ * values read from it: a varchar value points into viewed data.
+ */
+
+#pragma once
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "table/tuple.h"
+#include "type/value.h"
+
+namespace cmudb {
+
+class TupleView {
+public:
+  TupleView() : rid_(RID()), size_(0), data_(nullptr) {}
+
+  TupleView(RID rid, const char *data, int32_t size)
+      : rid_(rid), size_(size), data_(data) {}
+
+  // view of a tuple, valid as long as tuple is not changed
+  explicit TupleView(const Tuple &tuple)
+      : rid_(tuple.GetRid()), size_(tuple.GetLength()), data_(tuple.GetData()) {
+  }
+
+  inline RID GetRid() const { return rid_; }
+
+  inline const char *GetData() const { return data_; }
+
+  inline int32_t GetLength() const { return size_; }
+
+  // same as Tuple::GetValue(), without a copy of varchar data
+  Value GetValue(Schema *schema, const int column_id) const;
+
+  // where column is serialized, behind its length for a varchar
+  const char *GetDataPtr(Schema *schema, const int column_id) const;
+
+  inline bool IsNull(Schema *schema, const int column_id) const {
+    return GetValue(schema, column_id).IsNull();
+  }
+
+private:
+  RID rid_;
+  int32_t size_;
+  const char *data_;
+};
+
+} // namespace cmudb
@@ -4,14 +4,19 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "buffer/lru_replacer.h"
 #include "catalog/schema.h"
 #include "concurrency/transaction_manager.h"
 #include "index/b_plus_tree_index.h"
+#include "index/hash_index.h"
 #include "logging/log_manager.h"
 #include "sqlite/sqlite3ext.h"
+#include "table/clustered_table.h"
 #include "table/table_heap.h"
 #include "table/tuple.h"
+#include "table/tuple_view.h"
 #include "type/value.h"
 
 namespace cmudb {
@@ -22,7 +27,15 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
                                    const std::string &table_name,
                                    Schema *schema);
 
-Tuple ConstructTuple(Schema *schema, sqlite3_value **argv);
+// tuple data comes from arena if one is given(see Tuple), varchar values are
+// read in place from argv either way
+Tuple ConstructTuple(Schema *schema, sqlite3_value **argv,
+                     Arena *arena = nullptr);
+
+// predicates pushed down by VtabBestIndex(), with constants from argv
+std::vector<ScanPredicate> ConstructPredicates(Schema *schema,
+                                               const char *idxStr, int argc,
+                                               sqlite3_value **argv);
 
 Index *ConstructIndex(IndexMetadata *metadata,
                       BufferPoolManager *buffer_pool_manager,
@@ -106,17 +119,23 @@ class VirtualTable {
 public:
   VirtualTable(Schema *schema, BufferPoolManager *buffer_pool_manager,
                LockManager *lock_manager, LogManager *log_manager, Index *index,
-               page_id_t first_page_id = INVALID_PAGE_ID)
-      : schema_(schema), index_(index) {
-    if (first_page_id != INVALID_PAGE_ID) {
+               page_id_t first_page_id = INVALID_PAGE_ID,
+               page_id_t free_space_map_page_id = INVALID_PAGE_ID,
+               ClusteredTable *clustered_table = nullptr)
+      : schema_(schema), index_(index), clustered_table_(clustered_table) {
+    if (clustered_table != nullptr) {
+      // tuples live in clustered index, there is no table heap
+      table_heap_ = nullptr;
+    } else if (first_page_id != INVALID_PAGE_ID) {
       // reopen an exist table
-      table_heap_ = new TableHeap(buffer_pool_manager, lock_manager,
-                                  log_manager, first_page_id);
+      table_heap_ =
+          new TableHeap(buffer_pool_manager, lock_manager, log_manager,
+                        first_page_id, free_space_map_page_id, schema);
     } else {
       // create table for the first time
       Transaction *txn = storage_engine_->transaction_manager_->Begin();
-      table_heap_ =
-          new TableHeap(buffer_pool_manager, lock_manager, log_manager, txn);
+      table_heap_ = new TableHeap(buffer_pool_manager, lock_manager,
+                                  log_manager, txn, schema);
       storage_engine_->transaction_manager_->Commit(txn);
     }
   }
@@ -125,29 +144,77 @@ public:
     delete schema_;
     delete table_heap_;
     delete index_;
+    delete clustered_table_;
   }
 
   // insert into table heap
   inline bool InsertTuple(const Tuple &tuple, RID &rid) {
+    if (clustered_table_ != nullptr) {
+      if (!clustered_table_->InsertTuple(tuple, GetTransaction()))
+        throw Exception(EXCEPTION_TYPE_CONSTRAINT, "duplicate primary key");
+      rid = RID(clustered_table_->GetRowId(tuple));
+      return true;
+    }
     return table_heap_->InsertTuple(tuple, rid, GetTransaction());
   }
 
+  // construct indexed key tuple, followed by included columns if any
+  // entry data comes from arena if one is given(see Tuple)
+  inline Tuple IndexEntry(const Tuple &tuple, Arena *arena = nullptr) {
+    TupleView view(tuple);
+    std::vector<Value, ArenaAllocator<Value>> entry_values{
+        ArenaAllocator<Value>(arena)};
+    entry_values.reserve(index_->GetKeyAttrs().size() +
+                         index_->GetIncludedAttrs().size());
+
+    for (auto &i : index_->GetKeyAttrs())
+      entry_values.push_back(view.GetValue(schema_, i));
+    for (auto &i : index_->GetIncludedAttrs())
+      entry_values.push_back(view.GetValue(schema_, i));
+    return Tuple(entry_values.data(), index_->GetEntrySchema(), arena);
+  }
+
   // insert into index
   inline void InsertEntry(const Tuple &tuple, const RID &rid) {
     if (index_ == nullptr)
       return;
-    // construct indexed key tuple
-    std::vector<Value> key_values;
+    index_->InsertEntry(IndexEntry(tuple, &arena_), rid, GetTransaction());
+  }
 
+  // whether index entries hold every column in mask, bit i stands for column
+  // i and bit 63 for all the columns from 63 on(see sqlite3_index_info)
+  inline bool IndexCovers(uint64_t mask) {
+    if (index_ == nullptr)
+      return false;
+    uint64_t covered = 0;
     for (auto &i : index_->GetKeyAttrs())
-      key_values.push_back(tuple.GetValue(schema_, i));
-    Tuple key(key_values, index_->GetKeySchema());
-    index_->InsertEntry(key, rid, GetTransaction());
+      covered |= 1ULL << std::min(i, 63);
+    for (auto &i : index_->GetIncludedAttrs())
+      covered |= 1ULL << std::min(i, 63);
+    // included column 63 does not make up for the ones behind it
+    if (schema_->GetColumnCount() > 64)
+      covered &= ~(1ULL << 63);
+    return (mask & ~covered) == 0;
+  }
+
+  // build a newly declared index over the tuples already in table heap
+  inline void BuildIndex() {
+    if (index_ == nullptr)
+      return;
+    Transaction *txn = storage_engine_->transaction_manager_->Begin();
+    std::vector<std::pair<Tuple, RID>> entries;
+    for (auto itr = table_heap_->begin(txn); itr != table_heap_->end(); ++itr)
+      entries.emplace_back(IndexEntry(*itr), itr->GetRid());
+    index_->BulkLoad(entries, txn);
+    storage_engine_->transaction_manager_->Commit(txn);
+    delete txn;
   }
 
   // delete from table heap
   // TODO: call makrdelete method from heaptable
   inline bool DeleteTuple(const RID &rid) {
+    if (clustered_table_ != nullptr)
+      return clustered_table_->DeleteTuple(rid.Get(), GetTransaction());
     return table_heap_->MarkDelete(rid, GetTransaction());
   }
 
@@ -157,32 +224,50 @@ public:
       return;
     Tuple deleted_tuple(rid);
     table_heap_->GetTuple(rid, deleted_tuple, GetTransaction());
-    // construct indexed key tuple
-    std::vector<Value> key_values;
-
-    for (auto &i : index_->GetKeyAttrs())
-      key_values.push_back(deleted_tuple.GetValue(schema_, i));
-    Tuple key(key_values, index_->GetKeySchema());
-    index_->DeleteEntry(key, GetTransaction());
+    index_->DeleteEntry(IndexEntry(deleted_tuple, &arena_), rid,
+                        GetTransaction());
   }
 
   // update table heap tuple
   inline bool UpdateTuple(const Tuple &tuple, const RID &rid) {
+    if (clustered_table_ != nullptr) {
+      if (!clustered_table_->UpdateTuple(tuple, rid.Get(), GetTransaction()))
+        throw Exception(EXCEPTION_TYPE_CONSTRAINT, "duplicate primary key");
+      return true;
+    }
     // if failed try to delete and insert
     return table_heap_->UpdateTuple(tuple, rid, GetTransaction());
   }
 
-  inline TableIterator begin() { return table_heap_->begin(GetTransaction()); }
-
-  inline TableIterator end() { return table_heap_->end(); }
-
   inline Schema *GetSchema() { return schema_; }
 
   inline Index *GetIndex() { return index_; }
 
+  inline ClusteredTable *GetClusteredTable() { return clustered_table_; }
+
+  // columns index scans look up, of index or clustered index
+  inline const std::vector<int> &GetKeyAttrs() {
+    if (clustered_table_ != nullptr)
+      return clustered_table_->GetMetadata()->GetKeyAttrs();
+    return index_->GetKeyAttrs();
+  }
+
   inline TableHeap *GetTableHeap() { return table_heap_; }
 
-  inline page_id_t GetFirstPageId() { return table_heap_->GetFirstPageId(); }
+  // scratch memory for rows being written, reset once per VtabUpdate() call
+  inline Arena *GetArena() { return &arena_; }
+
+  inline page_id_t GetFirstPageId() {
+    if (clustered_table_ != nullptr)
+      return INVALID_PAGE_ID;
+    return table_heap_->GetFirstPageId();
+  }
+
+  inline page_id_t GetFreeSpaceMapPageId() {
+    if (clustered_table_ != nullptr)
+      return INVALID_PAGE_ID;
+    return table_heap_->GetFreeSpaceMapPageId();
+  }
 
 private:
   sqlite3_vtab base_;
@@ -192,12 +277,27 @@ private:
   TableHeap *table_heap_;
   // to insert/delete index entry
   Index *index_ = nullptr;
+  // stores tuples instead of table heap if not null
+  ClusteredTable *clustered_table_ = nullptr;
+  // for tuples and index entries of rows being written
+  Arena arena_;
 };
 
 class Cursor {
 public:
-  Cursor(VirtualTable *virtual_table)
-      : table_iterator_(virtual_table->begin()), virtual_table_(virtual_table) {
+  Cursor(VirtualTable *virtual_table) : virtual_table_(virtual_table) {
+    if (virtual_table->clustered_table_ != nullptr)
+      clustered_iterator_ = new ClusteredTableIterator(
+          virtual_table->clustered_table_->begin());
+    else
+      table_iterator_ =
+          new TableBatchIterator(virtual_table->table_heap_, GetTransaction());
+  }
+
+  ~Cursor() {
+    delete table_iterator_;
+    delete clustered_iterator_;
+    delete filter_;
   }
 
   inline void SetScanFlag(bool is_index_scan) {
@@ -206,28 +306,67 @@ public:
 
   inline bool IsIndexScan() { return is_index_scan_; }
 
+  // sequential scan from the first tuple again, of tuples passing predicates
+  // only
+  inline void SetPredicates(const std::vector<ScanPredicate> &predicates) {
+    delete table_iterator_;
+    delete filter_;
+    filter_ = new BatchFilter(virtual_table_->schema_, predicates);
+    table_iterator_ = new TableBatchIterator(virtual_table_->table_heap_,
+                                             GetTransaction(), {}, filter_);
+  }
+
+  // read columns from index entries where they have one(covering index)
+  inline void SetIndexOnly(bool is_index_only) {
+    is_index_only_ = is_index_only;
+    entry_columns_.assign(virtual_table_->schema_->GetColumnCount(), -1);
+    if (!is_index_only)
+      return;
+    int entry_column = 0;
+    for (auto &i : virtual_table_->index_->GetKeyAttrs())
+      entry_columns_[i] = entry_column++;
+    for (auto &i : virtual_table_->index_->GetIncludedAttrs())
+      entry_columns_[i] = entry_column++;
+  }
+
   inline VirtualTable *GetVirtualTable() { return virtual_table_; }
 
   inline Schema *GetKeySchema() {
+    if (virtual_table_->clustered_table_ != nullptr)
+      return virtual_table_->clustered_table_->GetMetadata()->GetKeySchema();
     return virtual_table_->index_->GetKeySchema();
   }
   // return rid at which cursor is currently pointed
   inline int64_t GetCurrentRid() {
     if (is_index_scan_)
       return results[offset_].Get();
+    else if (clustered_iterator_ != nullptr)
+      return clustered_iterator_->GetRowId();
     else
-      return (*table_iterator_).GetRid().Get();
+      return (*table_iterator_)->GetRid().Get();
   }
 
   // return tuple at which cursor is currently pointed
+  // value read from data cursor holds is a view, valid until cursor moves
   inline Value GetCurrentValue(Schema *schema, int column) {
     if (is_index_scan_) {
+      Tuple &entry = entries_[offset_];
+      // clustered index scans find whole tuples
+      if (virtual_table_->clustered_table_ != nullptr)
+        return TupleView(entry).GetValue(schema, column);
+      if (is_index_only_ && entry.IsAllocated() &&
+          entry_columns_[column] != -1)
+        return TupleView(entry).GetValue(
+            virtual_table_->index_->GetEntrySchema(), entry_columns_[column]);
       RID rid = results[offset_];
       Tuple tuple(rid);
       virtual_table_->table_heap_->GetTuple(rid, tuple, GetTransaction());
       return tuple.GetValue(schema, column);
+    } else if (clustered_iterator_ != nullptr) {
+      return (*clustered_iterator_)->GetValue(schema, column);
     } else {
-      return table_iterator_->GetValue(schema, column);
+      // a toasted value is read from its overflow pages just now
+      return virtual_table_->table_heap_->GetValue(**table_iterator_, column);
     }
   }
 
@@ -235,30 +374,57 @@ public:
   Cursor &operator++() {
     if (is_index_scan_)
       ++offset_;
+    else if (clustered_iterator_ != nullptr)
+      ++(*clustered_iterator_);
     else
-      ++table_iterator_;
+      ++(*table_iterator_);
     return *this;
   }
   // is end of cursor(no more tuple)
   inline bool isEof() {
     if (is_index_scan_)
       return offset_ == static_cast<int>(results.size());
+    else if (clustered_iterator_ != nullptr)
+      return clustered_iterator_->IsEnd();
     else
-      return table_iterator_ == virtual_table_->end();
+      return table_iterator_->IsEnd();
   }
 
   // wrapper around poit scan methods
   inline void ScanKey(const Tuple &key) {
-    virtual_table_->index_->ScanKey(key, results);
+    if (virtual_table_->clustered_table_ != nullptr) {
+      ClusteredTable *table = virtual_table_->clustered_table_;
+      Tuple tuple;
+      results.clear();
+      entries_.clear();
+      if (table->GetTuple(key, tuple, GetTransaction())) {
+        results.push_back(RID(table->GetRowId(tuple)));
+        entries_.push_back(tuple);
+      }
+      return;
+    }
+    if (is_index_only_)
+      virtual_table_->index_->ScanKey(key, results, entries_);
+    else
+      virtual_table_->index_->ScanKey(key, results);
+    entries_.resize(results.size());
   }
 
 private:
   sqlite3_vtab_cursor base_; /* Base class - must be first */
   // for index scan
   std::vector<RID> results;
+  // entries stored with results in index, unallocated ones are read from heap
+  std::vector<Tuple> entries_;
+  // column of entry schema each table column is read from, -1 if none
+  std::vector<int> entry_columns_;
+  bool is_index_only_ = false;
   int offset_ = 0;
-  // for sequential scan
-  TableIterator table_iterator_;
+  // for sequential scan, a page of tuples at a time
+  TableBatchIterator *table_iterator_ = nullptr;
+  // predicates pushed down to sequential scan, if any
+  BatchFilter *filter_ = nullptr;
+  ClusteredTableIterator *clustered_iterator_ = nullptr;
   // flag to indicate which scan method is currently used
   bool is_index_scan_ = false;
   VirtualTable *virtual_table_;
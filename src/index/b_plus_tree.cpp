@@ -1,7 +1,9 @@
 /**
  * b_plus_tree.cpp
  */
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <assert.h>
 
@@ -17,9 +19,15 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(const std::string &name,
                                 BufferPoolManager *buffer_pool_manager,
                                 const KeyComparator &comparator,
-                                page_id_t root_page_id)
+                                page_id_t root_page_id, bool unique_key)
     : index_name_(name), root_page_id_(root_page_id),
-      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator) {}
+      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
+      unique_key_(unique_key), structure_version_(0),
+      upper_level_pages_(DEFAULT_UPPER_LEVEL_PAGES), split_count_(0),
+      upper_level_misses_(0), lazy_merge_(false), rebalance_stop_(false) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() { StopRebalanceThread(); }
 
 INDEX_TEMPLATE_ARGUMENTS
 thread_local bool BPLUSTREE_TYPE::root_is_locked = false;
@@ -46,6 +54,11 @@ void BPLUSTREE_TYPE::UnLockUnPinPages(Transaction *transaction, OpType op, bool
       transaction->GetPageSet()->pop_front();
       buffer_pool_manager_->UnpinPage(toUnlock->GetPageId(), dirty);
   }
+  // pages merged away are deleted once nobody is holding them
+  for (page_id_t page_id : *transaction->GetDeletedPageSet()) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  transaction->GetDeletedPageSet()->clear();
 
   if (root_is_locked) {
     root_is_locked = false;
@@ -57,39 +70,179 @@ void BPLUSTREE_TYPE::UnLockUnPinPages(Transaction *transaction, OpType op, bool
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the only value that associated with input key, or every value of a
+ * non-unique key
  * This method is used for point query
+ * A reader holds one latch at a time(see FindLeafPageByLinks()), so it may
+ * miss a key moved left by a merge or redistribution in the meantime. Then it
+ * looks again, latch coupled once that happened too often.
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
                               std::vector<ValueType> &result,
                               Transaction *transaction) {
-  
-  auto *leaf = FindLeafPage(key, root_page_id_, transaction, SEARCH);
-  if (leaf == nullptr) {
-    return false;
-  }           
+  KeyType stored_key;
+  bool has_stored_key;
+  return GetValue(key, result, stored_key, has_stored_key, transaction);
+}
+
+/*
+ * Keys equal under comparator may still differ in bytes it does not compare,
+ * e.g. included columns of a covering index. stored_key is the one in leaf,
+ * it only belongs to the value when that is kept inline. Values in a posting
+ * list share one leaf key, which has_stored_key = false tells.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
+                              std::vector<ValueType> &result,
+                              KeyType &stored_key, bool &has_stored_key,
+                              Transaction *transaction) {
+  for (int attempt = 0;; attempt++) {
+    bool coupled = transaction == nullptr || attempt == MAX_SEARCH_RETRY;
+    uint64_t version = structure_version_;
+    B_PLUS_TREE_LEAF_PAGE_TYPE *leaf = nullptr;
+    if (coupled) {
+      leaf = FindLeafPage(key, root_page_id_, transaction, SEARCH);
+    } else if (Page *page = FindLeafPageByLinks(key, SEEK_KEY)) {
+      transaction->AddIntoPageSet(page);
+      leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+    }
+    if (leaf == nullptr) {
+      return false;
+    }
+
+    result.resize(1);
+    bool found = leaf->Lookup(key, result[0], comparator_, &stored_key);
+    has_stored_key = found;
+    if (found && !unique_key_ &&
+        BPlusTreePostingPage::IsReference(result[0])) {
+      page_id_t posting_page_id = result[0].GetPageId();
+      result.clear();
+      GetPostingList(posting_page_id, result);
+      has_stored_key = false;
+    } else if (!found) {
+      result.clear();
+    }
 
-  result.resize(1);              
-  ValueType v;
-  if (leaf->Lookup(key, result[0], comparator_)) {
     if (transaction) {
       UnLockUnPinPages(transaction, SEARCH, false);
     } else {
-        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    }
+    if (found || coupled || version == structure_version_) {
+      return found;
     }
-    return true; // return false if duplicate
   }
- 
-  result.clear();
-  
-  if (transaction) {
-    UnLockUnPinPages(transaction, SEARCH, false);
+}
+
+/*
+ * Return the values of each key of a batch, result[i] is empty if keys[i] does
+ * not exist
+ * Keys are sorted and descend together, so every page on their paths is read
+ * once, resolving all keys that fall on it, instead of once per key. Child
+ * pages of a page are visited in key order, each one fetched before we
+ * descend into the one before it. Pages are read like FindLeafPageByLinks()
+ * does, keys that may have been missed because of a merge are looked up
+ * again one by one with GetValue().
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MultiGet(const std::vector<KeyType> &keys,
+                              std::vector<std::vector<ValueType>> &result,
+                              Transaction *transaction) {
+  result.assign(keys.size(), std::vector<ValueType>());
+  std::vector<int> order(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    order[i] = static_cast<int>(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+    return comparator_(keys[lhs], keys[rhs]) < 0;
+  });
+
+  uint64_t version = structure_version_;
+  lockRoot();
+  if (IsEmpty() || keys.empty()) {
+    unlockRoot();
+    return;
+  }
+  Page *rawPage = buffer_pool_manager_->FetchPage(root_page_id_);
+  unlockRoot();
+
+  std::vector<int> missed;
+  MultiGetFromPage(rawPage, keys, order, 0, static_cast<int>(order.size()),
+                   version, result, missed);
+  for (int i : missed) {
+    GetValue(keys[i], result[i], transaction);
+  }
+}
+
+/*
+ * Resolve keys order[begin, end) from pinned page, and unpin it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MultiGetFromPage(
+    Page *rawPage, const std::vector<KeyType> &keys,
+    const std::vector<int> &order, int begin, int end, uint64_t version,
+    std::vector<std::vector<ValueType>> &result, std::vector<int> &missed) {
+  // page id and first key of each run of keys sent down to one page
+  std::vector<std::pair<page_id_t, int>> runs;
+  rawPage->RLatch();
+  auto *page = reinterpret_cast<BPlusTreePage *>(rawPage->GetData());
+  if (page->IsMergedAway()) {
+    missed.insert(missed.end(), order.begin() + begin, order.begin() + end);
+  } else if (page->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page);
+    int i = begin;
+    for (; i < end && !MoveRight(leaf, keys[order[i]], SEEK_KEY); i++) {
+      std::vector<ValueType> &values = result[order[i]];
+      values.resize(1);
+      bool found = leaf->Lookup(keys[order[i]], values[0], comparator_);
+      if (found && !unique_key_ &&
+          BPlusTreePostingPage::IsReference(values[0])) {
+        page_id_t posting_page_id = values[0].GetPageId();
+        values.clear();
+        GetPostingList(posting_page_id, values);
+      } else if (!found) {
+        values.clear();
+        if (version != structure_version_) {
+          missed.push_back(order[i]);
+        }
+      }
+    }
+    // the rest has moved right by a split
+    if (i < end) {
+      runs.push_back(std::make_pair(leaf->GetNextPageId(), i));
+    }
   } else {
-      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+    auto *internal = reinterpret_cast<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page);
+    for (int i = begin; i < end; i++) {
+      page_id_t child_id = MoveRight(internal, keys[order[i]], SEEK_KEY)
+                               ? internal->GetNextPageId()
+                               : internal->Lookup(keys[order[i]], comparator_);
+      if (runs.empty() || runs.back().first != child_id) {
+        runs.push_back(std::make_pair(child_id, i));
+      }
+    }
+  }
+  rawPage->RUnlatch();
+  buffer_pool_manager_->UnpinPage(rawPage->GetPageId(), false);
+
+  if (runs.empty()) {
+    return;
+  }
+  Page *child = buffer_pool_manager_->FetchPage(runs[0].first);
+  for (size_t i = 0; i < runs.size(); i++) {
+    Page *ahead = nullptr;
+    if (i + 1 < runs.size()) {
+      ahead = buffer_pool_manager_->FetchPage(runs[i + 1].first);
+      __builtin_prefetch(ahead->GetData());
+    }
+    int run_end = i + 1 < runs.size() ? runs[i + 1].second : end;
+    MultiGetFromPage(child, keys, order, runs[i].second, run_end, version,
+                     result, missed);
+    child = ahead;
   }
-  return false;
 }
 
 /*****************************************************************************
@@ -99,8 +252,8 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: for unique key, if user try to insert duplicate keys return false,
+ * otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value,
@@ -110,10 +263,163 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value,
     if (IsEmpty()) {
       StartNewTree(key, value);
       UpdateRootPageId(true);    
+      return true;
     }
   }
   return InsertIntoLeaf(key, value, transaction);
 }
+/*
+ * Insert key & value pairs, sorted here by key, and return how many of them
+ * went in(see Insert() for duplicates).
+ * Ingest in about key order keeps hitting the same leaf, so every pair up to
+ * its high key is added under one write latch, without descending again.
+ * A full leaf is split once for all the pairs that fall on it and go beyond
+ * it(see InsertBatchSplit()), and left full instead of half full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::InsertBatch(const std::vector<MappingType> &items,
+                                Transaction *transaction) {
+  std::vector<MappingType> sorted(items);
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [&](const MappingType &lhs, const MappingType &rhs) {
+                     return comparator_(lhs.first, rhs.first) < 0;
+                   });
+
+  int inserted = 0;
+  size_t i = 0;
+  while (i < sorted.size()) {
+    // no latch of a leaf to hold while root is a leaf(see FindLeafPage())
+    B_PLUS_TREE_LEAF_PAGE_TYPE *leaf = nullptr;
+    if (transaction != nullptr) {
+      leaf = FindLeafPage(sorted[i].first, root_page_id_, transaction, INSERT,
+                          false, true);
+    }
+    if (leaf == nullptr) {
+      inserted += Insert(sorted[i].first, sorted[i].second, transaction);
+      i++;
+      continue;
+    }
+
+    bool full = false;
+    while (i < sorted.size() && !full &&
+           (leaf->GetNextPageId() == INVALID_PAGE_ID ||
+            comparator_(sorted[i].first, leaf->GetHighKey()) < 0)) {
+      const KeyType &key = sorted[i].first;
+      ValueType v;
+      if (leaf->Lookup(key, v, comparator_)) {
+        inserted += !unique_key_ &&
+                    InsertIntoPostingList(leaf, key, v, sorted[i].second);
+        i++;
+      } else if (leaf->Insert(key, sorted[i].second, comparator_)) {
+        inserted++;
+        i++;
+      } else {
+        full = true;
+      }
+    }
+    UnLockUnPinPages(transaction, INSERT, true);
+    if (full) {
+      inserted += InsertBatchSplit(sorted, i, transaction);
+    }
+  }
+  return inserted;
+}
+
+/*
+ * Split the leaf items[next] goes to into two pages, together with the pairs
+ * after it that also fall on this leaf as long as two pages hold them. Left
+ * page is filled up, so pages an ascending ingest leaves behind are full.
+ * Leaf is latched like for a single insertion, which may add one key to
+ * parent. Advance next past the pairs inserted.
+ * @return: number of pairs inserted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::InsertBatchSplit(const std::vector<MappingType> &items,
+                                     size_t &next, Transaction *transaction) {
+  auto *leaf = FindLeafPage(items[next].first, root_page_id_, transaction,
+                            INSERT);
+  if (leaf == nullptr) {
+    UnLockUnPinPages(transaction, INSERT, false);
+    next++;
+    return Insert(items[next - 1].first, items[next - 1].second, transaction);
+  }
+  ValueType v;
+  // leaf may have changed since we found it full
+  if (leaf->Lookup(items[next].first, v, comparator_)) {
+    UnLockUnPinPages(transaction, INSERT, false);
+    return 0;
+  }
+  if (leaf->Insert(items[next].first, items[next].second, comparator_)) {
+    UnLockUnPinPages(transaction, INSERT, true);
+    next++;
+    return 1;
+  }
+
+  std::vector<MappingType> old_items;
+  leaf->GetItems(old_items);
+  bool has_high_key = leaf->GetNextPageId() != INVALID_PAGE_ID;
+  size_t end = next;
+  while (end < items.size() &&
+         (!has_high_key ||
+          comparator_(items[end].first, leaf->GetHighKey()) < 0) &&
+         (end == next ||
+          comparator_(items[end - 1].first, items[end].first) < 0) &&
+         !leaf->Lookup(items[end].first, v, comparator_) &&
+         end - next < old_items.size()) {
+    end++;
+  }
+
+  std::vector<MappingType> merged;
+  std::vector<int> points;
+  while (end > next) {
+    merged.clear();
+    std::merge(old_items.begin(), old_items.end(), items.begin() + next,
+               items.begin() + end, std::back_inserter(merged),
+               [&](const MappingType &lhs, const MappingType &rhs) {
+                 return comparator_(lhs.first, rhs.first) < 0;
+               });
+    // fill left page up, the rest must fit in right page
+    int size = static_cast<int>(merged.size());
+    int point = 1;
+    while (point + 1 < size &&
+           leaf->GetEncodedSize(&merged[0], point + 1,
+                                comparator_.ShortestSeparator(
+                                    merged[point].first,
+                                    merged[point + 1].first)) <=
+               leaf->GetMaxSize()) {
+      point++;
+    }
+    int right_size =
+        has_high_key ? leaf->GetEncodedSize(&merged[point], size - point,
+                                            leaf->GetHighKey())
+                     : leaf->GetEncodedSize(&merged[point], size - point);
+    if (right_size <= leaf->GetMaxSize()) {
+      points.push_back(point);
+      break;
+    }
+    end--;
+  }
+
+  int inserted = 0;
+  if (points.empty()) {
+    // even one more pair needs an evenly split leaf
+    merged.clear();
+    merged = old_items;
+    merged.insert(merged.begin() + leaf->KeyIndex(items[next].first,
+                                                  comparator_),
+                  items[next]);
+    Split(leaf, merged);
+    next++;
+    inserted = 1;
+  } else {
+    Split(leaf, merged, points);
+    inserted = static_cast<int>(end - next);
+    next = end;
+  }
+  UnLockUnPinPages(transaction, INSERT, true);
+  return inserted;
+}
+
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -145,40 +451,35 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * Value of an existing non-unique key goes to its posting list instead.
+ * @return: for unique key, if user try to insert duplicate keys return false,
+ * otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
                                     Transaction *transaction) {
-  auto *leaf = FindLeafPage(key, root_page_id_, transaction, INSERT);
+  auto *leaf = FindLeafPageForWrite(key, transaction, INSERT);
   if (leaf == nullptr) {
     return false;
   }                         
   ValueType v;
   if (leaf->Lookup(key, v, comparator_)) {
+    bool inserted = !unique_key_ && InsertIntoPostingList(leaf, key, v, value);
     if (transaction) {
       UnLockUnPinPages(transaction, INSERT, true);
     } else {
         buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
     }
-    return false; // return false if duplicate
+    return inserted; // return false if duplicate
   }
 
-  auto originalSize = leaf->GetSize();
-  auto newSize = leaf->Insert(key, value, comparator_);
-
-  if (newSize > leaf->GetMaxSize()) {
+  if (!leaf->Insert(key, value, comparator_)) {
     LOG_INFO("insert into leaf causing split");
-    B_PLUS_TREE_LEAF_PAGE_TYPE *newSiblingLeaf = Split(leaf);
-
-    LOG_INFO("After split, old leaf is %s, page id is: %s", leaf->ToString(false).c_str(), std::to_string(leaf->GetPageId()).c_str());
-    LOG_INFO("After split, splited leaf is %s, page id is: %s", newSiblingLeaf->ToString(false).c_str(), std::to_string(newSiblingLeaf->GetPageId()).c_str());
-
-    KeyType keyInParent = newSiblingLeaf->GetItem(0).first;
-    InsertIntoParent(leaf, keyInParent, newSiblingLeaf, nullptr);
-
-    buffer_pool_manager_->UnpinPage(newSiblingLeaf->GetPageId(), true);
+    std::vector<MappingType> items;
+    leaf->GetItems(items);
+    items.insert(items.begin() + leaf->KeyIndex(key, comparator_),
+                 MappingType(key, value));
+    Split(leaf, items);
   }
 
   if (transaction) {
@@ -186,38 +487,85 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
   } else {
       buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
   }
-
-  // checks
-  if (originalSize == newSize) {
-    LOG_INFO("InsertIntoLeaf original size equals to new size, insert failed");
-  }
   return true;
 }
 
 /*
- * Split input page and return newly created page.
+ * Split input page into newly created pages, items are every pair of input
+ * page plus the one it has no room for.
  * Using template N to represent either internal page or leaf page.
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
- * an "out of memory" exception if returned value is nullptr), then move half
- * of key & value pairs from input page to newly created page
+ * an "out of memory" exception if returned value is nullptr), input page keeps
+ * the first run of items and the rest goes to new pages(see SplitPoints()),
+ * which are inserted into parent one by one. Leaf page pushes up a separator
+ * as short as comparator can make it(suffix truncation), internal page pushes
+ * up the first key of new page.
+ * Every page is linked to the next one with the key pushed up as high key,
+ * the last one takes over the high key and next page of input page, so a
+ * reader that has not seen the new pages in parent yet moves right to them.
  */
 INDEX_TEMPLATE_ARGUMENTS
-template <typename N> N *BPLUSTREE_TYPE::Split(N *node) { 
-  page_id_t id = -1;  
-  auto *page = buffer_pool_manager_->NewPage(id);
+template <typename N, typename T>
+void BPLUSTREE_TYPE::Split(N *node, const std::vector<T> &items) {
+  std::vector<int> points;
+  node->SplitPoints(items, points);
+  Split(node, items, points);
+}
 
-  //std::cout << "after new page: "  << ToString(false) << std::endl << std::endl;
-  if (page == nullptr) {
-    LOG_INFO("Split failed due to buffer pool manager out of memory!");
-    throw std::bad_alloc();
+/*
+ * Split input page at the given start index of every new page, each run of
+ * items must fit in a page with its high key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N, typename T>
+void BPLUSTREE_TYPE::Split(N *node, const std::vector<T> &items,
+                           std::vector<int> points) {
+  points.push_back(static_cast<int>(items.size()));
+
+  std::vector<KeyType> separators;
+  for (size_t i = 0; i + 1 < points.size(); i++) {
+    KeyType separator = items[points[i]].first;
+    if (node->IsLeafPage()) {
+      separator =
+          comparator_.ShortestSeparator(items[points[i] - 1].first, separator);
+    }
+    separators.push_back(separator);
   }
+  separators.push_back(node->GetHighKey());
+  node->PopulateFrom(&items[0], points[0], separators[0],
+                     buffer_pool_manager_);
+
+  N *prev = node;
+  for (size_t i = 1; i < points.size(); i++) {
+    page_id_t id = -1;
+    auto *page = buffer_pool_manager_->NewPage(id);
+    if (page == nullptr) {
+      LOG_INFO("Split failed due to buffer pool manager out of memory!");
+      throw std::bad_alloc();
+    }
 
-  auto *BTreePage =
-        reinterpret_cast<N *>(page->GetData());
-  // Init method after creating a new leaf page
-  BTreePage->Init(id, node->GetParentPageId());
-  node->MoveHalfTo(BTreePage, buffer_pool_manager_); 
-  return BTreePage;
+    auto *BTreePage = reinterpret_cast<N *>(page->GetData());
+    // Init method after creating a new page
+    BTreePage->Init(id, prev->GetParentPageId());
+    int begin = points[i - 1];
+    BTreePage->PopulateFrom(&items[begin], points[i] - begin, separators[i],
+                            buffer_pool_manager_);
+    BTreePage->SetNextPageId(prev->GetNextPageId());
+    prev->SetNextPageId(id);
+    if (node->IsLeafPage()) {
+      reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(BTreePage)
+          ->SetPrevPageId(prev->GetPageId());
+    }
+    InsertIntoParent(prev, separators[i - 1], BTreePage, nullptr);
+
+    if (prev != node) {
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+    }
+    prev = BTreePage;
+  }
+  if (prev != node) {
+    buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+  }
 }
 
 /*
@@ -237,6 +585,8 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
   // find parent
   // When the insertion cause overflow from leaf page all the way upto the root
   // page, you should create a new root page and populate its elements.
+  // copy of upper levels gets out of date(see GetUpperLevels())
+  split_count_++;
   page_id_t parentPageId = old_node->GetParentPageId();
   if (parentPageId == INVALID_PAGE_ID) {
     Page *newPage = buffer_pool_manager_->NewPage(parentPageId);
@@ -264,19 +614,204 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
           reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(pPage->GetData());
 
     // call InsertNodeAfter() for new node
-    int parentCurSize = parentNode->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());  
+    if (!parentNode->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId())) {
+      // no room, we need to split, Split() calls InsertIntoParent() again
+      std::vector<std::pair<KeyType, page_id_t>> items;
+      parentNode->GetItems(items);
+      items.insert(items.begin() + parentNode->ValueIndex(old_node->GetPageId()) + 1,
+                   std::make_pair(key, new_node->GetPageId()));
+      Split(parentNode, items);
+    }
+    buffer_pool_manager_->UnpinPage(parentPageId, true);
+  }
+}
 
-    // if size overflow
-    if (parentCurSize > parentNode->GetMaxSize()) {
-      // we need to split, then insertIntoParent()
-      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *newSiblingParentNode = Split(parentNode);
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build an empty tree bottom-up from key & value pairs sorted by key
+ * Leaves are packed left to right up to fill_factor of their capacity, then
+ * every internal level is built on top of the level below until only the root
+ * is left. Nothing is descended or split, and the header page is written once.
+ * @return: false if tree is not empty, or input keys are not strictly
+ * increasing (unsorted or duplicate)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const std::vector<MappingType> &items,
+                              double fill_factor) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!IsEmpty()) {
+    return false;
+  }
+  for (size_t i = 1; i < items.size(); i++) {
+    if (comparator_(items[i - 1].first, items[i].first) >= 0) {
+      LOG_INFO("BulkLoad failed, input keys must be sorted and unique");
+      return false;
+    }
+  }
+  if (items.empty()) {
+    return true;
+  }
+  // pages below half full would be merged away by the very first remove
+  fill_factor = std::min(1.0, std::max(0.5, fill_factor));
+
+  // (first key, page id) of every page on the level built last
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  BuildLeafLevel(items, fill_factor, level);
+  while (level.size() > 1) {
+    BuildInternalLevel(level, fill_factor);
+  }
+
+  root_page_id_ = level[0].second;
+  UpdateRootPageId(true);
+  split_count_++;
+  return true;
+}
+
+/*
+ * End index of every page when sorted items are packed into pages left to
+ * right, each up to fill_factor of its capacity in bytes together with its
+ * high key(first key of the next page). The last two pages are evened out
+ * when the last one would be less than half full
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N, typename T>
+void BPLUSTREE_TYPE::BulkLoadSplitPoints(N *page, const std::vector<T> &items,
+                                         double fill_factor,
+                                         std::vector<int> &ends) const {
+  int total = static_cast<int>(items.size());
+  int limit = static_cast<int>(page->GetMaxSize() * fill_factor);
+  int begin = 0;
+  while (begin < total) {
+    int end = begin + 1;
+    while (end < total) {
+      int size = end + 1 < total
+                     ? page->GetEncodedSize(&items[begin], end + 1 - begin,
+                                            items[end + 1].first)
+                     : page->GetEncodedSize(&items[begin], end + 1 - begin);
+      if (size > limit) {
+        break;
+      }
+      end++;
+    }
+    ends.push_back(end);
+    begin = end;
+  }
+
+  size_t count = ends.size();
+  if (count > 1 && page->GetEncodedSize(&items[ends[count - 2]],
+                                        total - ends[count - 2]) <
+                       page->GetMinSize()) {
+    int start = count > 2 ? ends[count - 3] : 0;
+    std::vector<T> tail(items.begin() + start, items.end());
+    std::vector<int> points;
+    page->SplitPoints(tail, points);
+    if (points.size() == 1) {
+      ends[count - 2] = start + points[0];
+    }
+  }
+}
+
+/*
+ * Pack sorted items into a chain of new leaf pages. Parent page ids are set
+ * when the level above is built, every leaf but the first is keyed by a
+ * separator as short as comparator can make it, which is also the high key of
+ * the leaf before
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BuildLeafLevel(
+    const std::vector<MappingType> &items, double fill_factor,
+    std::vector<std::pair<KeyType, page_id_t>> &level) {
+  std::vector<int> ends;
+  int offset = 0;
+  int count = 1;
+  B_PLUS_TREE_LEAF_PAGE_TYPE *prev = nullptr;
+  for (int i = 0; i < count; i++) {
+    page_id_t id;
+    auto *page = buffer_pool_manager_->NewPage(id);
+    if (page == nullptr) {
+      LOG_INFO("BulkLoad failed due to buffer pool manager out of memory!");
+      throw std::bad_alloc();
+    }
+    auto *leaf =
+        reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+    leaf->Init(id, INVALID_PAGE_ID);
+    if (i == 0) {
+      BulkLoadSplitPoints(leaf, items, fill_factor, ends);
+      count = static_cast<int>(ends.size());
+    }
 
-      // we need to push up the first pair from new splitted node
-      auto pair = newSiblingParentNode->PushUpIndex();      
+    if (i + 1 < count) {
+      leaf->PopulateFrom(&items[offset], ends[i] - offset,
+                         comparator_.ShortestSeparator(
+                             items[ends[i] - 1].first, items[ends[i]].first));
+    } else {
+      leaf->PopulateFrom(&items[offset], ends[i] - offset);
+    }
+    KeyType key = items[offset].first;
+    if (offset > 0) {
+      key = comparator_.ShortestSeparator(items[offset - 1].first, key);
+    }
+    level.emplace_back(key, id);
+    offset = ends[i];
 
-      InsertIntoParent(parentNode, pair.first, newSiblingParentNode, nullptr);
+    if (prev != nullptr) {
+      prev->SetNextPageId(id);
+      leaf->SetPrevPageId(prev->GetPageId());
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
     }
+    prev = leaf;
   }
+  buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+}
+
+/*
+ * Build a chain of internal pages on top of level, and replace level with
+ * them. Key of every page but the first is the high key of the page before
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BuildInternalLevel(
+    std::vector<std::pair<KeyType, page_id_t>> &level, double fill_factor) {
+  std::vector<std::pair<KeyType, page_id_t>> parents;
+  std::vector<int> ends;
+  int offset = 0;
+  int count = 1;
+  BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *prev = nullptr;
+  for (int i = 0; i < count; i++) {
+    page_id_t id;
+    auto *page = buffer_pool_manager_->NewPage(id);
+    if (page == nullptr) {
+      LOG_INFO("BulkLoad failed due to buffer pool manager out of memory!");
+      throw std::bad_alloc();
+    }
+    auto *internal = reinterpret_cast<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(
+        page->GetData());
+    internal->Init(id, INVALID_PAGE_ID);
+    if (i == 0) {
+      BulkLoadSplitPoints(internal, level, fill_factor, ends);
+      count = static_cast<int>(ends.size());
+    }
+
+    if (i + 1 < count) {
+      internal->PopulateFrom(&level[offset], ends[i] - offset,
+                             level[ends[i]].first, buffer_pool_manager_);
+    } else {
+      internal->PopulateFrom(&level[offset], ends[i] - offset,
+                             buffer_pool_manager_);
+    }
+    parents.emplace_back(level[offset].first, id);
+    offset = ends[i];
+
+    if (prev != nullptr) {
+      prev->SetNextPageId(id);
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+    }
+    prev = internal;
+  }
+  buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+  swap(level, parents);
 }
 
 /*****************************************************************************
@@ -295,18 +830,78 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
     return;
   }
 
-  auto *leaf = FindLeafPage(key, root_page_id_, transaction, DELETE);
+  auto *leaf = FindLeafPageForWrite(key, transaction, DELETE);
+  if (leaf == nullptr) {
+    return;
+  }
+
+  ValueType v;
+  if (!unique_key_ && leaf->Lookup(key, v, comparator_) &&
+      BPlusTreePostingPage::IsReference(v)) {
+    DeletePostingList(v.GetPageId());
+  }
+  RemoveFromLeaf(leaf, key, transaction);
+}
+
+/*
+ * Delete one value of input key
+ * A non-unique key only loses the value from its posting list, the key itself
+ * is deleted(see RemoveFromLeaf()) together with its last value. Nothing
+ * happens if the key is not stored with input value.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value,
+                            Transaction *transaction) {
+  if (IsEmpty()) {
+    return;
+  }
+
+  auto *leaf = FindLeafPageForWrite(key, transaction, DELETE);
   if (leaf == nullptr) {
     return;
   }
 
-  auto shouldRemovePage = false;
-  int totalSize = leaf->RemoveAndDeleteRecord(key, comparator_);     
-  if (totalSize < (leaf->GetMinSize()) && totalSize > 0) {
+  ValueType v;
+  bool found = leaf->Lookup(key, v, comparator_);
+  if (found && !unique_key_ && BPlusTreePostingPage::IsReference(v)) {
+    // key keeps at least one value, leaf is not restructured
+    if (RemoveFromPostingList(v, value)) {
+      leaf->Update(key, v, comparator_);
+    }
+    found = false;
+  } else if (found && !(v == value)) {
+    found = false;
+  }
+
+  if (found) {
+    RemoveFromLeaf(leaf, key, transaction);
+  } else if (transaction) {
+    UnLockUnPinPages(transaction, DELETE, true);
+  } else {
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+  }
+}
+
+/*
+ * Delete key from leaf page found by FindLeafPage(), merge or redistribute if
+ * necessary, then release every page held by the deletion
+ * With lazy merge an underfull leaf(other than root) is only recorded, and
+ * left for Rebalance()
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveFromLeaf(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf,
+                                    const KeyType &key,
+                                    Transaction *transaction) {
+  leaf->RemoveAndDeleteRecord(key, comparator_);
+  bool shouldRemovePage = false;
+  if (lazy_merge_ && leaf->GetParentPageId() != INVALID_PAGE_ID) {
+    if (leaf->IsUnderflow()) {
+      std::lock_guard<std::mutex> lock(rebalance_latch_);
+      underflow_leaves_.emplace(leaf->GetPageId(), key);
+    }
+  } else {
+    // an emptied root leaf empties the tree, see AdjustRoot()
     shouldRemovePage = CoalesceOrRedistribute(leaf, transaction);
-  } else if (totalSize == 0) {
-    // we are empty
-    root_page_id_ = INVALID_PAGE_ID;
   }
 
   if (transaction) {
@@ -323,8 +918,73 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
 }
 
 /*
- * User needs to first find the sibling of input page. If sibling's size + input
- * page's size > page's max size, then redistribute. Otherwise, merge.
+ * Merge or redistribute every leaf recorded underfull by a lazy delete. Each
+ * one is found again by the key deleted from it, latched like for an eager
+ * delete, and skipped if it no longer is underfull. Pages merged away are
+ * deleted from buffer pool once released.
+ * @return : number of leaves still underfull when found again
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::Rebalance() {
+  std::map<page_id_t, KeyType> leaves;
+  {
+    std::lock_guard<std::mutex> lock(rebalance_latch_);
+    leaves.swap(underflow_leaves_);
+  }
+
+  int rebalanced = 0;
+  for (auto &entry : leaves) {
+    Transaction transaction(0);
+    auto *leaf =
+        FindLeafPage(entry.second, root_page_id_, &transaction, DELETE);
+    if (leaf != nullptr && leaf->IsUnderflow()) {
+      CoalesceOrRedistribute(leaf, &transaction);
+      rebalanced++;
+    }
+    UnLockUnPinPages(&transaction, DELETE, true);
+  }
+  return rebalanced;
+}
+
+/*
+ * Start a separate thread to call Rebalance() every interval, until
+ * StopRebalanceThread() is called
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RunRebalanceThread(std::chrono::milliseconds interval) {
+  StopRebalanceThread();
+  rebalance_stop_ = false;
+  rebalance_thread_ = std::thread([this, interval]() {
+    std::unique_lock<std::mutex> lock(rebalance_latch_);
+    while (!rebalance_stop_) {
+      rebalance_cv_.wait_for(lock, interval);
+      lock.unlock();
+      Rebalance();
+      lock.lock();
+    }
+  });
+}
+
+/*
+ * Stop and join the rebalance thread, leaves it has not merged yet stay
+ * recorded
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StopRebalanceThread() {
+  if (!rebalance_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(rebalance_latch_);
+    rebalance_stop_ = true;
+  }
+  rebalance_cv_.notify_all();
+  rebalance_thread_.join();
+}
+
+/*
+ * User needs to first find the sibling of input page. If both pages fit into
+ * one, then merge. Otherwise, redistribute.
  * Using template N to represent either internal page or leaf page.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
@@ -333,93 +993,65 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
 
-  // if node size if within range [max/2, max], we are good to leave
-  if (node->GetSize() >= (node->GetMinSize())) {
+  // if node is at least half full in bytes, we are good to leave
+  if (!node->IsUnderflow()) {
     return false;
   }
 
   page_id_t parentPageId = node->GetParentPageId();
   if (parentPageId == INVALID_PAGE_ID) {
     // we need to adjust root
-    //assert(root_page_id_ == node->GetPageId());
-    return AdjustRoot(node);
+    bool shouldRemoveRoot = AdjustRoot(node);
+    if (shouldRemoveRoot && transaction) {
+      transaction->AddIntoDeletedPageSet(node->GetPageId());
+    }
+    return shouldRemoveRoot;
   }
   
-  // Our plan here is to try left or right sibling to redistribute, if neither of them failed, then we merge
   auto *rawPage = buffer_pool_manager_->FetchPage(parentPageId);
   auto pPage = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(rawPage->GetData());
-    
   int index = pPage->ValueIndex(node->GetPageId());
-
-  page_id_t v = INVALID_PAGE_ID;
-  
-  // if we can redistribute
-  bool isLeftSibling = false;
-  bool isRightSibling = false;
-
-  // Check if left sibling can redistribute
-  // TODO: internal and leaf same logic?
-  if (index - 1 >= 0) {
-    v = pPage->ValueAt(index - 1);
-    auto *siblingRawPage = buffer_pool_manager_->FetchPage(v);
-    auto *sibling = reinterpret_cast<decltype(node)>(siblingRawPage->GetData());
-    assert(sibling);
-    isLeftSibling = true;
-
-    if (sibling->GetSize() + node->GetSize() > node->GetMaxSize()) {
-      Redistribute(sibling, node, index);
-      buffer_pool_manager_->UnpinPage(v, false); 
-      return false;
-    }
-    // unpin
-    buffer_pool_manager_->UnpinPage(v, false); 
-  } 
-  
-  // Check if right sibling can redistribute
-  if (index + 1 < pPage->GetSize()) {
-    v = pPage->ValueAt(index + 1);
-    auto *siblingRawPage = buffer_pool_manager_->FetchPage(v);
-    auto *sibling = reinterpret_cast<decltype(node)>(siblingRawPage->GetData());
-    isRightSibling = true;
-
-    if (sibling->GetSize() + node->GetSize() > node->GetMaxSize()) {
-      Redistribute(sibling, node, 0); // Right sibling set 'index" to 0
-      buffer_pool_manager_->UnpinPage(v, false);
-      return false;
-    }
-    // unpin
-    buffer_pool_manager_->UnpinPage(v, false); 
-  }
-
-  //assert(isLeftSibling || isRightSibling);
-  if (!isLeftSibling && !isRightSibling) {
-    LOG_INFO("t3est");
-  }
-
-
-  // Prefer left sibling for merge
-  if (isLeftSibling) {
-    v = pPage->ValueAt(index - 1);
-  } else {
-    v = pPage->ValueAt(index + 1);
+  if (pPage->GetSize() < 2) {
+    // only child, nobody to merge with
+    buffer_pool_manager_->UnpinPage(parentPageId, false);
+    return false;
   }
 
+  // Prefer left sibling, the first child only has a right one
+  page_id_t v = pPage->ValueAt(index == 0 ? 1 : index - 1);
   auto *siblingRawPage = buffer_pool_manager_->FetchPage(v);
   auto *sibling = reinterpret_cast<decltype(node)>(siblingRawPage->GetData());
+  if (transaction) {
+    // sibling may be written by a writer holding only its latch
+    siblingRawPage->WLatch();
+  }
 
-  if (isLeftSibling) {
-    // Move us to sibling, pass in our inde in parent
-    Coalesce(sibling, node, pPage, index, transaction);
-  } else {
+  bool merged;
+  if (index == 0) {
     // Move sibling to us, pass in sibling index in parent
-    Coalesce(node, sibling, pPage, index + 1, transaction);
+    merged = Coalesce(node, sibling, pPage, 1, transaction);
+  } else {
+    // Move us to sibling, pass in our index in parent
+    merged = Coalesce(sibling, node, pPage, index, transaction);
   }
+  if (!merged) {
+    Redistribute(sibling, node, pPage, index);
+  }
+  // keys may have moved left, past readers that hold no latch(see GetValue())
+  structure_version_++;
 
-  // unpin
-  buffer_pool_manager_->UnpinPage(v, false);  
-
-  // node needs coalesce. Leaf node needs to be deleted. So we mark as true.
-  return true;
+  if (transaction) {
+    siblingRawPage->WUnlatch();
+  }
+  buffer_pool_manager_->UnpinPage(v, true);
+  buffer_pool_manager_->UnpinPage(parentPageId, true);
+  if (merged && index == 0) {
+    buffer_pool_manager_->DeletePage(v);
+  } else if (merged && transaction) {
+    // we are still latched, deleted once released(see UnLockUnPinPages())
+    transaction->AddIntoDeletedPageSet(node->GetPageId());
+  }
+  return merged && index != 0;
 }
 
 /*
@@ -428,11 +1060,12 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
- * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion
- * happend
+ * @param   neighbor_node      left page, receives every pair of "node"
+ * @param   node               right page, emptied
+ * @param   parent             parent page of both pages
+ * @param   index              index of "node" in parent
+ * @return  true means "node" is merged into neighbor_node, false means both
+ * pages do not fit into one and nothing happens
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
@@ -442,59 +1075,41 @@ bool BPLUSTREE_TYPE::Coalesce(
     int index, Transaction *transaction) {
   // Move all the key & value pairs from one page to its sibling page
   // We do this way due to we got the node index in parent side easily, so we could remove it
-
-  if (!node->IsLeafPage()) {
-    KeyType dummy;
-    auto *lf = FindLeafPage(dummy, node->GetPageId(), nullptr, SEARCH, true);
-    KeyType missingKey = lf->GetItem(0).first;
-    auto interNode = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
-    interNode->SetKeyAt(0, missingKey);
-    buffer_pool_manager_->UnpinPage(lf->GetPageId(), false);
-  }  
-
-  node->MoveAllTo(neighbor_node, index, buffer_pool_manager_);
-
-  bool result = buffer_pool_manager_->DeletePage(node->GetPageId());
-  if (!result) {
-    //LOG_INFO("BPLUSTREE_TYPE::Coalesce: Failed to delete page from buffer pool manager");
+  if (!node->MoveAllTo(neighbor_node, index, buffer_pool_manager_)) {
+    return false;
   }
-  // Remove node from its parent
+  // readers still pinning node start over(see FindLeafPageByLinks())
+  node->SetPageType(IndexPageType::INVALID_INDEX_PAGE);
+
+  // Remove node from its parent, parent adjusts itself if it gets too small
   parent->Remove(index);
-  
-  auto shouldDelParent = false;
-  if (parent->GetSize() < parent->GetMinSize()) {
-    // parent needs to adjust
-    shouldDelParent = CoalesceOrRedistribute(parent, transaction);
-  }
-  return shouldDelParent;
+  CoalesceOrRedistribute(parent, transaction);
+  return true;
 }
 
 /*
- * Redistribute key & value pairs from one page to its sibling page. If index ==
- * 0, move sibling page's first key & value pair into end of input "node",
- * otherwise move sibling page's last key & value pair into head of input
- * "node".
+ * Redistribute key & value pairs between input page and its sibling page so
+ * that both are about as full in bytes. If index == 0, sibling page is at the
+ * right hand of input "node", otherwise sibling page is at the left hand and
+ * index is the index of "node" in parent.
+ * Nothing happens if parent page has no room for the new separator key, the
+ * input page then just stays less than half full.
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+void BPLUSTREE_TYPE::Redistribute(
+    N *neighbor_node, N *node,
+    BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+    int index) {
   if (index == 0) {
-    
-    if (!neighbor_node->IsLeafPage()) {
-      KeyType dummy;
-      auto *lf = FindLeafPage(dummy, neighbor_node->GetPageId(), nullptr, SEARCH, true);
-      KeyType missingKey = lf->GetItem(0).first;
-      auto interNode = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(neighbor_node);
-      interNode->SetKeyAt(0, missingKey);
-      buffer_pool_manager_->UnpinPage(lf->GetPageId(), false);
-    } 
-
-    neighbor_node->MoveFirstToEndOf(node, buffer_pool_manager_);
+    node->RedistributeWith(neighbor_node, parent, 1, comparator_,
+                           buffer_pool_manager_);
   } else {
-    neighbor_node->MoveLastToFrontOf(node, index, buffer_pool_manager_);
+    neighbor_node->RedistributeWith(node, parent, index, comparator_,
+                                    buffer_pool_manager_);
   }
 }
 
@@ -516,6 +1131,9 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
       // when you delete the last element in whole b+ tree
       root_page_id_ = INVALID_PAGE_ID;
       UpdateRootPageId(false);
+      old_root_node->SetPageType(IndexPageType::INVALID_INDEX_PAGE);
+      // pages only go away after this, see FetchFromUpperLevels()
+      structure_version_++;
       return true;
     }
   }
@@ -536,6 +1154,8 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
 
     root_page_id_ = childPageId;
     UpdateRootPageId(false);
+    old_root_node->SetPageType(IndexPageType::INVALID_INDEX_PAGE);
+    structure_version_++;
 
     buffer_pool_manager_->UnpinPage(childPageId, true); 
     return true; // root needs to be deleted
@@ -544,30 +1164,324 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
   return false;
 }
 
+/*****************************************************************************
+ * POSTING LIST
+ *****************************************************************************/
+/*
+ * Add value to an existing non-unique key whose current leaf value is entry
+ * An inline value moves into a new posting page together with input value,
+ * otherwise value is appended to the head page of the chain, or to a new head
+ * page when it is full. Leaf value is updated whenever the head changes.
+ * NOTE: caller holds write latch of leaf page, which also guards the chain
+ * @return: false if key already maps to value, inline or in the chain
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertIntoPostingList(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf,
+                                           const KeyType &key,
+                                           const ValueType &entry,
+                                           const ValueType &value) {
+  bool is_reference = BPlusTreePostingPage::IsReference(entry);
+  if (!is_reference && entry == value) {
+    return false;
+  }
+
+  if (is_reference) {
+    page_id_t id = entry.GetPageId();
+    while (id != INVALID_PAGE_ID) {
+      auto *rawPage = buffer_pool_manager_->FetchPage(id);
+      auto *posting =
+          reinterpret_cast<BPlusTreePostingPage *>(rawPage->GetData());
+      bool found = posting->RidIndex(value) != -1;
+      page_id_t next_id = posting->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(id, false);
+      if (found) {
+        return false;
+      }
+      id = next_id;
+    }
+
+    auto *rawPage = buffer_pool_manager_->FetchPage(entry.GetPageId());
+    auto *head = reinterpret_cast<BPlusTreePostingPage *>(rawPage->GetData());
+    bool appended = head->Append(value);
+    buffer_pool_manager_->UnpinPage(entry.GetPageId(), appended);
+    if (appended) {
+      return true;
+    }
+  }
+
+  page_id_t id;
+  auto *page = buffer_pool_manager_->NewPage(id);
+  if (page == nullptr) {
+    LOG_INFO("InsertIntoPostingList failed due to buffer pool manager out of memory!");
+    throw std::bad_alloc();
+  }
+  auto *head = reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+  if (is_reference) {
+    // push a new head in front of the full one
+    head->Init(id, entry.GetPageId());
+  } else {
+    head->Init(id);
+    head->Append(entry);
+  }
+  head->Append(value);
+  buffer_pool_manager_->UnpinPage(id, true);
+
+  leaf->Update(key, BPlusTreePostingPage::MakeReference(id), comparator_);
+  return true;
+}
+
+/*
+ * Remove value from the posting list entry refers to, the hole is filled
+ * with the last value of head page so only head stays partially filled. An
+ * emptied head is deleted, and a list left with a single value is folded
+ * back inline.
+ * @param   entry      in: leaf value of the key, out: its new leaf value
+ * @return: false if value is not in the list
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveFromPostingList(ValueType &entry,
+                                           const ValueType &value) {
+  page_id_t head_id = entry.GetPageId();
+  page_id_t id = head_id;
+  BPlusTreePostingPage *posting = nullptr;
+  int index = -1;
+  while (id != INVALID_PAGE_ID) {
+    auto *rawPage = buffer_pool_manager_->FetchPage(id);
+    posting = reinterpret_cast<BPlusTreePostingPage *>(rawPage->GetData());
+    index = posting->RidIndex(value);
+    if (index != -1) {
+      break;
+    }
+    page_id_t next_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(id, false);
+    id = next_id;
+  }
+  if (id == INVALID_PAGE_ID) {
+    return false;
+  }
+
+  auto *head = posting;
+  if (id != head_id) {
+    auto *rawPage = buffer_pool_manager_->FetchPage(head_id);
+    head = reinterpret_cast<BPlusTreePostingPage *>(rawPage->GetData());
+  }
+  ValueType last = head->RemoveLast();
+  if (!(last == value)) {
+    posting->SetRidAt(index, last);
+  }
+  if (id != head_id) {
+    buffer_pool_manager_->UnpinPage(id, true);
+  }
+
+  page_id_t next_id = head->GetNextPageId();
+  bool delete_head = true;
+  if (next_id == INVALID_PAGE_ID && head->GetSize() == 1) {
+    entry = head->RidAt(0);
+  } else if (head->GetSize() == 0) {
+    entry = BPlusTreePostingPage::MakeReference(next_id);
+  } else {
+    delete_head = false;
+  }
+  buffer_pool_manager_->UnpinPage(head_id, true);
+  if (delete_head) {
+    buffer_pool_manager_->DeletePage(head_id);
+  }
+  return true;
+}
+
+/*
+ * Collect every value stored in the chain starting from page_id
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetPostingList(page_id_t page_id,
+                                    std::vector<ValueType> &result) {
+  while (page_id != INVALID_PAGE_ID) {
+    auto *rawPage = buffer_pool_manager_->FetchPage(page_id);
+    auto *posting = reinterpret_cast<BPlusTreePostingPage *>(rawPage->GetData());
+    for (int i = 0; i < posting->GetSize(); i++) {
+      result.push_back(posting->RidAt(i));
+    }
+    page_id_t next_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_id;
+  }
+}
+
+/*
+ * Delete every page of the chain starting from page_id
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePostingList(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    auto *rawPage = buffer_pool_manager_->FetchPage(page_id);
+    auto *posting = reinterpret_cast<BPlusTreePostingPage *>(rawPage->GetData());
+    page_id_t next_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_id;
+  }
+}
+
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
 /*
- * Input parameter is void, find the leaftmost leaf page first, then construct
- * index iterator
+ * Input parameter is void, iterator starts from the first key of the leftmost
+ * leaf page
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
-  KeyType dummyKey;
-  auto *lp = FindLeafPage(dummyKey, root_page_id_, nullptr, SEARCH, true);
-  return INDEXITERATOR_TYPE(lp, 0, buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(this, nullptr, true);
 }
 
 /*
- * Input parameter is low key, find the leaf page that contains the input key
- * first, then construct index iterator
+ * Input parameter is low key, iterator starts from the first key no smaller
+ * than it
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  auto *lp = FindLeafPage(key, root_page_id_, nullptr, SEARCH, false);
-  return INDEXITERATOR_TYPE(lp, lp->KeyIndex(key, comparator_), buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(this, &key, true);
+}
+
+/*
+ * Input parameters are low key and high key, iterator starts from the first
+ * key no smaller than low key and ends after the last key no larger than high
+ * key, without reading the leaf page behind it
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key,
+                                         const KeyType &end_key) {
+  return INDEXITERATOR_TYPE(this, &key, true, &end_key);
+}
+
+/*
+ * Reverse iterators, moved with operator--(), start from the last key of the
+ * tree or the last key no larger than input key
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin() {
+  return INDEXITERATOR_TYPE(this, nullptr, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  return INDEXITERATOR_TYPE(this, &key, false);
+}
+
+/*
+ * Partitioned iterators, each one scans a disjoint sub-range and they cover
+ * the whole tree(or low key to high key) together, so a range scan can use
+ * one thread per iterator. Sub-ranges are bounded by separator keys of the
+ * highest internal level that has enough of them, fewer than count iterators
+ * are returned if tree is too small to have count - 1 separators.
+ * @return : index iterators, in key order
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<INDEXITERATOR_TYPE> BPLUSTREE_TYPE::BeginPartitions(int count) {
+  return Partition(nullptr, nullptr, count);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<INDEXITERATOR_TYPE>
+BPLUSTREE_TYPE::BeginPartitions(const KeyType &key, const KeyType &end_key,
+                                int count) {
+  return Partition(&key, &end_key, count);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<INDEXITERATOR_TYPE>
+BPLUSTREE_TYPE::Partition(const KeyType *key, const KeyType *end_key,
+                          int count) {
+  std::vector<KeyType> separators;
+  GetSeparators(key, end_key, count, separators);
+  // pick separators evenly spread over the ones found
+  int parts = std::min(count, static_cast<int>(separators.size()) + 1);
+  std::vector<KeyType> bounds;
+  for (int i = 1; i < parts; i++) {
+    bounds.push_back(separators[i * separators.size() / parts]);
+  }
+
+  std::vector<INDEXITERATOR_TYPE> iterators;
+  const KeyType *begin = key;
+  for (auto &bound : bounds) {
+    iterators.push_back(INDEXITERATOR_TYPE(this, begin, true, &bound, false));
+    begin = &bound;
+  }
+  iterators.push_back(INDEXITERATOR_TYPE(this, begin, true, end_key));
+  return iterators;
+}
+
+/*
+ * Collect separator keys strictly inside the range, from the highest internal
+ * level with at least count - 1 of them(or the lowest internal level).
+ * A level is walked through next page ids with one read latch at a time, like
+ * FindLeafPageByLinks(). Separators only balance partitions, a page merged
+ * away under us just ends the walk of its level early.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetSeparators(const KeyType *key, const KeyType *end_key,
+                                   int count,
+                                   std::vector<KeyType> &separators) {
+  lockRoot();
+  if (IsEmpty()) {
+    unlockRoot();
+    return;
+  }
+  page_id_t page_id = root_page_id_;
+  unlockRoot();
+
+  while (static_cast<int>(separators.size()) < count - 1 &&
+         page_id != INVALID_PAGE_ID) {
+    std::vector<KeyType> level;
+    page_id_t child_id = INVALID_PAGE_ID;
+    Page *rawPage = buffer_pool_manager_->FetchPage(page_id);
+    rawPage->RLatch();
+    while (rawPage != nullptr) {
+      auto *page = reinterpret_cast<BPlusTreePage *>(rawPage->GetData());
+      Page *next = nullptr;
+      if (!page->IsLeafPage() && !page->IsMergedAway()) {
+        auto *internal = reinterpret_cast<
+            BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page);
+        if (child_id == INVALID_PAGE_ID) {
+          child_id = key == nullptr ? internal->ValueAt(0)
+                                    : internal->Lookup(*key, comparator_);
+        }
+        // high key is the separator between this page and the next one
+        int size = internal->GetSize();
+        bool has_next = internal->GetNextPageId() != INVALID_PAGE_ID;
+        bool past_end = false;
+        for (int i = 1; i <= size && !past_end; i++) {
+          if (i == size && !has_next) {
+            break;
+          }
+          KeyType separator =
+              i < size ? internal->KeyAt(i) : internal->GetHighKey();
+          if (end_key != nullptr && comparator_(separator, *end_key) >= 0) {
+            past_end = true;
+          } else if (key == nullptr || comparator_(separator, *key) > 0) {
+            level.push_back(separator);
+          }
+        }
+        if (has_next && !past_end) {
+          next = buffer_pool_manager_->FetchPage(internal->GetNextPageId());
+        }
+      }
+      rawPage->RUnlatch();
+      buffer_pool_manager_->UnpinPage(rawPage->GetPageId(), false);
+      if (next != nullptr) {
+        next->RLatch();
+      }
+      rawPage = next;
+    }
+    if (level.size() > separators.size()) {
+      separators.swap(level);
+    }
+    page_id = child_id;
+  }
 }
 
 /*****************************************************************************
@@ -575,17 +1489,26 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
- * the left most leaf page
+ * the left most leaf page.
+ * If optimistic flag == true, a writer(INSERT/DELETE with transaction) read
+ * latches internal pages like a search and write latches only the leaf page,
+ * so writers do not queue up on root. Return nullptr if root page is a leaf,
+ * writes to it may change root page id.
  */
 INDEX_TEMPLATE_ARGUMENTS
 B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, page_id_t root_id,
-           Transaction *transaction, OpType op, bool leftMost) {
+           Transaction *transaction, OpType op, bool leftMost, bool optimistic) {
   if (op != SEARCH) {
     lockRoot();
-    root_is_locked = true;
+    root_is_locked = !optimistic;
+    // root may have changed before we got here
+    root_id = root_page_id_;
   }
 
   if (IsEmpty()) {
+    if (optimistic) {
+      unlockRoot();
+    }
     return nullptr;
   }
 
@@ -593,15 +1516,25 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, pag
   auto *rawPage = buffer_pool_manager_->FetchPage(page_id);
   BPlusTreePage *page =
         reinterpret_cast<BPlusTreePage *>(rawPage->GetData());
+
+  if (optimistic && page->IsLeafPage()) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    unlockRoot();
+    return nullptr;
+  }
   
   if (transaction != nullptr) {
-    if (op == SEARCH) {
+    if (op == SEARCH || optimistic) {
       rawPage->RLatch();
     } else {
       rawPage->WLatch();
     }
     transaction->AddIntoPageSet(rawPage);
   }
+  if (optimistic) {
+    // root page id can not change while root page is latched
+    unlockRoot();
+  }
 
   while (page != nullptr && !page->IsLeafPage()) {
     // cast to internal page
@@ -631,7 +1564,15 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, pag
         }
       }
       if (!found) {
-        if (op == SEARCH) {
+        if (optimistic) {
+          // parent is read latched, page can not turn from leaf to internal
+          if (page->IsLeafPage()) {
+            rawPage->WLatch();
+          } else {
+            rawPage->RLatch();
+          }
+          UnLockUnPinPages(transaction, SEARCH, false);
+        } else if (op == SEARCH) {
           //LOG_INFO("Acquire... RLatch for page id is: %s", std::to_string(rawPage->GetPageId()).c_str());
           rawPage->RLatch();
           //LOG_INFO("Acquired RLatch for page id is: %s", std::to_string(rawPage->GetPageId()).c_str());
@@ -642,7 +1583,10 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, pag
           //LOG_INFO("Acquired WLatch for page id is: %s", std::to_string(rawPage->GetPageId()).c_str());
 
           int ops = (op == INSERT) ? 1 : 2;
-          if (page->IsSafe(ops)) {
+          bool isSafe = page->IsLeafPage()
+              ? reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page)->IsSafe(ops)
+              : reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page)->IsSafe(ops);
+          if (isSafe) {
             UnLockUnPinPages(transaction, op, false);
           }
         }
@@ -659,6 +1603,333 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, pag
   return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page);
 }
 
+/*
+ * Find leaf page for an insertion or a deletion of key. Only the leaf page is
+ * write latched at first(see FindLeafPage()), which is enough unless the write
+ * may split it or leave it less than half full. Then release it and descend
+ * again from root, holding every page that may change.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPageForWrite(
+    const KeyType &key, Transaction *transaction, OpType op) {
+  if (transaction != nullptr) {
+    auto *leaf =
+        FindLeafPage(key, root_page_id_, transaction, op, false, true);
+    if (leaf != nullptr) {
+      ValueType v;
+      bool found = leaf->Lookup(key, v, comparator_);
+      // inserting an existing key or deleting a missing one leaves leaf as is,
+      // a lazy delete never merges
+      if (found == (op == INSERT) || leaf->IsSafe(op == INSERT ? 1 : 2) ||
+          (op == DELETE && lazy_merge_)) {
+        return leaf;
+      }
+      UnLockUnPinPages(transaction, op, false);
+    }
+  }
+  return FindLeafPage(key, root_page_id_, transaction, op);
+}
+
+/*
+ * Find leaf page for a reader, holding one read latch at a time instead of
+ * coupling them(B-link tree, Lehman & Yao). Next page is pinned before
+ * current one is released, a page split after we read its parent may no
+ * longer hold what we look for, which then lies beyond its high key and is
+ * reached through next page ids. Descent starts over from root when it lands
+ * on a page merged away in the meantime.
+ * SEEK_KEY finds the leaf that would hold key, SEEK_BEFORE_KEY the one that
+ * holds the largest keys smaller than key, SEEK_FIRST and SEEK_LAST ignore key
+ * and find the first and the last leaf. Keys of a subtree may all be deleted
+ * while its separator stays in parent, so the last two descend again before
+ * the lower bound of a leaf that has no key they look for.
+ * Return read latched and pinned leaf page, nullptr if tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageByLinks(const KeyType &key, SeekType seek) {
+  Page *rawPage = nullptr;
+  KeyType bound = key;
+  // lower bound of keys of page we are on, none for the first page of a level
+  bool has_low_key = false;
+  KeyType low_key;
+  while (true) {
+    if (rawPage == nullptr && seek == SEEK_KEY) {
+      rawPage = FetchFromUpperLevels(bound);
+      has_low_key = false;
+    }
+    if (rawPage == nullptr) {
+      // root page can not be deleted while root page id is locked
+      lockRoot();
+      if (IsEmpty()) {
+        unlockRoot();
+        return nullptr;
+      }
+      rawPage = buffer_pool_manager_->FetchPage(root_page_id_);
+      unlockRoot();
+      rawPage->RLatch();
+      has_low_key = false;
+    }
+
+    auto *page = reinterpret_cast<BPlusTreePage *>(rawPage->GetData());
+    page_id_t page_id;
+    if (page->IsMergedAway()) {
+      rawPage->RUnlatch();
+      buffer_pool_manager_->UnpinPage(rawPage->GetPageId(), false);
+      rawPage = nullptr;
+      continue;
+    } else if (page->IsLeafPage()) {
+      auto *leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page);
+      if (!MoveRight(leaf, bound, seek)) {
+        if ((seek != SEEK_LAST && seek != SEEK_BEFORE_KEY) || !has_low_key ||
+            (leaf->GetSize() > 0 &&
+             (seek == SEEK_LAST || comparator_(leaf->KeyAt(0), bound) < 0))) {
+          return rawPage;
+        }
+        // every low key is smaller than the one before, so this ends
+        rawPage->RUnlatch();
+        buffer_pool_manager_->UnpinPage(rawPage->GetPageId(), false);
+        rawPage = nullptr;
+        bound = low_key;
+        seek = SEEK_BEFORE_KEY;
+        continue;
+      }
+      page_id = leaf->GetNextPageId();
+      low_key = leaf->GetHighKey();
+      has_low_key = true;
+    } else {
+      auto *internal = reinterpret_cast<
+          BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page);
+      if (MoveRight(internal, bound, seek)) {
+        page_id = internal->GetNextPageId();
+        low_key = internal->GetHighKey();
+        has_low_key = true;
+      } else if (seek == SEEK_KEY) {
+        page_id = internal->Lookup(bound, comparator_);
+      } else if (seek == SEEK_FIRST) {
+        page_id = internal->ValueAt(0);
+      } else {
+        page_id = seek == SEEK_LAST
+                      ? internal->ValueAt(internal->GetSize() - 1)
+                      : internal->LookupBefore(bound, comparator_);
+        int index = internal->ValueIndex(page_id);
+        if (index > 0) {
+          low_key = internal->KeyAt(index);
+          has_low_key = true;
+        }
+      }
+    }
+
+    Page *next = buffer_pool_manager_->FetchPage(page_id);
+    rawPage->RUnlatch();
+    buffer_pool_manager_->UnpinPage(rawPage->GetPageId(), false);
+    next->RLatch();
+    rawPage = next;
+  }
+}
+
+/*
+ * Start of a point query below the upper level cache: page the copy of upper
+ * levels leads key to, usually a leaf. Keys only move right without a change
+ * of structure version, so the page or one right of it holds key, as it is
+ * for a copy taken while pages split.
+ * Return read latched and pinned page, nullptr if there is no copy to use
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchFromUpperLevels(const KeyType &key) {
+  std::shared_ptr<const UpperLevels> levels = GetUpperLevels();
+  if (levels == nullptr || levels->nodes.empty()) {
+    return nullptr;
+  }
+  page_id_t page_id = INVALID_PAGE_ID;
+  for (int node = 0; page_id == INVALID_PAGE_ID;) {
+    auto &copy = levels->nodes[node];
+    if (copy.next_page_id != INVALID_PAGE_ID &&
+        comparator_(key, copy.high_key) >= 0) {
+      // split after it was copied
+      page_id = copy.next_page_id;
+      break;
+    }
+    // binary search for the first key larger than input key
+    int lo = 1;
+    int hi = copy.keys.size();
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (comparator_(copy.keys[mid], key) <= 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    node = copy.child_nodes[lo - 1];
+    if (node < 0) {
+      page_id = copy.children[lo - 1];
+    }
+  }
+
+  Page *rawPage = buffer_pool_manager_->FetchPage(page_id);
+  rawPage->RLatch();
+  // a page is deleted only after structure version changes, the one we hold
+  // stays then
+  if (structure_version_ != levels->structure_version) {
+    rawPage->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return nullptr;
+  }
+  return rawPage;
+}
+
+/*
+ * Copy of upper levels to use, nullptr if there is none
+ * A copy lasts until a page is merged, redistributed or deleted, or as many
+ * pages split as it holds. Rebuilding it reads each of its pages again, so it
+ * waits for as many point queries going down from root, and only one thread
+ * rebuilds at a time.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::shared_ptr<const typename BPLUSTREE_TYPE::UpperLevels>
+BPLUSTREE_TYPE::GetUpperLevels() {
+  if (upper_level_pages_ <= 0) {
+    return nullptr;
+  }
+  std::shared_ptr<const UpperLevels> levels = std::atomic_load(&upper_levels_);
+  uint64_t size = 1;
+  if (levels != nullptr) {
+    size = std::max<uint64_t>(1, levels->nodes.size());
+    bool valid = levels->structure_version == structure_version_;
+    if (valid && split_count_ - levels->split_count < size) {
+      return levels;
+    } else if (!valid && upper_level_misses_++ < size) {
+      return nullptr;
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(upper_levels_latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return levels != nullptr && levels->structure_version == structure_version_
+               ? levels
+               : nullptr;
+  }
+  std::shared_ptr<const UpperLevels> rebuilt = BuildUpperLevels();
+  if (rebuilt != nullptr) {
+    std::atomic_store(&upper_levels_, rebuilt);
+    upper_level_misses_ = 0;
+    return rebuilt;
+  }
+  return nullptr;
+}
+
+/*
+ * Copy internal pages level by level from root, as long as the next level
+ * fits into upper_level_pages_ pages. Pages are latched one at a time like
+ * FindLeafPageByLinks() does.
+ * @return : nullptr if a page was merged away meanwhile
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::shared_ptr<const typename BPLUSTREE_TYPE::UpperLevels>
+BPLUSTREE_TYPE::BuildUpperLevels() {
+  std::shared_ptr<UpperLevels> levels = std::make_shared<UpperLevels>();
+  levels->structure_version = structure_version_;
+  levels->split_count = split_count_;
+
+  lockRoot();
+  if (IsEmpty()) {
+    unlockRoot();
+    return levels;
+  }
+  // pages of the level to copy, and (node, child index) each one hangs from
+  std::vector<page_id_t> level(1, root_page_id_);
+  std::vector<std::pair<int, int>> parents(1, std::make_pair(-1, 0));
+  unlockRoot();
+
+  std::vector<std::pair<KeyType, page_id_t>> items;
+  while (levels->nodes.size() + level.size() <=
+         static_cast<size_t>(upper_level_pages_)) {
+    std::vector<page_id_t> next_level;
+    std::vector<std::pair<int, int>> next_parents;
+    for (size_t i = 0; i < level.size(); i++) {
+      Page *rawPage = buffer_pool_manager_->FetchPage(level[i]);
+      rawPage->RLatch();
+      auto *page = reinterpret_cast<BPlusTreePage *>(rawPage->GetData());
+      bool merged = page->IsMergedAway();
+      bool leaf = page->IsLeafPage();
+      if (!merged && !leaf) {
+        auto *internal = reinterpret_cast<
+            BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page);
+        int node = levels->nodes.size();
+        levels->nodes.emplace_back();
+        auto &copy = levels->nodes.back();
+        internal->GetItems(items);
+        for (auto &item : items) {
+          copy.keys.push_back(item.first);
+          copy.children.push_back(item.second);
+          copy.child_nodes.push_back(-1);
+          next_level.push_back(item.second);
+          next_parents.push_back(
+              std::make_pair(node, static_cast<int>(copy.children.size()) - 1));
+        }
+        copy.next_page_id = internal->GetNextPageId();
+        if (copy.next_page_id != INVALID_PAGE_ID) {
+          copy.high_key = internal->GetHighKey();
+        }
+        if (parents[i].first >= 0) {
+          levels->nodes[parents[i].first].child_nodes[parents[i].second] =
+              node;
+        }
+      }
+      rawPage->RUnlatch();
+      buffer_pool_manager_->UnpinPage(level[i], false);
+      if (merged) {
+        return nullptr;
+      } else if (leaf) {
+        // leaves are never copied, all pages of a level are leaves or none
+        return i == 0 ? levels : nullptr;
+      }
+    }
+    level.swap(next_level);
+    parents.swap(next_parents);
+  }
+  return levels;
+}
+
+/*
+ * Whether what a seek looks for has moved to the right of page by a split,
+ * the last page of a level has no high key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+bool BPLUSTREE_TYPE::MoveRight(N *page, const KeyType &key,
+                               SeekType seek) const {
+  if (page->GetNextPageId() == INVALID_PAGE_ID || seek == SEEK_FIRST) {
+    return false;
+  } else if (seek == SEEK_LAST) {
+    return true;
+  }
+  int cmp = comparator_(key, page->GetHighKey());
+  return seek == SEEK_KEY ? cmp >= 0 : cmp > 0;
+}
+
+/*
+ * Number of levels from root page down to leaf pages, 0 if tree is empty
+ * This method is used for test only
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::GetHeight() {
+  int height = 0;
+  page_id_t page_id = root_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *rawPage = buffer_pool_manager_->FetchPage(page_id);
+    BPlusTreePage *page =
+        reinterpret_cast<BPlusTreePage *>(rawPage->GetData());
+    page_id_t child = INVALID_PAGE_ID;
+    if (!page->IsLeafPage()) {
+      child = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page)->ValueAt(0);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = child;
+    height++;
+  }
+  return height;
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -671,12 +1942,15 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   HeaderPage *header_page = static_cast<HeaderPage *>(
       buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record)
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  else
+  if (insert_record) {
+    // create a new record<index_name + root_page_id> in header_page, a tree
+    // that shrank to empty before still owns its record
+    if (!header_page->InsertRecord(index_name_, root_page_id_))
+      header_page->UpdateRecord(index_name_, root_page_id_);
+  } else {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
+  }
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
@@ -771,5 +2045,7 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTree<GenericKey<256>, RID, GenericComparator<256>>;
 
 } // namespace cmudb
@@ -2,6 +2,8 @@
  * b_plus_tree_index.cpp
  */
 
+#include <algorithm>
+
 #include "index/b_plus_tree_index.h"
 
 namespace cmudb {
@@ -12,9 +14,10 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata,
                                      BufferPoolManager *buffer_pool_manager,
                                      page_id_t root_page_id)
-    : Index(metadata), comparator_(metadata->GetKeySchema()),
+    : Index(metadata), comparator_(metadata->GetEntrySchema(),
+                                   metadata->GetIndexColumnCount()),
       container_(metadata->GetName(), buffer_pool_manager, comparator_,
-                 root_page_id) {}
+                 root_page_id, metadata->IsUnique()) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid,
@@ -27,13 +30,13 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid,
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key,
+void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid,
                                        Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Remove(index_key, transaction);
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -45,10 +48,72 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> &result,
 
   container_.GetValue(index_key, result, transaction);
 }
+
+/*
+ * Entries come from leaf keys, which carry the included columns. Values of a
+ * posting list share one leaf key, those tuples are left to the caller.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> &result,
+                                   std::vector<Tuple> &entries,
+                                   Transaction *transaction) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  KeyType stored_key;
+  bool has_stored_key = false;
+  container_.GetValue(index_key, result, stored_key, has_stored_key,
+                      transaction);
+  entries.assign(result.size(), Tuple());
+  if (has_stored_key) {
+    Schema *entry_schema = GetEntrySchema();
+    std::vector<Value> values;
+    for (int i = 0; i < entry_schema->GetColumnCount(); i++)
+      values.push_back(stored_key.ToValue(entry_schema, i));
+    entries[0] = Tuple(values, entry_schema);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkLoad(
+    const std::vector<std::pair<Tuple, RID>> &entries,
+    Transaction *transaction) {
+  std::vector<MappingType> items(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    items[i].first.SetFromKey(entries[i].first);
+    items[i].second = entries[i].second;
+  }
+  std::stable_sort(items.begin(), items.end(),
+                   [this](const MappingType &lhs, const MappingType &rhs) {
+                     return comparator_(lhs.first, rhs.first) < 0;
+                   });
+  // tree is built from the first entry of every key, the rest only exist in
+  // posting lists of a non-unique index
+  std::vector<MappingType> firsts;
+  std::vector<MappingType> duplicates;
+  for (auto &item : items) {
+    if (!firsts.empty() && comparator_(firsts.back().first, item.first) == 0) {
+      if (!GetMetadata()->IsUnique())
+        duplicates.push_back(item);
+    } else {
+      firsts.push_back(item);
+    }
+  }
+
+  if (!container_.BulkLoad(firsts)) {
+    // tree already has entries, fall back to one insert per entry
+    for (auto &item : firsts)
+      container_.Insert(item.first, item.second, transaction);
+  }
+  for (auto &item : duplicates)
+    container_.Insert(item.first, item.second, transaction);
+}
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTreeIndex<GenericKey<256>, RID, GenericComparator<256>>;
 
 } // namespace cmudb
@@ -0,0 +1,58 @@
+/**
+ * hash_index.cpp
+ */
+
+#include "index/generic_key.h"
+#include "index/hash_index.h"
+
+namespace cmudb {
+/*
+ * Constructor
+ */
+template <typename KeyType, typename ValueType>
+HASH_INDEX_TYPE::HashIndex(IndexMetadata *metadata,
+                           BufferPoolManager *buffer_pool_manager,
+                           page_id_t directory_page_id)
+    : Index(metadata),
+      container_(metadata->GetName(), buffer_pool_manager, directory_page_id,
+                 metadata->IsUnique()) {}
+
+template <typename KeyType, typename ValueType>
+void HASH_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid,
+                                  Transaction *transaction) {
+  // construct insert index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Insert(index_key, rid);
+}
+
+template <typename KeyType, typename ValueType>
+void HASH_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid,
+                                  Transaction *transaction) {
+  // construct delete index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Remove(index_key, rid);
+}
+
+template <typename KeyType, typename ValueType>
+void HASH_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> &result,
+                              Transaction *transaction) {
+  // construct scan index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.GetValue(index_key, result);
+}
+
+template class HashIndex<GenericKey<4>, RID>;
+template class HashIndex<GenericKey<8>, RID>;
+template class HashIndex<GenericKey<16>, RID>;
+template class HashIndex<GenericKey<32>, RID>;
+template class HashIndex<GenericKey<64>, RID>;
+template class HashIndex<GenericKey<128>, RID>;
+template class HashIndex<GenericKey<256>, RID>;
+
+} // namespace cmudb
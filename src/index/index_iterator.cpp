@@ -3,6 +3,7 @@
  */
 #include <cassert>
 
+#include "index/b_plus_tree.h"
 #include "index/index_iterator.h"
 
 namespace cmudb {
@@ -12,13 +13,213 @@ namespace cmudb {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf,
-              int index_, BufferPoolManager *buff_pool_manager):
-    leaf_(leaf), index_(index_), buff_pool_manager_(buff_pool_manager) {}
+INDEXITERATOR_TYPE::IndexIterator(
+    BPlusTree<KeyType, ValueType, KeyComparator> *tree, const KeyType *key,
+    bool forward, const KeyType *end_key, bool end_inclusive)
+    : tree_(tree), buff_pool_manager_(tree->buffer_pool_manager_), index_(0),
+      page_id_(INVALID_PAGE_ID), next_page_id_(INVALID_PAGE_ID),
+      prev_page_id_(INVALID_PAGE_ID), version_(0), has_key_(key != nullptr),
+      inclusive_(true), has_end_key_(end_key != nullptr),
+      end_inclusive_(end_inclusive) {
+  if (has_key_) {
+    key_ = *key;
+  }
+  if (has_end_key_) {
+    end_key_ = *end_key;
+  }
+
+  auto seek = forward ? BPlusTree<KeyType, ValueType, KeyComparator>::SEEK_FIRST
+                      : BPlusTree<KeyType, ValueType, KeyComparator>::SEEK_LAST;
+  if (has_key_) {
+    seek = BPlusTree<KeyType, ValueType, KeyComparator>::SEEK_KEY;
+  }
+  Page *page = tree_->FindLeafPageByLinks(key_, seek);
+  if (page == nullptr) {
+    return; // empty tree
+  }
+  CopyItems(page, forward);
+  Release(page);
+
+  // every key of leaf may be on the wrong side of the one we start from
+  if (forward) {
+    while (index_ >= static_cast<int>(items_.size()) &&
+           next_page_id_ != INVALID_PAGE_ID) {
+      LoadNext();
+    }
+  } else {
+    while (index_ < 0 && prev_page_id_ != INVALID_PAGE_ID) {
+      LoadPrev();
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() {}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  index_++;
+  // check if we need to switch to right sibling leaf node
+  while (index_ >= static_cast<int>(items_.size()) &&
+         next_page_id_ != INVALID_PAGE_ID) {
+    LoadNext();
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator--() {
+  index_--;
+  // check if we need to switch to left sibling leaf node
+  while (index_ < 0 && prev_page_id_ != INVALID_PAGE_ID) {
+    LoadPrev();
+  }
+  return *this;
+}
+
+/*
+ * Copy pairs of the right sibling leaf. A split only moves keys to the right,
+ * so the next page id read with our copy still leads to every key left,
+ * unless structure version tells keys may have moved left since.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::LoadNext() {
+  Page *page = nullptr;
+  if (tree_->structure_version_ == version_) {
+    page = buff_pool_manager_->FetchPage(next_page_id_);
+    page->RLatch();
+    auto *leaf = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (leaf->IsMergedAway() || tree_->structure_version_ != version_) {
+      Release(page);
+      page = nullptr;
+    }
+  }
+  if (page == nullptr) {
+    page = tree_->FindLeafPageByLinks(
+        key_, has_key_ ? BPlusTree<KeyType, ValueType, KeyComparator>::SEEK_KEY
+                       : BPlusTree<KeyType, ValueType, KeyComparator>::SEEK_FIRST);
+  }
+  if (page == nullptr) {
+    items_.clear();
+    next_page_id_ = INVALID_PAGE_ID;
+    return;
+  }
+  CopyItems(page, true);
+  Release(page);
+}
+
+/*
+ * Copy pairs of the left sibling leaf. Previous page id is only a hint(see
+ * BPlusTreeLeafPage::GetPrevPageId()): it is used when the page it points to
+ * still links to us, or reaches us by moving right past pages split off it.
+ * Otherwise descend again from root for the keys before the first one we
+ * returned.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::LoadPrev() {
+  Page *page = nullptr;
+  page_id_t page_id = prev_page_id_;
+  while (page_id != INVALID_PAGE_ID && tree_->structure_version_ == version_) {
+    Page *candidate = buff_pool_manager_->FetchPage(page_id);
+    candidate->RLatch();
+    auto *leaf =
+        reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(candidate->GetData());
+    if (leaf->IsMergedAway() || tree_->structure_version_ != version_) {
+      Release(candidate);
+      break;
+    }
+    page_id = leaf->GetNextPageId();
+    if (page_id == page_id_) {
+      page = candidate;
+      break;
+    }
+    Release(candidate);
+  }
+  if (page == nullptr) {
+    // an inclusive key_ is not in page_id_ that would hold it, so what is left
+    // lies before it either way
+    page = tree_->FindLeafPageByLinks(
+        key_,
+        has_key_ ? BPlusTree<KeyType, ValueType, KeyComparator>::SEEK_BEFORE_KEY
+                 : BPlusTree<KeyType, ValueType, KeyComparator>::SEEK_LAST);
+  }
+  if (page == nullptr) {
+    items_.clear();
+    index_ = -1;
+    prev_page_id_ = INVALID_PAGE_ID;
+    return;
+  }
+  CopyItems(page, false);
+  Release(page);
+}
+
+/*
+ * Copy pairs of read latched leaf page that lie ahead in scan direction.
+ * A forward scan stops at end key, and does not go on to the next leaf when
+ * high key tells every key there is larger than end key.
+ * A posting list reference of non-unique key is expanded into one pair per
+ * value, its chain being guarded by the latch of leaf(see
+ * BPlusTree::InsertIntoPostingList()).
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CopyItems(Page *page, bool forward) {
+  auto *leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+  auto &comparator = tree_->comparator_;
+  page_id_ = leaf->GetPageId();
+  next_page_id_ = leaf->GetNextPageId();
+  prev_page_id_ = leaf->GetPrevPageId();
+  version_ = tree_->structure_version_;
+
+  std::vector<MappingType> items;
+  leaf->GetItems(items);
+  items_.clear();
+  for (auto &item : items) {
+    if (has_key_) {
+      int cmp = comparator(item.first, key_);
+      if (forward ? (cmp < 0 || (cmp == 0 && !inclusive_))
+                  : (cmp > 0 || (cmp == 0 && !inclusive_))) {
+        continue;
+      }
+    }
+    if (forward && has_end_key_ && PastEndKey(item.first)) {
+      next_page_id_ = INVALID_PAGE_ID;
+      break;
+    }
+    if (!tree_->unique_key_ &&
+        BPlusTreePostingPage::IsReference(item.second)) {
+      std::vector<ValueType> values;
+      tree_->GetPostingList(item.second.GetPageId(), values);
+      for (auto &value : values) {
+        items_.push_back(MappingType(item.first, value));
+      }
+      continue;
+    }
+    items_.push_back(item);
+  }
+  // every key of next leaf is no smaller than high key
+  if (forward && has_end_key_ && next_page_id_ != INVALID_PAGE_ID &&
+      PastEndKey(leaf->GetHighKey())) {
+    next_page_id_ = INVALID_PAGE_ID;
+  }
+
+  index_ = forward ? 0 : static_cast<int>(items_.size()) - 1;
+  if (!items_.empty()) {
+    key_ = forward ? items_.back().first : items_.front().first;
+    has_key_ = true;
+    inclusive_ = false;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::PastEndKey(const KeyType &key) const {
+  int cmp = tree_->comparator_(key, end_key_);
+  return cmp > 0 || (cmp == 0 && !end_inclusive_);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() {
-    buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
+void INDEXITERATOR_TYPE::Release(Page *page) {
+  page->RUnlatch();
+  buff_pool_manager_->UnpinPage(page->GetPageId(), false);
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
@@ -26,5 +227,7 @@ template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
 template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
 template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexIterator<GenericKey<128>, RID, GenericComparator<128>>;
+template class IndexIterator<GenericKey<256>, RID, GenericComparator<256>>;
 
 } // namespace cmudb
@@ -6,6 +6,10 @@
 
 namespace cmudb {
 
+/*
+ * Called with latch held, once flush buffer is written(flush_size_ is 0), so
+ * that records in it are not overwritten
+ */
 void LogManager::SwapBuffer() {
   char *tmp = nullptr;
   tmp = flush_buffer_;
@@ -16,11 +20,13 @@ void LogManager::SwapBuffer() {
 }
 
 void LogManager::wakeUpFlushThread() {
+  std::unique_lock<std::mutex> lock(latch_);
   if (log_buf_offset_ > 0) {
+    flushed_cv_.wait(lock, [this] { return flush_size_ == 0; });
     SwapBuffer();
     // wake up flush thread
     cv_.notify_one();
-  }  
+  }
 }
 
 void LogManager::task1() {
@@ -29,21 +35,21 @@ void LogManager::task1() {
       std::cout << "Thread another loop\n";
       std::unique_lock<std::mutex> lk(latch_);
       auto now = std::chrono::system_clock::now();
-      if(cv_.wait_until(lk, now + LOG_TIMEOUT, [&](){ return false; })) {
+      if(cv_.wait_until(lk, now + LOG_TIMEOUT, [&](){ return flush_size_ > 0; })) {
         // buffer full or buffer manager signal
         std::cout << "Thread was wakenup to write log\n";
-        disk_manager_->WriteLog(flush_buffer_, flush_size_);
-        flush_size_ = 0; 
       }
       else {
         // time out, flush
-        if (log_buf_offset_ > 0) {
-          SwapBuffer();
-          std::cout << "Thread timed out. log size is: " << flush_size_ << std::endl;
-          disk_manager_->WriteLog(flush_buffer_, flush_size_);
-          flush_size_ = 0;
-        }                
-      }          
+        if (log_buf_offset_ == 0)
+          continue;
+        SwapBuffer();
+        std::cout << "Thread timed out. log size is: " << flush_size_ << std::endl;
+      }
+      disk_manager_->WriteLog(flush_buffer_, flush_size_);
+      flush_size_ = 0;
+      // appenders waiting for a buffer to swap in
+      flushed_cv_.notify_all();
   }
 }
 
@@ -90,9 +96,11 @@ void LogManager::StopFlushThread() {
  *
  */
 lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
-  std::lock_guard<std::mutex> lock(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
 
   if (log_buf_offset_ + log_record.size_ >= LOG_BUFFER_SIZE) {
+    // flush buffer may not be written yet, if records come in faster
+    flushed_cv_.wait(lock, [this] { return flush_size_ == 0; });
     SwapBuffer();
     // wake up flush thread
     cv_.notify_one();
@@ -130,6 +138,16 @@ lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
   } else if (log_record.log_record_type_ == LogRecordType::NEWPAGE) {
      //prev_page_id
      memcpy(log_buffer_ + pos, &log_record.prev_page_id_, sizeof(page_id_t));
+  } else if (log_record.log_record_type_ == LogRecordType::NEWOVERFLOWPAGE ||
+      log_record.log_record_type_ == LogRecordType::DELETEOVERFLOWPAGE) {
+     memcpy(log_buffer_ + pos, &log_record.overflow_page_id_, sizeof(page_id_t));
+     pos += sizeof(page_id_t);
+     memcpy(log_buffer_ + pos, &log_record.next_page_id_, sizeof(page_id_t));
+     pos += sizeof(page_id_t);
+     int32_t data_size = log_record.overflow_data_.size();
+     memcpy(log_buffer_ + pos, &data_size, sizeof(int32_t));
+     pos += sizeof(int32_t);
+     memcpy(log_buffer_ + pos, log_record.overflow_data_.data(), data_size);
   }
 
   log_buf_offset_ += log_record.size_;
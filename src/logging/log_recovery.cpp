@@ -3,6 +3,7 @@
  */
 
 #include "logging/log_recovery.h"
+#include "page/overflow_page.h"
 #include "page/table_page.h"
 
 namespace cmudb {
@@ -36,7 +37,7 @@ bool LogRecovery::DeserializeLogRecord(const char *data,
 
   switch(log_record_type_) {
     case LogRecordType::INSERT: {
-      log_record.insert_rid_ = *reinterpret_cast<const int *>(data + 20);
+      log_record.insert_rid_ = *reinterpret_cast<const RID *>(data + 20);
       // | HEADER | tuple_rid | tuple_size | tuple_data
       // We skip header, RID, then desrialize.
       // First value is tuple size, then data
@@ -47,12 +48,12 @@ bool LogRecovery::DeserializeLogRecord(const char *data,
     case LogRecordType::ROLLBACKDELETE:
     case LogRecordType::APPLYDELETE:
     {
-      log_record.delete_rid_ = *reinterpret_cast<const int *>(data + 20);
+      log_record.delete_rid_ = *reinterpret_cast<const RID *>(data + 20);
       log_record.delete_tuple_.DeserializeFrom(data + 20 + sizeof(RID));
       break;
     }
     case LogRecordType::UPDATE: {
-      log_record.update_rid_ = *reinterpret_cast<const int *>(data + 20);
+      log_record.update_rid_ = *reinterpret_cast<const RID *>(data + 20);
       log_record.old_tuple_.DeserializeFrom(data + 20 + sizeof(RID));
       // header + RID + sizeof(int) + old tuple size 
       log_record.new_tuple_.DeserializeFrom(data + 20 + sizeof(RID) + 4 + log_record.old_tuple_.GetLength());
@@ -63,6 +64,16 @@ bool LogRecovery::DeserializeLogRecord(const char *data,
         data + LogRecord::HEADER_SIZE);
       break;
     }
+    case LogRecordType::NEWOVERFLOWPAGE:
+    case LogRecordType::DELETEOVERFLOWPAGE: {
+      // | HEADER | page_id | next_page_id | data_size | data
+      const char *pos = data + LogRecord::HEADER_SIZE;
+      log_record.overflow_page_id_ = *reinterpret_cast<const page_id_t *>(pos);
+      log_record.next_page_id_ = *reinterpret_cast<const page_id_t *>(pos + 4);
+      int32_t data_size = *reinterpret_cast<const int32_t *>(pos + 8);
+      log_record.overflow_data_.assign(pos + 12, pos + 12 + data_size);
+      break;
+    }
     default:
       break;
   }
@@ -178,7 +189,11 @@ void LogRecovery::Redo() {
         assert(res);
         buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);            
         
-      } 
+      } else if (log_record.log_record_type_ == LogRecordType::NEWOVERFLOWPAGE) {
+        WriteOverflowPage(log_record);
+      } else if (log_record.log_record_type_ == LogRecordType::DELETEOVERFLOWPAGE) {
+        DeleteOverflowPage(log_record.overflow_page_id_);
+      }
       // tx is completed/failed, remove from active txn map. No redo.
       if (log_record.log_record_type_ == LogRecordType::COMMIT ||
             log_record.log_record_type_ == LogRecordType::ABORT) {
@@ -243,7 +258,41 @@ void LogRecovery::UndoInternal(LogRecord &log_record) {
       log_record.update_rid_, nullptr, nullptr, nullptr);
     assert(res);
     buffer_pool_manager_->UnpinPage(rid.GetPageId(), true); 
-  } 
+  } else if (log_record.log_record_type_ == LogRecordType::NEWOVERFLOWPAGE) {
+    std::cout << "UndoInternal for NEWOVERFLOWPAGE" << std::endl;
+    DeleteOverflowPage(log_record.overflow_page_id_);
+  } else if (log_record.log_record_type_ == LogRecordType::DELETEOVERFLOWPAGE) {
+    std::cout << "UndoInternal for DELETEOVERFLOWPAGE" << std::endl;
+    WriteOverflowPage(log_record);
+  }
+}
+
+/*
+ * Write a page of an overflow chain as logged, unless it is there already. A
+ * page never written out, or freed, holds another page id
+ */
+void LogRecovery::WriteOverflowPage(LogRecord &log_record) {
+  page_id_t page_id = log_record.overflow_page_id_;
+  auto page = buffer_pool_manager_->FetchPage(page_id);
+  assert(page != nullptr);
+  auto *overflow = reinterpret_cast<OverflowPage *>(page->GetData());
+  if (overflow->GetPageId() == page_id && page->GetLSN() >= log_record.lsn_) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return;
+  }
+  overflow->Init(page_id, log_record.next_page_id_);
+  overflow->Write(log_record.overflow_data_.data(),
+                  log_record.overflow_data_.size());
+  page->SetLSN(log_record.lsn_);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+void LogRecovery::DeleteOverflowPage(page_id_t page_id) {
+  // buffer pool deletes a page it holds only
+  auto page = buffer_pool_manager_->FetchPage(page_id);
+  assert(page != nullptr);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  buffer_pool_manager_->DeletePage(page_id);
 }
 
 /*
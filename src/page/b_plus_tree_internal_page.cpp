@@ -3,6 +3,7 @@
  */
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
 #include "page/b_plus_tree_internal_page.h"
@@ -21,31 +22,56 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
                                           page_id_t parent_id) {
   SetPageType(IndexPageType::INTERNAL_PAGE);
-  SetSize(1); // 1 for the first invalid key                            
+  SetSize(0); // no child until populated, see PopulateNewRoot()/PopulateFrom()
   SetPageId(page_id);
   SetParentPageId(parent_id);
 
-  // header size is 20 bytes, another 4 bytes for the 1st invalid k/v pair
-  // Total record size divded by each record size is max allowed size
-  int size = (PAGE_SIZE - sizeof(B_PLUS_TREE_INTERNAL_PAGE_TYPE)) / sizeof(MappingType) - 1; 
-  LOG_INFO("Max size of internal page is: %d", size);
-  SetMaxSize(size);
+  SetNextPageId(INVALID_PAGE_ID);
+
+  // header size is 28 bytes
+  // Max size is the number of bytes behind the slotted area header, keys take
+  // as many bytes as they need so page holds a varying number of pairs
+  area_.Init(PAGE_SIZE - sizeof(B_PLUS_TREE_INTERNAL_PAGE_TYPE));
+  SetMaxSize(area_.GetDataSize());
+}
+
+/*
+ * Helper methods to set/get next page id, and to get high key. Every key of
+ * this page's subtree is smaller than high key, which is only meaningful when
+ * page has a next page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const {
+  return next_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const {
+  return area_.HighKey();
 }
 
 /*  
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
+ * Setting a key rebuilds the page since new key may share less prefix
+ * @return  false if page has no room for new key, page is left unchanged
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  
-  return array[index].first;
+  return area_.KeyAt(index);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
-  array[index].first = key;
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  std::vector<MappingType> items;
+  GetItems(items);
+  items[index].first = key;
+  return area_.PopulateFrom(&items[0], GetSize(), true, area_.HighKey());
 }
 
 /*
@@ -55,7 +81,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
   for(int i = 0; i < GetSize(); i++) {
-    if (array[i].second == value)
+    if (area_.ValueAt(i) == value)
       return i;
   }
   return -1;
@@ -67,7 +93,36 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { 
-  return array[index].second; 
+  return area_.ValueAt(index);
+}
+
+/*
+ * Helper method to get bytes taken by key & value pairs of this page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetUsedSize() const {
+  return area_.GetUsedSize(GetSize());
+}
+
+/*
+ * Safe to insert means two more keys fit without split(a child that lost a
+ * long prefix may split into three, see SplitPoints()), whatever prefix they
+ * share. Safe to delete means removing any pair keeps page at least half full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSafe(int type) const {
+  if (type == 1) { // insert
+    return GetUsedSize() + area_.GetPrefixSize() * GetSize() +
+               2 * area_.GetMaxEntrySize() <= GetMaxSize();
+  } else if (type == 2) { // delete
+    return GetUsedSize() - area_.GetMaxEntrySize() >= GetMinSize();
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderflow() const {
+  return GetSize() == 0 || GetUsedSize() < GetMinSize();
 }
 
 /*****************************************************************************
@@ -82,15 +137,39 @@ INDEX_TEMPLATE_ARGUMENTS
 ValueType
 B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key,
                                        const KeyComparator &comparator) const {
-  // Use binary search
-  int foundIndex = 0;
-  int e = GetSize();
-  for (int b = 1; b < e; b++) {
-    if (comparator(array[b].first, key) <= 0) {
-      foundIndex = b;
+  // binary search for the first key larger than input key
+  int lo = 1;
+  int hi = GetSize();
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (comparator(area_.KeyAt(mid), key) <= 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return area_.ValueAt(lo - 1);
+}
+
+/*
+ * Find and return the child pointer(page_id) which points to the child page
+ * that holds the largest keys smaller than input "key"
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupBefore(
+    const KeyType &key, const KeyComparator &comparator) const {
+  // binary search for the first key no smaller than input key
+  int lo = 1;
+  int hi = GetSize();
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (comparator(area_.KeyAt(mid), key) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
     }
   }
-  return array[foundIndex].second;
+  return area_.ValueAt(lo - 1);
 }
 
 /*****************************************************************************
@@ -107,76 +186,122 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(
     const ValueType &old_value, const KeyType &new_key,
     const ValueType &new_value) {
   // must be a new page
-  assert(GetSize() == 1);
-  array[0].second = old_value;
-  array[1].first = new_key;
-  array[1].second = new_value;
-  IncreaseSize(1);
+  assert(GetSize() == 0);
+  MappingType items[2] = {MappingType(new_key, old_value),
+                          MappingType(new_key, new_value)};
+  area_.PopulateFrom(items, 2, true, area_.HighKey());
+  SetSize(2);
 }
 
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
- * @return:  new size after insertion
+ * @return:  false if page has no room for the pair, page is left unchanged
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(
     const ValueType &old_value, const KeyType &new_key,
     const ValueType &new_value) {
   
   int preIndex = ValueIndex(old_value);
   assert(preIndex != -1);
   
-  // Shift all nodes from preIndex + 1 to right by 1
-  for (int i = GetSize(); i >= preIndex + 1; i--) {
-    array[i].first = array[i - 1].first;
-    array[i].second = array[i - 1].second;
-  }
-
   // insert node after previous old node
-  array[preIndex + 1].first = new_key;
-  array[preIndex + 1].second = new_value;
-
+  if (!area_.InsertAt(GetSize(), preIndex + 1,
+                      MappingType(new_key, new_value), true)) {
+    return false;
+  }
   IncreaseSize(1);
-  return GetSize();
+  return true;
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Collect every key & value pair of this page, first key included
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetItems(
+    std::vector<MappingType> &items) const {
+  area_.GetItems(GetSize(), items);
+}
+
+/*
+ * Bytes the items would take in an empty page(first key is ignored), page
+ * fits them if it is no more than max size
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetEncodedSize(const MappingType *items,
+                                                   int size) const {
+  return area_.GetEncodedSize(items, size, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetEncodedSize(
+    const MappingType *items, int size, const KeyType &high_key) const {
+  return area_.GetEncodedSize(items, size, true) +
+         area_.GetHighKeySize(high_key);
+}
+
+/*
+ * Cut items that overflow one page into pages, first key of every page but
+ * the first one is pushed up to parent and becomes high key of the page on
+ * its left, the last one keeps high key of this page. See SplitPoints() in
+ * b_plus_tree_slotted_area.cpp
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
-    BPlusTreeInternalPage *recipient,
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SplitPoints(
+    const std::vector<MappingType> &items, std::vector<int> &points) const {
+  area_.SplitPoints(items, true, GetHighKey(), points);
+}
+
+/*
+ * Replace content of this page with children pairs sorted by key, the key of
+ * the first pair is ignored just like any other first key. Every child is
+ * adopted by this page. High key is kept unless a new one is given.
+ * NOTE: This method is called within BulkLoad() and when pages are split,
+ * merged or redistributed(b_plus_tree.cpp)
+ * @return  false if items do not fit, page is left unchanged
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateFrom(
+    const MappingType *items, int size,
+    BufferPoolManager *buffer_pool_manager) {
+  return PopulateFrom(items, size, GetHighKey(), buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateFrom(
+    const MappingType *items, int size, const KeyType &high_key,
     BufferPoolManager *buffer_pool_manager) {
-  // remove from split index to the end
-  int splitIndex = (GetSize() + 1) / 2;
-  recipient->CopyHalfFrom(&array[splitIndex], GetSize() - splitIndex, buffer_pool_manager);
+  if (!area_.PopulateFrom(items, size, true, high_key)) {
+    return false;
+  }
+  SetSize(size);
+  AdoptChildren(buffer_pool_manager);
+  return true;
+}
 
-  // we need to fix the removed nodes
-  // the children's parents are different now!
-  for (int i = splitIndex; i < GetSize(); i++) {
+/*
+ * Set parent page id of every child to this page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::AdoptChildren(
+    BufferPoolManager *buffer_pool_manager) {
+  for (int i = 0; i < GetSize(); i++) {
     auto *page = buffer_pool_manager->FetchPage(ValueAt(i));
+    if (page == nullptr)
+      throw Exception(EXCEPTION_TYPE_INDEX,
+                      "all page are pinned while adopting children");
     BPlusTreePage *node =
         reinterpret_cast<BPlusTreePage *>(page->GetData());
-    node->SetParentPageId(recipient->GetPageId());
-    buffer_pool_manager->UnpinPage(page->GetPageId(), true);
+    bool dirty = node->GetParentPageId() != GetPageId();
+    node->SetParentPageId(GetPageId());
+    buffer_pool_manager->UnpinPage(ValueAt(i), dirty);
   }
-  IncreaseSize(-1 * (GetSize() - splitIndex));
 }
 
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyHalfFrom(
-    MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
-    // it is a new page
-    for (int i = 0; i < size; i++) {
-      array[1 + i] = items[i];
-    }
-    IncreaseSize(size);
-}    
-
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -187,10 +312,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyHalfFrom(
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
-  // Shuffle the data
-  for (int i = index; i < GetSize() - 1; ++i) {
-    array[i] = array[i+1];
-  }
+  area_.RemoveAt(GetSize(), index);
   IncreaseSize(-1);
 }
 
@@ -200,163 +322,89 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
-  assert(GetSize() == 2);
-  ValueType v = array[1].second;
-  array[1].second = INVALID_PAGE_ID;
-  IncreaseSize(-1);
+  assert(GetSize() == 1);
+  ValueType v = ValueAt(0);
+  Remove(0);
   return v;
 }
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 /*
- * Remove all of key & value pairs from this page to "recipient" page, then
- * update relavent key & value pair in its parent page.
+ * Remove all of key & value pairs from this page to "recipient" page. Key of
+ * this page in parent comes down as the key of our first child, high key and
+ * next page id are handed over to recipient.
+ * @return  false if recipient has no room for them, nothing is moved
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(
   BPlusTreeInternalPage *recipient, int index_in_parent,
   BufferPoolManager *buffer_pool_manager) {
 
-  // remove my Parent's memory of me
   auto *pPage = buffer_pool_manager->FetchPage(GetParentPageId());
   BPlusTreeInternalPage *parentNode =
         reinterpret_cast<BPlusTreeInternalPage *>(pPage->GetData());
   
   // assumption: current page is at the right hand of recipient
   assert(parentNode->ValueAt(index_in_parent) == GetPageId());
-
+  KeyType middleKey = parentNode->KeyAt(index_in_parent);
 
   // unpin parent page
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
-
-  // Note: When copy internal page, the index 0 needs to be populated with the correct key
-  // Caller must already fill the index 0 real key
+  buffer_pool_manager->UnpinPage(GetParentPageId(), false);
 
-  recipient->CopyAllFrom(&array[0], GetSize(), buffer_pool_manager);  
+  std::vector<MappingType> items;
+  std::vector<MappingType> ours;
+  recipient->GetItems(items);
+  GetItems(ours);
+  ours[0].first = middleKey;
+  items.insert(items.end(), ours.begin(), ours.end());
 
   // give my children to the new recipient
-  for (int i = 0; i < GetSize(); i++) {
-    auto *page = buffer_pool_manager->FetchPage(ValueAt(i));
-    BPlusTreePage *node =
-        reinterpret_cast<BPlusTreePage *>(page->GetData());
-    node->SetParentPageId(recipient->GetPageId());
-    buffer_pool_manager->UnpinPage(ValueAt(i), true);
+  if (!recipient->PopulateFrom(&items[0], items.size(), GetHighKey(),
+                               buffer_pool_manager)) {
+    return false;
   }
-  
-  SetSize(0); // we are empty
- }
+  recipient->SetNextPageId(GetNextPageId());
 
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyAllFrom(
-    MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
-  int startIndex = GetSize();
-  for (int i = 0; i < size; i++) {
-    array[startIndex + i] = items[i];
-  }    
-  IncreaseSize(size);
+  SetSize(0); // we are empty
+  return true;
 }
 
 /*****************************************************************************
  * REDISTRIBUTE
  *****************************************************************************/
 /*
- * Remove the first key & value pair from this page to tail of "recipient"
- * page, then update relavent key & value pair in its parent page.
+ * Even out bytes of this page and its right "sibling" page. Key of sibling in
+ * parent comes down in front of its first child and the new first key of
+ * sibling is pushed up to replace it, also as high key of this page. Children
+ * that moved are adopted.
+ * @return  false if new key does not fit into parent, nothing changes
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
-    BPlusTreeInternalPage *recipient,
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::RedistributeWith(
+    BPlusTreeInternalPage *sibling, BPlusTreeInternalPage *parent,
+    int index_in_parent, const KeyComparator &,
     BufferPoolManager *buffer_pool_manager) {
-  
-  recipient->CopyLastFrom(array[0], buffer_pool_manager);
-
-  // set the transfering node's child page's parent to recipient 
-  auto *page = buffer_pool_manager->FetchPage(array[0].second);
-  BPlusTreePage *node =
-      reinterpret_cast<BPlusTreePage *>(page->GetData());
-  node->SetParentPageId(recipient->GetPageId());
-  buffer_pool_manager->UnpinPage(array[0].second, true);
-
-  Remove(0);
-
-  auto *pPage = buffer_pool_manager->FetchPage(GetParentPageId());
-  BPlusTreeInternalPage *parentNode =
-        reinterpret_cast<BPlusTreeInternalPage *>(pPage->GetData());
-
-  // if parent's node key is our removed key, change the node key
-  int ourPageIdInParentIndex = parentNode->ValueIndex(GetPageId());
-  parentNode->SetKeyAt(ourPageIdInParentIndex, KeyAt(0)); // Our new first key. Copy up to parent
-
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
-
-  // we do not need to remove, since Remove(0) already took care for us
-  //IncreaseSize(-1);
-}
-
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(
-    const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  array[GetSize()] = pair;
-  IncreaseSize(1);
-}
-
-/*
- * Remove the last key & value pair from this page to head of "recipient"
- * page, then update relavent key & value pair in its parent page.
- */
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
-    BPlusTreeInternalPage *recipient, int parent_index, // This 'parent_index' should be recipient's index?
-    BufferPoolManager *buffer_pool_manager) {
-
-  MappingType pair = array[GetSize() - 1];
-  recipient->CopyLastFrom(pair, buffer_pool_manager);
-
-  // Set the moved node's child to the correct parent
-  auto *page = buffer_pool_manager->FetchPage(pair.second);
-  BPlusTreePage *node =
-      reinterpret_cast<BPlusTreePage *>(page->GetData());
-  assert(node);
-  node->SetParentPageId(recipient->GetPageId());
-  
-  buffer_pool_manager->UnpinPage(pair.second, true); 
-
-  auto *pPage = buffer_pool_manager->FetchPage(GetParentPageId());
-  BPlusTreeInternalPage *parentNode =
-        reinterpret_cast<BPlusTreeInternalPage *>(pPage->GetData());
-
-  // parent_index should recipient's position in parent node
-  // update the key content
-  parentNode->SetKeyAt(parent_index, pair.first); 
-
-  // now we do clean up, including remove the last node
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
-  Remove(GetSize() - 1); // remove last one
-  IncreaseSize(-1);
-}
-
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(
-    const MappingType &pair, int parent_index,
-    BufferPoolManager *buffer_pool_manager) {
-  
-  // move every item to the next, to give space to our new record
-  for (int i = GetSize(); i > 0; i--) {
-    array[i] = array[i - 1];
+  std::vector<MappingType> items;
+  std::vector<MappingType> theirs;
+  GetItems(items);
+  sibling->GetItems(theirs);
+  theirs[0].first = parent->KeyAt(index_in_parent);
+  items.insert(items.end(), theirs.begin(), theirs.end());
+
+  std::vector<int> points;
+  area_.SplitPoints(items, true, sibling->GetHighKey(), points);
+  if (points.size() != 1) {
+    return false;
   }
-  array[0] = pair;
-  IncreaseSize(1);
-}
-
-INDEX_TEMPLATE_ARGUMENTS
-MappingType B_PLUS_TREE_INTERNAL_PAGE_TYPE::PushUpIndex() {
-  MappingType pair = array[1];
-  array[0].second = pair.second;
-
-  Remove(1);
-
-  return pair;
+  int split = points[0];
+  if (!parent->SetKeyAt(index_in_parent, items[split].first)) {
+    return false;
+  }
+  PopulateFrom(&items[0], split, items[split].first, buffer_pool_manager);
+  sibling->PopulateFrom(&items[split], items.size() - split,
+                        buffer_pool_manager);
+  return true;
 }
 
 /*****************************************************************************
@@ -367,7 +415,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::QueueUpChildren(
     std::queue<BPlusTreePage *> *queue,
     BufferPoolManager *buffer_pool_manager) {
   for (int i = 0; i < GetSize(); i++) {
-    auto *page = buffer_pool_manager->FetchPage(array[i].second);
+    auto *page = buffer_pool_manager->FetchPage(ValueAt(i));
     if (page == nullptr)
       throw Exception(EXCEPTION_TYPE_INDEX,
                       "all page are pinned while printing");
@@ -397,9 +445,9 @@ std::string B_PLUS_TREE_INTERNAL_PAGE_TYPE::ToString(bool verbose) const {
     } else {
       os << " ";
     }
-    os << std::dec << array[entry].first.ToString();
+    os << std::dec << KeyAt(entry).ToString();
     if (verbose) {
-      os << "(" << array[entry].second << ")";
+      os << "(" << ValueAt(entry) << ")";
     }
     ++entry;
   }
@@ -417,4 +465,8 @@ template class BPlusTreeInternalPage<GenericKey<32>, page_id_t,
                                            GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t,
                                            GenericComparator<64>>;
+template class BPlusTreeInternalPage<GenericKey<128>, page_id_t,
+                                           GenericComparator<128>>;
+template class BPlusTreeInternalPage<GenericKey<256>, page_id_t,
+                                           GenericComparator<256>>;
 } // namespace cmudb
@@ -29,13 +29,13 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id) {
   SetParentPageId(parent_id);
 
   SetNextPageId(INVALID_PAGE_ID);
-  
-  // header size is 24 bytes
-  // Total record size divded by each record size is max allowed size
-  // IMPORTANT: leave a always available slot for insertion! Otherwise, insert will cause memory stomp
-  int size = (PAGE_SIZE - sizeof(B_PLUS_TREE_LEAF_PAGE_TYPE)) / sizeof(MappingType) - 1; 
-  LOG_INFO("Max size of leaf page is: %d", size);
-  SetMaxSize(size);
+  SetPrevPageId(INVALID_PAGE_ID);
+
+  // header size is 32 bytes
+  // Max size is the number of bytes behind the slotted area header, keys take
+  // as many bytes as they need so page holds a varying number of pairs
+  area_.Init(PAGE_SIZE - sizeof(B_PLUS_TREE_LEAF_PAGE_TYPE));
+  SetMaxSize(area_.GetDataSize());
 }
 
 /**
@@ -52,19 +52,47 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
 }
 
 /**
- * Helper method to find the first index i so that array[i].first >= key
- * NOTE: This method is only used when generating index iterator
+ * Helper methods to set/get previous page id. Only a hint, a split does not
+ * update the page on its right and a merge leaves it pointing at the page
+ * merged away, see IndexIterator::operator--()
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const {
+  return prev_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) {
+  prev_page_id_ = prev_page_id;
+}
+
+/*
+ * Helper method to get high key, every key of this page is smaller. Only
+ * meaningful when page has a next page, the last leaf is unbounded
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const {
+  return area_.HighKey();
+}
+
+/**
+ * Helper method to find the first index i so that KeyAt(i) >= key
+ * @return  page size if every key is smaller than input key
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(
     const KeyType &key, const KeyComparator &comparator) const {
-  for (int i = 0; i < GetSize(); ++i) {
-    if (comparator(array[i].first, key) >= 0) {
-      return i;
+  int lo = 0;
+  int hi = GetSize();
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (comparator(area_.KeyAt(mid), key) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
     }
   }
-  //LOG_INFO("B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex: no key larger than %d found", key)
-  return -1;
+  return lo;
 }
 
 /*
@@ -73,8 +101,7 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  return array[index].first;
+  return area_.KeyAt(index);
 }
 
 /*
@@ -82,9 +109,37 @@ KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
-  return array[index];
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
+  return MappingType(area_.KeyAt(index), area_.ValueAt(index));
+}
+
+/*
+ * Helper method to get bytes taken by key & value pairs of this page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::GetUsedSize() const {
+  return area_.GetUsedSize(GetSize());
+}
+
+/*
+ * Safe to insert means any key fits without split, even one that shares no
+ * prefix with the keys in page. Safe to delete means removing any pair keeps
+ * page at least half full(removal never changes the prefix).
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsSafe(int type) const {
+  if (type == 1) { // insert
+    return GetUsedSize() + area_.GetPrefixSize() * GetSize() +
+               area_.GetMaxEntrySize() <= GetMaxSize();
+  } else if (type == 2) { // delete
+    return GetUsedSize() - area_.GetMaxEntrySize() >= GetMinSize();
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsUnderflow() const {
+  return GetSize() == 0 || GetUsedSize() < GetMinSize();
 }
 
 /*****************************************************************************
@@ -92,61 +147,58 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
- * @return  page size after insertion
+ * @return  false if page has no room for the pair, page is left unchanged
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key,
-                                       const ValueType &value,
-                                       const KeyComparator &comparator) {
-  MappingType pair;
-  pair.first = key;
-  pair.second = value;
-
-  int upperBoundKeyIndex = KeyIndex(key, comparator);
-  if (upperBoundKeyIndex == -1) {
-    // all index smaller than key, key should be inserted to last
-    array[GetSize()] = pair;
-  } else {
-    // insert pair to upperBoundKeyIndex - 1
-    // shuffle array to right
-    for (int i = GetSize() - 1; i >= upperBoundKeyIndex; i--) {
-      array[i + 1] = array[i];
-    }
-    array[upperBoundKeyIndex] = pair;
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key,
+                                        const ValueType &value,
+                                        const KeyComparator &comparator) {
+  if (!area_.InsertAt(GetSize(), KeyIndex(key, comparator),
+                      MappingType(key, value), false)) {
+    return false;
   }
-
   IncreaseSize(1);
-  return GetSize();
+  return true;
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Collect every key & value pair of this page in key order
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(
-    BPlusTreeLeafPage *recipient,
-    __attribute__((unused)) BufferPoolManager *buffer_pool_manager) {
-  // remove from split index to the end
-  int splitIndex = (GetSize() + 1) / 2;
-  recipient->CopyHalfFrom(&array[splitIndex], GetSize() - splitIndex);
-
-  IncreaseSize(-1 * (GetSize() - splitIndex));
-  // adjust next page id since recipient is a new page
-  recipient->SetNextPageId(GetNextPageId());
-  SetNextPageId(recipient->GetPageId());
+void B_PLUS_TREE_LEAF_PAGE_TYPE::GetItems(
+    std::vector<MappingType> &items) const {
+  area_.GetItems(GetSize(), items);
+}
+
+/*
+ * Bytes the items would take in an empty page, page fits them if it is no
+ * more than max size
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::GetEncodedSize(const MappingType *items,
+                                               int size) const {
+  return area_.GetEncodedSize(items, size, false);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyHalfFrom(MappingType *items, int size) {
-  // it is a new page
-  for (int i = 0; i < size; i++) {
-    // array starts from index 0
-    array[i] = items[i];
-  }
-  IncreaseSize(size);
+int B_PLUS_TREE_LEAF_PAGE_TYPE::GetEncodedSize(const MappingType *items,
+                                               int size,
+                                               const KeyType &high_key) const {
+  return area_.GetEncodedSize(items, size, false) +
+         area_.GetHighKeySize(high_key);
+}
+
+/*
+ * Cut items that overflow one page into pages, the last one keeps high key
+ * of this page. See SplitPoints() in b_plus_tree_slotted_area.cpp
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SplitPoints(
+    const std::vector<MappingType> &items, std::vector<int> &points) const {
+  area_.SplitPoints(items, false, GetHighKey(), points);
 }
 
 /*****************************************************************************
@@ -159,16 +211,35 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyHalfFrom(MappingType *items, int size) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value,
-                                        const KeyComparator &comparator) const {
-  // TODO: Use binary search
-  for(int i = 0; i < GetSize(); i++) {
-    int result = comparator(array[i].first,key);
-    if (result == 0) {
-      //LOG_INFO("B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup: Found a value based on key in index: %d", i);
-      value = array[i].second;
+                                        const KeyComparator &comparator,
+                                        KeyType *stored_key) const {
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize()) {
+    KeyType found_key = area_.KeyAt(index);
+    if (comparator(found_key, key) == 0) {
+      value = area_.ValueAt(index);
+      if (stored_key != nullptr) {
+        *stored_key = found_key;
+      }
       return true;
     }
-  }                                          
+  }
+  return false;
+}
+
+/*
+ * Replace the value stored with input key in place
+ * @return  false if the key does not exist
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::Update(const KeyType &key,
+                                        const ValueType &value,
+                                        const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(area_.KeyAt(index), key) == 0) {
+    area_.SetValueAt(index, value);
+    return true;
+  }
   return false;
 }
 
@@ -184,24 +255,13 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value,
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(
     const KeyType &key, const KeyComparator &comparator) {
-  
-  int keyIndex = -1;
-  for (int i = 0; i < GetSize(); ++i) {
-    if (comparator(array[i].first, key) == 0) {
-      keyIndex = i;
-      break;
-    }
-  }
-
-  if (keyIndex == -1) {
+  int keyIndex = KeyIndex(key, comparator);
+  if (keyIndex == GetSize() || comparator(area_.KeyAt(keyIndex), key) != 0) {
     LOG_INFO("B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord: key not found");
     return GetSize(); // Not found
   }
 
-  // shuffle to left by 1
-  for (int i = keyIndex; i < GetSize(); ++i) {
-    array[i] = array[i+1];
-  }
+  area_.RemoveAt(GetSize(), keyIndex);
   IncreaseSize(-1);
   return GetSize();
 }
@@ -211,106 +271,92 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(
  *****************************************************************************/
 /*
  * Remove all of key & value pairs from this page to "recipient" page, then
- * update next page id
+ * hand high key and next page id over to it
+ * @return  false if recipient has no room for them, nothing is moved
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient,
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient,
                                            int, BufferPoolManager *) {
   // NOTE: This function assume current page is at the right hand of recipient
-
-  recipient->CopyAllFrom(&array[0], GetSize());
+  std::vector<MappingType> items;
+  std::vector<MappingType> ours;
+  recipient->GetItems(items);
+  GetItems(ours);
+  items.insert(items.end(), ours.begin(), ours.end());
+  if (!recipient->PopulateFrom(items.data(), items.size(), GetHighKey())) {
+    return false;
+  }
   // leaf has no children
   
   // assumption: current page is at the right hand of recipient
   recipient->SetNextPageId(GetNextPageId());
 
   SetSize(0); // we are empty
-}
-
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyAllFrom(MappingType *items, int size) {
-  int startIndex = GetSize();
-  for (int i = 0; i < size; i++) {
-    array[startIndex + i] = items[i];
-  }    
-  IncreaseSize(size);
+  return true;
 }
 
 /*****************************************************************************
  * REDISTRIBUTE
  *****************************************************************************/
 /*
- * Remove the first key & value pair from this page to "recipient" page, then
- * update relavent key & value pair in its parent page.
+ * Even out bytes of this page and its right "sibling" page, then update the
+ * key of sibling in parent page, and high key of this page, with a separator
+ * as short as comparator can make it.
+ * @return  false if new separator does not fit into parent, nothing changes
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(
-    BPlusTreeLeafPage *recipient,
-    BufferPoolManager *buffer_pool_manager) {
-
-  recipient->CopyLastFrom(array[0]);
-  // remove index 0 node
-  for (int i = 0; i < GetSize(); ++i) {
-    array[i] = array[i + 1];
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::RedistributeWith(
+    BPlusTreeLeafPage *sibling,
+    BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+    int index_in_parent, const KeyComparator &comparator, BufferPoolManager *) {
+  std::vector<MappingType> items;
+  std::vector<MappingType> theirs;
+  GetItems(items);
+  sibling->GetItems(theirs);
+  items.insert(items.end(), theirs.begin(), theirs.end());
+
+  std::vector<int> points;
+  area_.SplitPoints(items, false, sibling->GetHighKey(), points);
+  if (points.size() != 1) {
+    return false;
   }
-
-  auto *pPage = buffer_pool_manager->FetchPage(GetParentPageId());
-  auto *parentNode =
-        reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(pPage->GetData());
-
-  // if parent's node key is our removed key, change the node key
-  int ourPageIdInParentIndex = parentNode->ValueIndex(GetPageId());
-  parentNode->SetKeyAt(ourPageIdInParentIndex, KeyAt(0)); // Our new first key. Copy up to parent
-
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
-  IncreaseSize(-1);
-}
-
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
-  array[GetSize()] = item;
-  IncreaseSize(1);
+  int split = points[0];
+  KeyType separator =
+      comparator.ShortestSeparator(items[split - 1].first, items[split].first);
+  if (!parent->SetKeyAt(index_in_parent, separator)) {
+    return false;
+  }
+  PopulateFrom(&items[0], split, separator);
+  sibling->PopulateFrom(&items[split], items.size() - split);
+  return true;
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
 /*
- * Remove the last key & value pair from this page to "recipient" page, then
- * update relavent key & value pair in its parent page.
+ * Replace content of this page with items that are already sorted by key,
+ * high key is kept unless a new one is given
+ * NOTE: This method is called within BulkLoad() and when pages are split,
+ * merged or redistributed(b_plus_tree.cpp)
+ * @return  false if items do not fit, page is left unchanged
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(
-    BPlusTreeLeafPage *recipient, int parentIndex,
-    BufferPoolManager *buffer_pool_manager) {
-
-  MappingType pair = array[GetSize() - 1];
-  recipient->CopyFirstFrom(pair, parentIndex, buffer_pool_manager);
-
-  auto *pPage = buffer_pool_manager->FetchPage(GetParentPageId());
-  auto *parentNode =
-        reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(pPage->GetData());
-
-  // parentIndex should recipient's position in parent node
-  // update the key content
-  parentNode->SetKeyAt(parentIndex, pair.first); 
-
-  // now we do clean up, including remove the last node
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
-
-  // index is the the last one, so we don't need to shuffle, just reduce our size
-  IncreaseSize(-1);
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::PopulateFrom(const MappingType *items,
+                                              int size, BufferPoolManager *) {
+  return PopulateFrom(items, size, GetHighKey());
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(
-    const MappingType &item, int parentIndex,
-    BufferPoolManager *buffer_pool_manager) {
-
-  // move every item to the next, to give space to our new record
-  // loop until i > 0
-  for (int i = GetSize(); i > 0; i--) {
-    array[i] = array[i - 1];
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::PopulateFrom(const MappingType *items,
+                                              int size,
+                                              const KeyType &high_key,
+                                              BufferPoolManager *) {
+  if (!area_.PopulateFrom(items, size, false, high_key)) {
+    return false;
   }
-  array[0] = item;
-  IncreaseSize(1);
+  SetSize(size);
+  return true;
 }
 
 /*****************************************************************************
@@ -336,9 +382,9 @@ std::string B_PLUS_TREE_LEAF_PAGE_TYPE::ToString(bool verbose) const {
     } else {
       stream << " ";
     }
-    stream << std::dec << array[entry].first;
+    stream << std::dec << area_.KeyAt(entry);
     if (verbose) {
-      stream << "(" << array[entry].second << ")";
+      stream << "(" << area_.ValueAt(entry) << ")";
     }
     ++entry;
   }
@@ -355,4 +401,8 @@ template class BPlusTreeLeafPage<GenericKey<32>, RID,
                                        GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID,
                                        GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<128>, RID,
+                                       GenericComparator<128>>;
+template class BPlusTreeLeafPage<GenericKey<256>, RID,
+                                       GenericComparator<256>>;
 } // namespace cmudb
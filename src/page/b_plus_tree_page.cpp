@@ -16,6 +16,10 @@ bool BPlusTreePage::IsRootPage() const {
     return (page_type_ == IndexPageType::INTERNAL_PAGE && parent_page_id_ == INVALID_PAGE_ID); 
 }
 void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_ = page_type; }
+// a page merged away is left invalid for readers that still pin it
+bool BPlusTreePage::IsMergedAway() const {
+    return (page_type_ == IndexPageType::INVALID_INDEX_PAGE);
+}
 
 /*
  * Helper methods to get/set size (number of key/value pairs stored in that
@@ -26,13 +30,13 @@ void BPlusTreePage::SetSize(int size) { size_ = size; }
 void BPlusTreePage::IncreaseSize(int amount) { size_+= amount; }
 
 /*
- * Helper methods to get/set max size (capacity) of the page
+ * Helper methods to get/set max size (capacity in bytes) of the page
  */
 int BPlusTreePage::GetMaxSize() const { return max_size_; }
 void BPlusTreePage::SetMaxSize(int size) { max_size_ = size; }
 
 /*
- * Helper method to get min page size
+ * Helper method to get min page size in bytes
  * Generally, min page size == max page size / 2
  */
 int BPlusTreePage::GetMinSize() const { return max_size_/2; }
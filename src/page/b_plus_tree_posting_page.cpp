@@ -0,0 +1,111 @@
+/**
+ * b_plus_tree_posting_page.cpp
+ */
+
+#include <cassert>
+#include <sstream>
+
+#include "page/b_plus_tree_posting_page.h"
+
+namespace cmudb {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+/**
+ * Init method after creating a new posting page
+ * Including set page id, next page id and set current size to zero
+ */
+void BPlusTreePostingPage::Init(page_id_t page_id, page_id_t next_page_id) {
+  page_id_ = page_id;
+  next_page_id_ = next_page_id;
+  size_ = 0;
+}
+
+page_id_t BPlusTreePostingPage::GetPageId() const { return page_id_; }
+
+/**
+ * Helper methods to set/get next page id
+ */
+page_id_t BPlusTreePostingPage::GetNextPageId() const { return next_page_id_; }
+
+void BPlusTreePostingPage::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+int BPlusTreePostingPage::GetSize() const { return size_; }
+
+/*
+ * Total record size divided by each record size is max allowed size, posting
+ * page never splits so no slot is kept spare
+ */
+int BPlusTreePostingPage::GetMaxSize() const {
+  return (PAGE_SIZE - sizeof(BPlusTreePostingPage)) / sizeof(RID);
+}
+
+RID BPlusTreePostingPage::RidAt(int index) const {
+  assert(index >= 0 && index < size_);
+  return array[index];
+}
+
+void BPlusTreePostingPage::SetRidAt(int index, const RID &rid) {
+  assert(index >= 0 && index < size_);
+  array[index] = rid;
+}
+
+/*
+ * Helper method to find the array offset of input rid
+ * @return  -1 if rid is not stored in this page
+ */
+int BPlusTreePostingPage::RidIndex(const RID &rid) const {
+  for (int i = 0; i < size_; i++) {
+    if (array[i] == rid) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Append rid to the end of array
+ * @return  false if page is already full
+ */
+bool BPlusTreePostingPage::Append(const RID &rid) {
+  if (size_ >= GetMaxSize()) {
+    return false;
+  }
+  array[size_++] = rid;
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Remove the last rid from this page and return it, used to fill the hole
+ * left by a deleted rid so record ids stay continuous
+ */
+RID BPlusTreePostingPage::RemoveLast() {
+  assert(size_ > 0);
+  return array[--size_];
+}
+
+/*****************************************************************************
+ * DEBUG
+ *****************************************************************************/
+std::string BPlusTreePostingPage::ToString() const {
+  std::ostringstream stream;
+  stream << "[pageId: " << page_id_ << " nextId: " << next_page_id_ << "]<"
+         << size_ << ">";
+  for (int i = 0; i < size_; i++) {
+    stream << " (" << array[i].GetPageId() << "," << array[i].GetSlotNum()
+           << ")";
+  }
+  return stream.str();
+}
+
+} // namespace cmudb
@@ -0,0 +1,378 @@
+/**
+ * b_plus_tree_slotted_area.cpp
+ */
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "index/generic_key.h"
+#include "page/b_plus_tree_slotted_area.h"
+
+namespace cmudb {
+
+#define SLOT_SIZE (static_cast<int>(sizeof(uint16_t) * 2))
+
+/*
+ * Number of bytes left once trailing zero bytes of key are dropped
+ */
+static int TrimmedSize(const char *key, int key_size) {
+  while (key_size > 0 && key[key_size - 1] == 0) {
+    key_size--;
+  }
+  return key_size;
+}
+
+static int CommonPrefixSize(const char *lhs, const char *rhs, int size) {
+  int i = 0;
+  while (i < size && lhs[i] == rhs[i]) {
+    i++;
+  }
+  return i;
+}
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+void BPlusTreeSlottedArea<KeyType, ValueType>::Init(int data_size) {
+  data_size_ = static_cast<uint16_t>(data_size);
+  prefix_size_ = 0;
+  high_key_size_ = 0;
+  free_space_pointer_ = data_size_;
+}
+
+template <typename KeyType, typename ValueType>
+int BPlusTreeSlottedArea<KeyType, ValueType>::GetDataSize() const {
+  return data_size_;
+}
+
+template <typename KeyType, typename ValueType>
+int BPlusTreeSlottedArea<KeyType, ValueType>::GetPrefixSize() const {
+  return prefix_size_;
+}
+
+/*
+ * Bytes taken by prefix, high key, slots and entries when area holds size
+ * pairs
+ */
+template <typename KeyType, typename ValueType>
+int BPlusTreeSlottedArea<KeyType, ValueType>::GetUsedSize(int size) const {
+  return prefix_size_ + high_key_size_ + size * SLOT_SIZE +
+         (data_size_ - free_space_pointer_);
+}
+
+/*
+ * Bytes the items would take once populated into an empty area, compare it
+ * with GetDataSize() to know whether they fit
+ */
+template <typename KeyType, typename ValueType>
+int BPlusTreeSlottedArea<KeyType, ValueType>::GetEncodedSize(
+    const MappingType *items, int size, bool skip_first_key) const {
+  int prefix_size = PrefixSize(items, size, skip_first_key);
+  int total = prefix_size + size * (SLOT_SIZE + sizeof(ValueType));
+  for (int i = (skip_first_key ? 1 : 0); i < size; i++) {
+    int trimmed = TrimmedSize(reinterpret_cast<const char *>(&items[i].first),
+                              sizeof(KeyType));
+    total += std::max(0, trimmed - prefix_size);
+  }
+  return total;
+}
+
+template <typename KeyType, typename ValueType>
+int BPlusTreeSlottedArea<KeyType, ValueType>::GetHighKeySize(
+    const KeyType &key) {
+  return TrimmedSize(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+}
+
+/*
+ * Longest prefix shared by every valid key, never longer than the longest
+ * trimmed key since bytes behind it are all zero anyway
+ */
+template <typename KeyType, typename ValueType>
+int BPlusTreeSlottedArea<KeyType, ValueType>::PrefixSize(
+    const MappingType *items, int size, bool skip_first_key) const {
+  int begin = skip_first_key ? 1 : 0;
+  if (begin >= size) {
+    return 0;
+  }
+  const char *first = reinterpret_cast<const char *>(&items[begin].first);
+  int prefix_size = sizeof(KeyType);
+  int longest = 0;
+  for (int i = begin; i < size; i++) {
+    const char *key = reinterpret_cast<const char *>(&items[i].first);
+    prefix_size = CommonPrefixSize(first, key, prefix_size);
+    longest = std::max(longest, TrimmedSize(key, sizeof(KeyType)));
+  }
+  return std::min(prefix_size, longest);
+}
+
+template <typename KeyType, typename ValueType>
+char *BPlusTreeSlottedArea<KeyType, ValueType>::SlotAt(int index) {
+  return data_ + prefix_size_ + high_key_size_ + index * SLOT_SIZE;
+}
+
+template <typename KeyType, typename ValueType>
+const char *BPlusTreeSlottedArea<KeyType, ValueType>::SlotAt(int index) const {
+  return data_ + prefix_size_ + high_key_size_ + index * SLOT_SIZE;
+}
+
+/*
+ * Upper bound of the keys of the area, only meaningful when the page has a
+ * right sibling
+ */
+template <typename KeyType, typename ValueType>
+KeyType BPlusTreeSlottedArea<KeyType, ValueType>::HighKey() const {
+  KeyType key;
+  char *key_data = reinterpret_cast<char *>(&key);
+  memcpy(key_data, data_ + prefix_size_, high_key_size_);
+  memset(key_data + high_key_size_, 0, sizeof(KeyType) - high_key_size_);
+  return key;
+}
+
+/*
+ * Helper method to rebuild the key stored at input "index", prefix and suffix
+ * are copied and the rest is filled with zero
+ */
+template <typename KeyType, typename ValueType>
+KeyType BPlusTreeSlottedArea<KeyType, ValueType>::KeyAt(int index) const {
+  KeyType key;
+  char *key_data = reinterpret_cast<char *>(&key);
+  uint16_t slot[2];
+  memcpy(slot, SlotAt(index), SLOT_SIZE);
+  memcpy(key_data, data_, prefix_size_);
+  memcpy(key_data + prefix_size_, data_ + slot[0] + sizeof(ValueType),
+         slot[1]);
+  memset(key_data + prefix_size_ + slot[1], 0,
+         sizeof(KeyType) - prefix_size_ - slot[1]);
+  return key;
+}
+
+template <typename KeyType, typename ValueType>
+ValueType BPlusTreeSlottedArea<KeyType, ValueType>::ValueAt(int index) const {
+  ValueType value;
+  uint16_t offset;
+  memcpy(&offset, SlotAt(index), sizeof(offset));
+  memcpy(reinterpret_cast<char *>(&value), data_ + offset, sizeof(ValueType));
+  return value;
+}
+
+template <typename KeyType, typename ValueType>
+void BPlusTreeSlottedArea<KeyType, ValueType>::SetValueAt(
+    int index, const ValueType &value) {
+  uint16_t offset;
+  memcpy(&offset, SlotAt(index), sizeof(offset));
+  memcpy(data_ + offset, reinterpret_cast<const char *>(&value),
+         sizeof(ValueType));
+}
+
+template <typename KeyType, typename ValueType>
+void BPlusTreeSlottedArea<KeyType, ValueType>::GetItems(
+    int size, std::vector<MappingType> &items) const {
+  items.clear();
+  items.reserve(size + 1);
+  for (int i = 0; i < size; i++) {
+    items.emplace_back(KeyAt(i), ValueAt(i));
+  }
+}
+
+/*
+ * Copy item into free space and point slot at input "index" to it, slots
+ * behind index must already be shifted
+ */
+template <typename KeyType, typename ValueType>
+void BPlusTreeSlottedArea<KeyType, ValueType>::WriteEntry(
+    int index, const MappingType &item, int suffix_size) {
+  free_space_pointer_ -= sizeof(ValueType) + suffix_size;
+  memcpy(data_ + free_space_pointer_,
+         reinterpret_cast<const char *>(&item.second), sizeof(ValueType));
+  memcpy(data_ + free_space_pointer_ + sizeof(ValueType),
+         reinterpret_cast<const char *>(&item.first) + prefix_size_,
+         suffix_size);
+  uint16_t slot[2] = {free_space_pointer_, static_cast<uint16_t>(suffix_size)};
+  memcpy(SlotAt(index), slot, SLOT_SIZE);
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert item at input "index" of an area holding size pairs. A key sharing
+ * the prefix goes to free space directly, otherwise the whole area is
+ * rebuilt around a shorter prefix.
+ * @return  false if item does not fit, area is left unchanged
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTreeSlottedArea<KeyType, ValueType>::InsertAt(
+    int size, int index, const MappingType &item, bool skip_first_key) {
+  const char *key = reinterpret_cast<const char *>(&item.first);
+  if (memcmp(key, data_, prefix_size_) == 0) {
+    int suffix_size =
+        std::max(0, TrimmedSize(key, sizeof(KeyType)) - prefix_size_);
+    if (GetUsedSize(size) + SLOT_SIZE + static_cast<int>(sizeof(ValueType)) +
+            suffix_size <= data_size_) {
+      char *slot = SlotAt(index);
+      memmove(slot + SLOT_SIZE, slot, (size - index) * SLOT_SIZE);
+      WriteEntry(index, item, suffix_size);
+      return true;
+    }
+  }
+
+  std::vector<MappingType> items;
+  GetItems(size, items);
+  items.insert(items.begin() + index, item);
+  return PopulateFrom(&items[0], size + 1, skip_first_key, HighKey());
+}
+
+/*
+ * Replace content of the area with items and high key, prefix is recomputed
+ * @return  false if items do not fit, area is left unchanged
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTreeSlottedArea<KeyType, ValueType>::PopulateFrom(
+    const MappingType *items, int size, bool skip_first_key,
+    const KeyType &high_key) {
+  int high_key_size = GetHighKeySize(high_key);
+  if (GetEncodedSize(items, size, skip_first_key) + high_key_size >
+      data_size_) {
+    return false;
+  }
+  int prefix_size = PrefixSize(items, size, skip_first_key);
+  memcpy(data_ + prefix_size, reinterpret_cast<const char *>(&high_key),
+          high_key_size);
+  if (prefix_size > 0) {
+    memcpy(data_, reinterpret_cast<const char *>(
+                      &items[skip_first_key ? 1 : 0].first),
+           prefix_size);
+  }
+  prefix_size_ = prefix_size;
+  high_key_size_ = high_key_size;
+  free_space_pointer_ = data_size_;
+  for (int i = 0; i < size; i++) {
+    int suffix_size = 0;
+    if (i > 0 || !skip_first_key) {
+      const char *key = reinterpret_cast<const char *>(&items[i].first);
+      suffix_size =
+          std::max(0, TrimmedSize(key, sizeof(KeyType)) - prefix_size_);
+    }
+    WriteEntry(i, items[i], suffix_size);
+  }
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Remove pair at input "index" and compact free space. Prefix is kept as it
+ * is, so the area shrinks by exactly one entry
+ */
+template <typename KeyType, typename ValueType>
+void BPlusTreeSlottedArea<KeyType, ValueType>::RemoveAt(int size, int index) {
+  uint16_t slot[2];
+  memcpy(slot, SlotAt(index), SLOT_SIZE);
+  int entry_size = sizeof(ValueType) + slot[1];
+
+  // entries stored below the removed one move up by its size
+  memmove(data_ + free_space_pointer_ + entry_size,
+          data_ + free_space_pointer_, slot[0] - free_space_pointer_);
+  free_space_pointer_ += entry_size;
+
+  char *removed = SlotAt(index);
+  memmove(removed, removed + SLOT_SIZE, (size - index - 1) * SLOT_SIZE);
+  for (int i = 0; i < size - 1; i++) {
+    uint16_t offset;
+    memcpy(&offset, SlotAt(i), sizeof(offset));
+    if (offset < slot[0]) {
+      offset += entry_size;
+      memcpy(SlotAt(i), &offset, sizeof(offset));
+    }
+  }
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+/*
+ * Whether items in [begin, end) fit into one area together with their high
+ * key: the first key of the next run, or input "high_key" for the last run.
+ * A separator pushed up in place of that key is never longer(see
+ * GenericComparator::ShortestSeparator()).
+ */
+template <typename KeyType, typename ValueType>
+bool BPlusTreeSlottedArea<KeyType, ValueType>::RunFits(
+    const std::vector<MappingType> &items, int begin, int end,
+    bool skip_first_key, const KeyType &high_key) const {
+  int total = static_cast<int>(items.size());
+  int high_key_size =
+      GetHighKeySize(end < total ? items[end].first : high_key);
+  return GetEncodedSize(&items[begin], end - begin, skip_first_key) +
+             high_key_size <= data_size_;
+}
+
+/*
+ * Cut sorted items into runs that each fit into one area, points receives
+ * the first index of every run but the first one, input "high_key" is the
+ * high key of the last run.
+ * Two runs of closest size are preferred, an internal run keeps at least two
+ * children. When no two runs fit(new key cut a long prefix short for most
+ * keys), runs are packed greedily, which never needs more than three.
+ */
+template <typename KeyType, typename ValueType>
+void BPlusTreeSlottedArea<KeyType, ValueType>::SplitPoints(
+    const std::vector<MappingType> &items, bool skip_first_key,
+    const KeyType &high_key, std::vector<int> &points) const {
+  int total = static_cast<int>(items.size());
+  int min_run = skip_first_key ? 2 : 1;
+  int best = -1;
+  int best_size = INT_MAX;
+  for (int i = min_run; i <= total - min_run; i++) {
+    if (!RunFits(items, 0, i, skip_first_key, high_key) ||
+        !RunFits(items, i, total, skip_first_key, high_key)) {
+      continue;
+    }
+    int left = GetEncodedSize(&items[0], i, skip_first_key);
+    int right = GetEncodedSize(&items[i], total - i, skip_first_key);
+    if (std::max(left, right) < best_size) {
+      best = i;
+      best_size = std::max(left, right);
+    }
+  }
+
+  points.clear();
+  if (best != -1) {
+    points.push_back(best);
+    return;
+  }
+  int begin = 0;
+  while (begin < total) {
+    int end = begin + 1;
+    while (end < total &&
+           RunFits(items, begin, end + 1, skip_first_key, high_key)) {
+      end++;
+    }
+    if (end < total) {
+      points.push_back(end);
+    }
+    begin = end;
+  }
+}
+
+template class BPlusTreeSlottedArea<GenericKey<4>, RID>;
+template class BPlusTreeSlottedArea<GenericKey<8>, RID>;
+template class BPlusTreeSlottedArea<GenericKey<16>, RID>;
+template class BPlusTreeSlottedArea<GenericKey<32>, RID>;
+template class BPlusTreeSlottedArea<GenericKey<64>, RID>;
+template class BPlusTreeSlottedArea<GenericKey<128>, RID>;
+template class BPlusTreeSlottedArea<GenericKey<256>, RID>;
+template class BPlusTreeSlottedArea<GenericKey<4>, page_id_t>;
+template class BPlusTreeSlottedArea<GenericKey<8>, page_id_t>;
+template class BPlusTreeSlottedArea<GenericKey<16>, page_id_t>;
+template class BPlusTreeSlottedArea<GenericKey<32>, page_id_t>;
+template class BPlusTreeSlottedArea<GenericKey<64>, page_id_t>;
+template class BPlusTreeSlottedArea<GenericKey<128>, page_id_t>;
+template class BPlusTreeSlottedArea<GenericKey<256>, page_id_t>;
+
+} // namespace cmudb
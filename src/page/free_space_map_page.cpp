@@ -0,0 +1,58 @@
+/**
+ * free_space_map_page.cpp
+ */
+
+#include <cassert>
+
+#include "page/free_space_map_page.h"
+
+namespace cmudb {
+
+/**
+ * Init method after creating a new map page
+ * Including set page id, next page id and set slot count to zero
+ */
+void FreeSpaceMapPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  next_page_id_ = INVALID_PAGE_ID;
+  slot_count_ = 0;
+}
+
+page_id_t FreeSpaceMapPage::GetPageId() const { return page_id_; }
+
+page_id_t FreeSpaceMapPage::GetNextPageId() const { return next_page_id_; }
+
+void FreeSpaceMapPage::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+int FreeSpaceMapPage::GetSlotCount() const { return slot_count_; }
+
+page_id_t FreeSpaceMapPage::GetHeapPageId(int slot) const {
+  assert(slot >= 0 && slot < slot_count_);
+  return heap_page_ids_[slot];
+}
+
+int FreeSpaceMapPage::GetBucket(int slot) const {
+  assert(slot >= 0 && slot < slot_count_);
+  return buckets_[slot];
+}
+
+void FreeSpaceMapPage::SetBucket(int slot, int bucket) {
+  assert(slot >= 0 && slot < slot_count_);
+  assert(bucket >= 0 && bucket <= UINT8_MAX);
+  buckets_[slot] = bucket;
+}
+
+bool FreeSpaceMapPage::Append(page_id_t heap_page_id, int bucket) {
+  if (slot_count_ == SLOT_COUNT) {
+    return false;
+  }
+  heap_page_ids_[slot_count_] = heap_page_id;
+  slot_count_++;
+  SetBucket(slot_count_ - 1, bucket);
+  return true;
+}
+
+} // namespace cmudb
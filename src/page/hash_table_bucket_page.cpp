@@ -0,0 +1,219 @@
+/**
+ * hash_table_bucket_page.cpp
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "common/rid.h"
+#include "index/generic_key.h"
+#include "page/hash_table_bucket_page.h"
+
+namespace cmudb {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+/**
+ * Init method after creating a new bucket page
+ * Including set page id, next page id and set current size to zero
+ */
+template <typename KeyType, typename ValueType>
+void HASH_TABLE_BUCKET_TYPE::Init(page_id_t page_id, page_id_t next_page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  next_page_id_ = next_page_id;
+  size_ = 0;
+  used_size_ = 0;
+}
+
+template <typename KeyType, typename ValueType>
+page_id_t HASH_TABLE_BUCKET_TYPE::GetPageId() const {
+  return page_id_;
+}
+
+/**
+ * Helper methods to set/get next page id of overflow chain
+ */
+template <typename KeyType, typename ValueType>
+page_id_t HASH_TABLE_BUCKET_TYPE::GetNextPageId() const {
+  return next_page_id_;
+}
+
+template <typename KeyType, typename ValueType>
+void HASH_TABLE_BUCKET_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+template <typename KeyType, typename ValueType>
+int HASH_TABLE_BUCKET_TYPE::GetSize() const {
+  return size_;
+}
+
+template <typename KeyType, typename ValueType>
+bool HASH_TABLE_BUCKET_TYPE::HasRoomFor(const KeyType &key) const {
+  return sizeof(HashTableBucketPage) + used_size_ + GetEntrySize(key) <=
+         PAGE_SIZE;
+}
+
+template <typename KeyType, typename ValueType>
+int HASH_TABLE_BUCKET_TYPE::GetEntrySize(const KeyType &key) {
+  return sizeof(ValueType) + sizeof(uint16_t) + KeySize(key);
+}
+
+/*
+ * Number of bytes of key up to its last non zero one
+ */
+template <typename KeyType, typename ValueType>
+int HASH_TABLE_BUCKET_TYPE::KeySize(const KeyType &key) {
+  int size = sizeof(KeyType);
+  const char *data = reinterpret_cast<const char *>(&key);
+  while (size > 0 && data[size - 1] == 0) {
+    size--;
+  }
+  return size;
+}
+
+template <typename KeyType, typename ValueType>
+bool HASH_TABLE_BUCKET_TYPE::KeyMatches(const char *entry, const KeyType &key,
+                                        int key_size) const {
+  uint16_t entry_key_size;
+  memcpy(&entry_key_size, entry + sizeof(ValueType), sizeof(uint16_t));
+  return entry_key_size == key_size &&
+         memcmp(entry + sizeof(ValueType) + sizeof(uint16_t), &key,
+                key_size) == 0;
+}
+
+template <typename KeyType, typename ValueType>
+const char *HASH_TABLE_BUCKET_TYPE::NextEntry(const char *entry) const {
+  uint16_t entry_key_size;
+  memcpy(&entry_key_size, entry + sizeof(ValueType), sizeof(uint16_t));
+  return entry + sizeof(ValueType) + sizeof(uint16_t) + entry_key_size;
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * Append every value stored with key to result
+ */
+template <typename KeyType, typename ValueType>
+int HASH_TABLE_BUCKET_TYPE::GetValue(const KeyType &key,
+                                     std::vector<ValueType> &result) const {
+  int key_size = KeySize(key);
+  int found = 0;
+  const char *entry = data_;
+  for (int i = 0; i < size_; i++, entry = NextEntry(entry)) {
+    if (KeyMatches(entry, key, key_size)) {
+      ValueType value;
+      memcpy(&value, entry, sizeof(ValueType));
+      result.push_back(value);
+      found++;
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType>
+bool HASH_TABLE_BUCKET_TYPE::Contains(const KeyType &key) const {
+  int key_size = KeySize(key);
+  const char *entry = data_;
+  for (int i = 0; i < size_; i++, entry = NextEntry(entry)) {
+    if (KeyMatches(entry, key, key_size)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType>
+bool HASH_TABLE_BUCKET_TYPE::Contains(const KeyType &key,
+                                      const ValueType &value) const {
+  int key_size = KeySize(key);
+  const char *entry = data_;
+  for (int i = 0; i < size_; i++, entry = NextEntry(entry)) {
+    if (KeyMatches(entry, key, key_size) &&
+        memcmp(entry, &value, sizeof(ValueType)) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Copy every pair of the page out, keys are zero filled again
+ */
+template <typename KeyType, typename ValueType>
+void HASH_TABLE_BUCKET_TYPE::GetItems(std::vector<MappingType> &items) const {
+  const char *entry = data_;
+  for (int i = 0; i < size_; i++, entry = NextEntry(entry)) {
+    MappingType item;
+    uint16_t key_size;
+    memcpy(&item.second, entry, sizeof(ValueType));
+    memcpy(&key_size, entry + sizeof(ValueType), sizeof(uint16_t));
+    memset(&item.first, 0, sizeof(KeyType));
+    memcpy(&item.first, entry + sizeof(ValueType) + sizeof(uint16_t),
+           key_size);
+    items.push_back(item);
+  }
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Append key & value pair behind the last entry, caller checks for duplicates
+ * @return  false if page has no room left for it
+ */
+template <typename KeyType, typename ValueType>
+bool HASH_TABLE_BUCKET_TYPE::Insert(const KeyType &key,
+                                    const ValueType &value) {
+  if (!HasRoomFor(key)) {
+    return false;
+  }
+  uint16_t key_size = KeySize(key);
+  char *entry = data_ + used_size_;
+  memcpy(entry, &value, sizeof(ValueType));
+  memcpy(entry + sizeof(ValueType), &key_size, sizeof(uint16_t));
+  memcpy(entry + sizeof(ValueType) + sizeof(uint16_t), &key, key_size);
+  used_size_ += GetEntrySize(key);
+  size_++;
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete key & value pair, entries behind it move forward
+ * @return  false if pair is not stored in this page
+ */
+template <typename KeyType, typename ValueType>
+bool HASH_TABLE_BUCKET_TYPE::Remove(const KeyType &key,
+                                    const ValueType &value) {
+  int key_size = KeySize(key);
+  char *entry = data_;
+  for (int i = 0; i < size_; i++) {
+    char *next = const_cast<char *>(NextEntry(entry));
+    if (KeyMatches(entry, key, key_size) &&
+        memcmp(entry, &value, sizeof(ValueType)) == 0) {
+      memmove(entry, next, data_ + used_size_ - next);
+      used_size_ -= next - entry;
+      size_--;
+      return true;
+    }
+    entry = next;
+  }
+  return false;
+}
+
+template class HashTableBucketPage<GenericKey<4>, RID>;
+template class HashTableBucketPage<GenericKey<8>, RID>;
+template class HashTableBucketPage<GenericKey<16>, RID>;
+template class HashTableBucketPage<GenericKey<32>, RID>;
+template class HashTableBucketPage<GenericKey<64>, RID>;
+template class HashTableBucketPage<GenericKey<128>, RID>;
+template class HashTableBucketPage<GenericKey<256>, RID>;
+
+} // namespace cmudb
@@ -0,0 +1,102 @@
+/**
+ * hash_table_directory_page.cpp
+ */
+
+#include <cassert>
+
+#include "page/hash_table_directory_page.h"
+
+namespace cmudb {
+
+/*****************************************************************************
+ * SEGMENT PAGE
+ *****************************************************************************/
+/**
+ * Init method after creating a new segment page
+ * Every slot points to no bucket until the directory grows into it
+ */
+void HashTableSegmentPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  for (int i = 0; i < SLOT_COUNT; i++) {
+    local_depths_[i] = 0;
+    bucket_page_ids_[i] = INVALID_PAGE_ID;
+  }
+}
+
+page_id_t HashTableSegmentPage::GetPageId() const { return page_id_; }
+
+page_id_t HashTableSegmentPage::GetBucketPageId(int slot) const {
+  assert(slot >= 0 && slot < SLOT_COUNT);
+  return bucket_page_ids_[slot];
+}
+
+void HashTableSegmentPage::SetBucketPageId(int slot,
+                                           page_id_t bucket_page_id) {
+  assert(slot >= 0 && slot < SLOT_COUNT);
+  bucket_page_ids_[slot] = bucket_page_id;
+}
+
+int HashTableSegmentPage::GetLocalDepth(int slot) const {
+  assert(slot >= 0 && slot < SLOT_COUNT);
+  return local_depths_[slot];
+}
+
+void HashTableSegmentPage::SetLocalDepth(int slot, int local_depth) {
+  assert(slot >= 0 && slot < SLOT_COUNT);
+  local_depths_[slot] = local_depth;
+}
+
+/*****************************************************************************
+ * DIRECTORY PAGE
+ *****************************************************************************/
+/**
+ * Init method after creating a new directory page
+ * Including set page id, global depth and segment count to zero
+ */
+void HashTableDirectoryPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  global_depth_ = 0;
+  segment_count_ = 0;
+}
+
+page_id_t HashTableDirectoryPage::GetPageId() const { return page_id_; }
+
+int HashTableDirectoryPage::GetGlobalDepth() const { return global_depth_; }
+
+void HashTableDirectoryPage::SetGlobalDepth(int global_depth) {
+  assert(global_depth >= 0 && global_depth <= GetMaxGlobalDepth());
+  global_depth_ = global_depth;
+}
+
+int HashTableDirectoryPage::GetMaxGlobalDepth() {
+  int depth = 0;
+  while ((2 << depth) <= MAX_SEGMENT_COUNT * HashTableSegmentPage::SLOT_COUNT) {
+    depth++;
+  }
+  return depth;
+}
+
+uint32_t HashTableDirectoryPage::GetSlotIndex(uint32_t hash) const {
+  return hash & ((1u << global_depth_) - 1);
+}
+
+int HashTableDirectoryPage::GetSegmentCount() const { return segment_count_; }
+
+page_id_t HashTableDirectoryPage::GetSegmentPageId(int segment) const {
+  assert(segment >= 0 && segment < segment_count_);
+  return segment_page_ids_[segment];
+}
+
+void HashTableDirectoryPage::PushSegment(page_id_t segment_page_id) {
+  assert(segment_count_ < MAX_SEGMENT_COUNT);
+  segment_page_ids_[segment_count_++] = segment_page_id;
+}
+
+page_id_t HashTableDirectoryPage::PopSegment() {
+  assert(segment_count_ > 0);
+  return segment_page_ids_[--segment_count_];
+}
+
+} // namespace cmudb
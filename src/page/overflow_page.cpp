@@ -0,0 +1,45 @@
+/**
+ * overflow_page.cpp
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "page/overflow_page.h"
+
+namespace cmudb {
+
+/**
+ * Init method after creating a new overflow page
+ * Including set page id, next page id and set current size to zero
+ */
+void OverflowPage::Init(page_id_t page_id, page_id_t next_page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  next_page_id_ = next_page_id;
+  size_ = 0;
+}
+
+page_id_t OverflowPage::GetPageId() const { return page_id_; }
+
+page_id_t OverflowPage::GetNextPageId() const { return next_page_id_; }
+
+void OverflowPage::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+int OverflowPage::GetSize() const { return size_; }
+
+int OverflowPage::GetMaxSize() {
+  return PAGE_SIZE - static_cast<int>(sizeof(OverflowPage));
+}
+
+const char *OverflowPage::GetData() const { return data_; }
+
+int OverflowPage::Write(const char *data, int size) {
+  size_ = std::min(size, GetMaxSize());
+  memcpy(data_, data, size_);
+  return size_;
+}
+
+} // namespace cmudb
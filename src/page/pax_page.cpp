@@ -0,0 +1,455 @@
+/**
+ * pax_page.cpp
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "page/pax_page.h"
+
+namespace cmudb {
+/**
+ * Header related
+ */
+void PaxPage::Init(page_id_t page_id, page_id_t prev_page_id,
+                   Schema *schema) {
+  int capacity = GetCapacity(schema);
+  assert(capacity > 0);
+  memcpy(GetData(), &page_id, 4);
+  SetPrevPageId(prev_page_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  memcpy(GetData() + 16, &capacity, 4);
+  SetTupleCount(0);
+  int word_count = (capacity + 63) / 64;
+  memset(GetUsedBitmap(), 0, 8 * word_count);
+  memset(GetDeletedBitmap(), 0, 8 * word_count);
+}
+
+page_id_t PaxPage::GetPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData());
+}
+
+page_id_t PaxPage::GetPrevPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData() + 8);
+}
+
+page_id_t PaxPage::GetNextPageId() {
+  return *reinterpret_cast<page_id_t *>(GetData() + 12);
+}
+
+void PaxPage::SetPrevPageId(page_id_t prev_page_id) {
+  memcpy(GetData() + 8, &prev_page_id, 4);
+}
+
+void PaxPage::SetNextPageId(page_id_t next_page_id) {
+  memcpy(GetData() + 12, &next_page_id, 4);
+}
+
+int32_t PaxPage::GetRowSize(Schema *schema) {
+  int32_t size = 0;
+  for (int i = 0; i < schema->GetColumnCount(); i++)
+    size += GetSlotSize(schema, i);
+  return size;
+}
+
+/*
+ * Each slot takes a row and a bit of both bitmaps
+ */
+int PaxPage::GetCapacity(Schema *schema) {
+  int32_t row_size = GetRowSize(schema);
+  int capacity = (PAGE_SIZE - HEADER_SIZE) / row_size;
+  while (capacity > 0 &&
+         HEADER_SIZE + 16 * ((capacity + 63) / 64) + capacity * row_size >
+             PAGE_SIZE)
+    capacity--;
+  return capacity;
+}
+
+bool PaxPage::IsStorable(Schema *schema, const Tuple &tuple) {
+  TupleView view(tuple);
+  for (auto &i : schema->GetUnlinedColumns()) {
+    uint32_t len =
+        *reinterpret_cast<const uint32_t *>(view.GetDataPtr(schema, i));
+    if (len != PELOTON_VALUE_NULL &&
+        sizeof(uint32_t) + len > static_cast<uint32_t>(GetSlotSize(schema, i)))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Tuple related
+ */
+bool PaxPage::InsertTuple(Schema *schema, const Tuple &tuple, RID &rid,
+                          Transaction *txn, LockManager *lock_manager) {
+  assert(IsStorable(schema, tuple));
+  int capacity = GetCapacityField();
+  if (GetTupleCount() == capacity)
+    return false;
+  uint64_t *used = GetUsedBitmap();
+  int i = 0;
+  while (used[i / 64] == UINT64_MAX)
+    i += 64;
+  i += __builtin_ctzll(~used[i / 64]);
+  assert(i < capacity);
+
+  Scatter(schema, GetMinipages(schema), tuple, i);
+  used[i / 64] |= 1ULL << (i % 64);
+  SetTupleCount(GetTupleCount() + 1);
+  rid.Set(GetPageId(), i);
+  if (ENABLE_LOGGING) {
+    // acquire the exclusive lock
+    assert(lock_manager->LockExclusive(txn, rid.Get()));
+  }
+  return true;
+}
+
+bool PaxPage::MarkDelete(const RID &rid, Transaction *txn,
+                         LockManager *lock_manager) {
+  int slot_num = rid.GetSlotNum();
+  if (slot_num >= GetCapacityField() || !IsVisible(slot_num)) {
+    if (ENABLE_LOGGING) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  if (ENABLE_LOGGING) {
+    // acquire exclusive lock
+    // if has shared lock
+    if (txn->GetSharedLockSet()->find(rid) != txn->GetSharedLockSet()->end()) {
+      if (!lock_manager->LockUpgrade(txn, rid))
+        return false;
+    } else if (txn->GetExclusiveLockSet()->find(rid) ==
+                   txn->GetExclusiveLockSet()->end() &&
+               !lock_manager->LockExclusive(txn, rid)) { // no shared lock
+      return false;
+    }
+  }
+  GetDeletedBitmap()[slot_num / 64] |= 1ULL << (slot_num % 64);
+  return true;
+}
+
+/*
+ * Row takes as many bytes whatever its values are, so update is in place
+ */
+bool PaxPage::UpdateTuple(Schema *schema, const Tuple &new_tuple,
+                          Tuple &old_tuple, const RID &rid, Transaction *txn,
+                          LockManager *lock_manager) {
+  assert(IsStorable(schema, new_tuple));
+  int slot_num = rid.GetSlotNum();
+  if (slot_num >= GetCapacityField() || !IsVisible(slot_num)) {
+    if (ENABLE_LOGGING) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  // copy out old value
+  std::vector<char *> minipages = GetMinipages(schema);
+  std::vector<bool> is_read(schema->GetColumnCount(), true);
+  old_tuple.size_ = GetGatherSize(schema, minipages, is_read, slot_num);
+  if (old_tuple.allocated_)
+    delete[] old_tuple.data_;
+  old_tuple.data_ = new char[old_tuple.size_];
+  Gather(schema, minipages, is_read, slot_num, old_tuple.data_);
+  old_tuple.rid_ = rid;
+  old_tuple.allocated_ = true;
+
+  if (ENABLE_LOGGING) {
+    // acquire exclusive lock
+    // if has shared lock
+    if (txn->GetSharedLockSet()->find(rid) != txn->GetSharedLockSet()->end()) {
+      if (!lock_manager->LockUpgrade(txn, rid))
+        return false;
+    } else if (txn->GetExclusiveLockSet()->find(rid) ==
+                   txn->GetExclusiveLockSet()->end() &&
+               !lock_manager->LockExclusive(txn, rid)) { // no shared lock
+      return false;
+    }
+  }
+  Scatter(schema, minipages, new_tuple, slot_num);
+  return true;
+}
+
+void PaxPage::ApplyDelete(const RID &rid, Transaction *txn) {
+  int slot_num = rid.GetSlotNum();
+  assert(slot_num < GetCapacityField());
+  assert(GetUsedBitmap()[slot_num / 64] & (1ULL << (slot_num % 64)));
+  if (ENABLE_LOGGING) {
+    // must already grab the exclusive lock
+    assert(txn->GetExclusiveLockSet()->find(rid) !=
+           txn->GetExclusiveLockSet()->end());
+  }
+  GetUsedBitmap()[slot_num / 64] &= ~(1ULL << (slot_num % 64));
+  GetDeletedBitmap()[slot_num / 64] &= ~(1ULL << (slot_num % 64));
+  SetTupleCount(GetTupleCount() - 1);
+}
+
+void PaxPage::RollbackDelete(const RID &rid, Transaction *txn) {
+  int slot_num = rid.GetSlotNum();
+  assert(slot_num < GetCapacityField());
+  GetDeletedBitmap()[slot_num / 64] &= ~(1ULL << (slot_num % 64));
+}
+
+bool PaxPage::GetTuple(Schema *schema, const RID &rid, Tuple &tuple,
+                       Transaction *txn, LockManager *lock_manager) {
+  int slot_num = rid.GetSlotNum();
+  if (slot_num >= GetCapacityField() || !IsVisible(slot_num)) {
+    if (ENABLE_LOGGING)
+      txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+
+  if (ENABLE_LOGGING) {
+    // acquire shared lock
+    if (txn->GetExclusiveLockSet()->find(rid) ==
+            txn->GetExclusiveLockSet()->end() &&
+        txn->GetSharedLockSet()->find(rid) == txn->GetSharedLockSet()->end() &&
+        !lock_manager->LockShared(txn, rid)) {
+      return false;
+    }
+  }
+
+  std::vector<char *> minipages = GetMinipages(schema);
+  std::vector<bool> is_read(schema->GetColumnCount(), true);
+  tuple.size_ = GetGatherSize(schema, minipages, is_read, slot_num);
+  if (tuple.allocated_)
+    delete[] tuple.data_;
+  tuple.data_ = new char[tuple.size_];
+  Gather(schema, minipages, is_read, slot_num, tuple.data_);
+  tuple.rid_ = rid;
+  tuple.allocated_ = true;
+  return true;
+}
+
+/*
+ * Shared locks are taken as GetTuple() does. Sizes come first, so that
+ * buffer is resized once before views into it are taken
+ */
+void PaxPage::GetTuples(Schema *schema, const std::vector<int> &column_ids,
+                        std::vector<char> &buffer,
+                        std::vector<TupleView> &tuples, Transaction *txn,
+                        LockManager *lock_manager) {
+  std::vector<bool> is_read(schema->GetColumnCount(), column_ids.empty());
+  for (auto &i : column_ids)
+    is_read[i] = true;
+  std::vector<char *> minipages = GetMinipages(schema);
+  std::vector<std::pair<int, int32_t>> slots; // slot, tuple size
+  int32_t total_size = 0;
+  int capacity = GetCapacityField();
+  for (int i = GetNextVisibleSlot(0); i < capacity;
+       i = GetNextVisibleSlot(i + 1)) {
+    RID rid(GetPageId(), i);
+    if (ENABLE_LOGGING) {
+      if (txn->GetExclusiveLockSet()->find(rid) ==
+              txn->GetExclusiveLockSet()->end() &&
+          txn->GetSharedLockSet()->find(rid) ==
+              txn->GetSharedLockSet()->end() &&
+          !lock_manager->LockShared(txn, rid)) {
+        continue;
+      }
+    }
+    int32_t tuple_size = GetGatherSize(schema, minipages, is_read, i);
+    slots.emplace_back(i, tuple_size);
+    total_size += tuple_size;
+  }
+  if (buffer.size() < static_cast<size_t>(total_size))
+    buffer.resize(total_size);
+  int32_t offset = 0;
+  for (auto &slot : slots) {
+    Gather(schema, minipages, is_read, slot.first, buffer.data() + offset);
+    tuples.emplace_back(RID(GetPageId(), slot.first), buffer.data() + offset,
+                        slot.second);
+    offset += slot.second;
+  }
+}
+
+int32_t PaxPage::GetMaxInsertSize() {
+  return GetTupleCount() < GetCapacityField() ? PAGE_SIZE : 0;
+}
+
+/**
+ * Tuple iterator
+ */
+bool PaxPage::GetFirstTupleRid(RID &first_rid) {
+  int i = GetNextVisibleSlot(0);
+  if (i < GetCapacityField()) {
+    first_rid.Set(GetPageId(), i);
+    return true;
+  }
+  // there is no tuple within current page
+  first_rid.Set(INVALID_PAGE_ID, -1);
+  return false;
+}
+
+bool PaxPage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) {
+  assert(cur_rid.GetPageId() == GetPageId());
+  int i = GetNextVisibleSlot(cur_rid.GetSlotNum() + 1);
+  if (i < GetCapacityField()) {
+    next_rid.Set(GetPageId(), i);
+    return true;
+  }
+  return false; // End of last tuple
+}
+
+/**
+ * helper functions
+ */
+// a varchar slot holds length, declared number of characters and terminator
+int32_t PaxPage::GetSlotSize(Schema *schema, int column_id) {
+  if (schema->IsInlined(column_id))
+    return schema->GetLength(column_id);
+  return sizeof(uint32_t) + schema->GetVariableLength(column_id) + 1;
+}
+
+int32_t PaxPage::GetCapacityField() {
+  return *reinterpret_cast<int32_t *>(GetData() + 16);
+}
+
+int32_t PaxPage::GetTupleCount() {
+  return *reinterpret_cast<int32_t *>(GetData() + 20);
+}
+
+void PaxPage::SetTupleCount(int32_t tuple_count) {
+  memcpy(GetData() + 20, &tuple_count, 4);
+}
+
+uint64_t *PaxPage::GetUsedBitmap() {
+  return reinterpret_cast<uint64_t *>(GetData() + HEADER_SIZE);
+}
+
+uint64_t *PaxPage::GetDeletedBitmap() {
+  return GetUsedBitmap() + (GetCapacityField() + 63) / 64;
+}
+
+bool PaxPage::IsVisible(int slot_num) {
+  uint64_t bit = 1ULL << (slot_num % 64);
+  return (GetUsedBitmap()[slot_num / 64] & bit) != 0 &&
+         (GetDeletedBitmap()[slot_num / 64] & bit) == 0;
+}
+
+int PaxPage::GetNextVisibleSlot(int slot_num) {
+  int capacity = GetCapacityField();
+  if (slot_num >= capacity)
+    return capacity;
+  uint64_t *used = GetUsedBitmap();
+  uint64_t *deleted = GetDeletedBitmap();
+  int word = slot_num / 64;
+  // bits of slots before slot_num are masked off
+  uint64_t bits = used[word] & ~deleted[word] & (UINT64_MAX << (slot_num % 64));
+  while (bits == 0) {
+    if (++word * 64 >= capacity)
+      return capacity;
+    bits = used[word] & ~deleted[word];
+  }
+  return std::min(capacity, word * 64 + __builtin_ctzll(bits));
+}
+
+std::vector<char *> PaxPage::GetMinipages(Schema *schema) {
+  int capacity = GetCapacityField();
+  std::vector<char *> minipages;
+  char *minipage = GetData() + HEADER_SIZE + 16 * ((capacity + 63) / 64);
+  for (int i = 0; i < schema->GetColumnCount(); i++) {
+    minipages.push_back(minipage);
+    minipage += capacity * GetSlotSize(schema, i);
+  }
+  return minipages;
+}
+
+void PaxPage::Scatter(Schema *schema, const std::vector<char *> &minipages,
+                      const Tuple &tuple, int slot_num) {
+  TupleView view(tuple);
+  for (int i = 0; i < schema->GetColumnCount(); i++) {
+    int32_t slot_size = GetSlotSize(schema, i);
+    char *slot = minipages[i] + slot_num * slot_size;
+    const char *data_ptr = view.GetDataPtr(schema, i);
+    if (schema->IsInlined(i)) {
+      memcpy(slot, data_ptr, slot_size);
+    } else {
+      uint32_t len = *reinterpret_cast<const uint32_t *>(data_ptr);
+      memcpy(slot, data_ptr,
+             sizeof(uint32_t) + (len == PELOTON_VALUE_NULL ? 0 : len));
+    }
+  }
+}
+
+int32_t PaxPage::GetGatherSize(Schema *schema,
+                               const std::vector<char *> &minipages,
+                               const std::vector<bool> &is_read,
+                               int slot_num) {
+  int32_t size = schema->GetLength();
+  for (auto &i : schema->GetUnlinedColumns()) {
+    size += sizeof(uint32_t);
+    if (!is_read[i])
+      continue;
+    uint32_t len = *reinterpret_cast<uint32_t *>(
+        minipages[i] + slot_num * GetSlotSize(schema, i));
+    if (len != PELOTON_VALUE_NULL)
+      size += len;
+  }
+  return size;
+}
+
+/*
+ * Columns not read are null
+ */
+void PaxPage::Gather(Schema *schema, const std::vector<char *> &minipages,
+                     const std::vector<bool> &is_read, int slot_num,
+                     char *data) {
+  int32_t offset = schema->GetLength();
+  for (int i = 0; i < schema->GetColumnCount(); i++) {
+    int32_t slot_size = GetSlotSize(schema, i);
+    const char *slot = minipages[i] + slot_num * slot_size;
+    char *column = data + schema->GetOffset(i);
+    if (schema->IsInlined(i)) {
+      if (is_read[i])
+        memcpy(column, slot, slot_size);
+      else
+        SetNull(schema->GetType(i), column);
+      continue;
+    }
+    *reinterpret_cast<int32_t *>(column) = offset;
+    uint32_t len = is_read[i] ? *reinterpret_cast<const uint32_t *>(slot)
+                              : PELOTON_VALUE_NULL;
+    if (len == PELOTON_VALUE_NULL) {
+      *reinterpret_cast<uint32_t *>(data + offset) = PELOTON_VALUE_NULL;
+      offset += sizeof(uint32_t);
+    } else {
+      memcpy(data + offset, slot, sizeof(uint32_t) + len);
+      offset += sizeof(uint32_t) + len;
+    }
+  }
+}
+
+// serialized null value of an inlined type
+void PaxPage::SetNull(TypeId type, char *column) {
+  switch (type) {
+  case TypeId::BOOLEAN:
+    *reinterpret_cast<int8_t *>(column) = PELOTON_BOOLEAN_NULL;
+    break;
+  case TypeId::TINYINT:
+    *reinterpret_cast<int8_t *>(column) = PELOTON_INT8_NULL;
+    break;
+  case TypeId::SMALLINT:
+    *reinterpret_cast<int16_t *>(column) = PELOTON_INT16_NULL;
+    break;
+  case TypeId::INTEGER:
+    *reinterpret_cast<int32_t *>(column) = PELOTON_INT32_NULL;
+    break;
+  case TypeId::BIGINT:
+    *reinterpret_cast<int64_t *>(column) = PELOTON_INT64_NULL;
+    break;
+  case TypeId::DECIMAL:
+    *reinterpret_cast<double *>(column) = PELOTON_DECIMAL_NULL;
+    break;
+  case TypeId::TIMESTAMP:
+    *reinterpret_cast<uint64_t *>(column) = PELOTON_TIMESTAMP_NULL;
+    break;
+  default:
+    break;
+  }
+}
+
+} // namespace cmudb
@@ -2,7 +2,11 @@
  * header_page.cpp
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <vector>
 
 #include "page/table_page.h"
 
@@ -26,6 +30,7 @@ void TablePage::Init(page_id_t page_id, size_t page_size,
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(page_size);
   SetTupleCount(0);
+  memset(GetSlotBitmap(), 0, 8 * BITMAP_WORD_COUNT);
 }
 
 page_id_t TablePage::GetPageId() {
@@ -55,29 +60,24 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
                             LockManager *lock_manager,
                             LogManager *log_manager) {
   assert(tuple.size_ > 0);
-  int32_t freeSize = GetFreeSpaceSize();
-  if (freeSize < tuple.size_) {
-    return false; // not enough space
-  }
-
   // try to reuse a free slot first
-  int i;
-  for (i = 0; i < GetTupleCount(); ++i) {
+  int i = GetFreeSlot();
+  if (i < GetTupleCount()) {
     rid.Set(GetPageId(), i);
-    if (GetTupleSize(i) == 0) { // empty slot
-      if (ENABLE_LOGGING) {
-        assert(txn->GetSharedLockSet()->find(rid) ==
-                   txn->GetSharedLockSet()->end() &&
-               txn->GetExclusiveLockSet()->find(rid) ==
-                   txn->GetExclusiveLockSet()->end());
-      }
-      break;
+    if (ENABLE_LOGGING) {
+      assert(txn->GetSharedLockSet()->find(rid) ==
+                 txn->GetSharedLockSet()->end() &&
+             txn->GetExclusiveLockSet()->find(rid) ==
+                 txn->GetExclusiveLockSet()->end());
     }
   }
 
-  // no free slot left
-  if (i == GetTupleCount() && GetFreeSpaceSize() < tuple.size_ + 8) {
-    return false; // not enough space
+  // no free slot left, a new one takes 8 bytes more
+  int32_t needed = tuple.size_ + (i == GetTupleCount() ? 8 : 0);
+  if (GetFreeSpaceSize() < needed) {
+    if (GetFreeSpaceSize() + GetFragmentedSize() < needed)
+      return false; // not enough space
+    PackTuples();
   }
 
   SetFreeSpacePointer(GetFreeSpacePointer() -
@@ -182,7 +182,8 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
     }
     return false;
   }
-  if (GetFreeSpaceSize() < new_tuple.size_ - tuple_size) {
+  if (GetFreeSpaceSize() + GetFragmentedSize() <
+      new_tuple.size_ - tuple_size) {
     // should delete/insert because not enough space
     return false;
   }
@@ -217,24 +218,19 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
     SetLSN(lsn);
   }
 
-  // update
-  int32_t free_space_pointer =
-      GetFreeSpacePointer(); // old pointer to the free space
-  assert(tuple_offset >= free_space_pointer);
-  memmove(GetData() + free_space_pointer + tuple_size - new_tuple.size_,
-          GetData() + free_space_pointer, tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size - new_tuple.size_);
-  memcpy(GetData() + tuple_offset + tuple_size - new_tuple.size_,
-         new_tuple.data_,
-         new_tuple.size_);                 // copy new tuple
-  SetTupleSize(slot_num, new_tuple.size_); // update tuple size in slot
-  for (int i = 0; i < GetTupleCount();
-       ++i) { // update tuple offsets (including the updated one)
-    int32_t tuple_offset_i = GetTupleOffset(i);
-    if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffset(i, tuple_offset_i + tuple_size - new_tuple.size_);
+  // update, a shrinking tuple stays where it is and leaves a hole behind,
+  // a growing one moves to free space and leaves its old place as a hole
+  if (new_tuple.size_ > tuple_size) {
+    if (GetFreeSpaceSize() < new_tuple.size_) {
+      SetTupleSize(slot_num, 0); // old tuple is copied out already
+      PackTuples();
     }
+    SetFreeSpacePointer(GetFreeSpacePointer() - new_tuple.size_);
+    tuple_offset = GetFreeSpacePointer();
+    SetTupleOffset(slot_num, tuple_offset);
   }
+  memcpy(GetData() + tuple_offset, new_tuple.data_, new_tuple.size_);
+  SetTupleSize(slot_num, new_tuple.size_); // update tuple size in slot
   return true;
 }
 
@@ -244,7 +240,7 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
  * This function is called when a transaction commits or when you undo insert
  */
 void TablePage::ApplyDelete(const RID &rid, Transaction *txn,
-                            LogManager *log_manager) {
+                            LogManager *log_manager, Tuple *deleted_tuple) {
   int slot_num = rid.GetSlotNum();
   assert(slot_num < GetTupleCount());
   // the tuple offset of the deleted tuple
@@ -261,6 +257,8 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn,
   memcpy(delete_tuple.data_, GetData() + tuple_offset, delete_tuple.size_);
   delete_tuple.rid_ = rid;
   delete_tuple.allocated_ = true;
+  if (deleted_tuple != nullptr)
+    *deleted_tuple = delete_tuple;
 
   if (ENABLE_LOGGING) {
     // must already grab the exclusive lock
@@ -275,20 +273,9 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn,
     SetLSN(lsn);
   }
 
-  int32_t free_space_pointer =
-      GetFreeSpacePointer(); // old pointer to the free space
-  assert(tuple_offset >= free_space_pointer);
-  memmove(GetData() + free_space_pointer + tuple_size,
-          GetData() + free_space_pointer, tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
+  // tuple leaves a hole, which is packed away once free space runs short
   SetTupleSize(slot_num, 0);
   SetTupleOffset(slot_num, 0); // invalid offset
-  for (int i = 0; i < GetTupleCount(); ++i) {
-    int32_t tuple_offset_i = GetTupleOffset(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffset(i, tuple_offset_i + tuple_size);
-    }
-  }
 }
 
 /*
@@ -357,11 +344,72 @@ bool TablePage::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
   return true;
 }
 
+/*
+ * One copy of tuple area instead of one per tuple. Locks are left to
+ * LockTuples(), so that a scan locks only tuples it keeps
+ */
+void TablePage::GetTuples(char *buffer, std::vector<TupleView> &tuples) {
+  int32_t free_space_pointer = GetFreeSpacePointer();
+  memcpy(buffer + free_space_pointer, GetData() + free_space_pointer,
+         PAGE_SIZE - free_space_pointer);
+  for (int i = GetNextUsedSlot(0); i < GetTupleCount();
+       i = GetNextUsedSlot(i + 1)) {
+    int32_t tuple_size = GetTupleSize(i);
+    if (tuple_size <= 0)
+      continue;
+    tuples.emplace_back(RID(GetPageId(), i), buffer + GetTupleOffset(i),
+                        tuple_size);
+  }
+}
+
+void TablePage::LockTuples(std::vector<TupleView> &tuples, Transaction *txn,
+                           LockManager *lock_manager) {
+  if (!ENABLE_LOGGING)
+    return;
+  size_t count = 0;
+  for (size_t i = 0; i < tuples.size(); i++) {
+    RID rid = tuples[i].GetRid();
+    if (txn->GetExclusiveLockSet()->find(rid) !=
+            txn->GetExclusiveLockSet()->end() ||
+        txn->GetSharedLockSet()->find(rid) != txn->GetSharedLockSet()->end() ||
+        lock_manager->LockShared(txn, rid))
+      tuples[count++] = tuples[i];
+  }
+  tuples.resize(count);
+}
+
+/**
+ * Compaction
+ */
+/*
+ * Pack tuples and drop empty slots at the end of slot array. Slot numbers of
+ * the others stay, so no RID changes. Page layout is all that changes, and it
+ * is not logged.
+ */
+void TablePage::Compact() {
+  int32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0)
+    tuple_count--;
+  SetTupleCount(tuple_count);
+  PackTuples();
+}
+
+/*
+ * Bytes of holes between tuples, left by deletes and updates
+ */
+int32_t TablePage::GetFragmentedSize() {
+  int32_t used = PAGE_SIZE - GetFreeSpacePointer();
+  for (int i = 0; i < GetTupleCount(); ++i)
+    used -= std::abs(GetTupleSize(i));
+  return used;
+}
+
 /**
  * Tuple iterator
  */
 bool TablePage::GetFirstTupleRid(RID &first_rid) {
-  for (int i = 0; i < GetTupleCount(); ++i) {
+  for (int i = GetNextUsedSlot(0); i < GetTupleCount();
+       i = GetNextUsedSlot(i + 1)) {
     if (GetTupleSize(i) > 0) { // valid tuple
       first_rid.Set(GetPageId(), i);
       return true;
@@ -374,7 +422,8 @@ bool TablePage::GetFirstTupleRid(RID &first_rid) {
 
 bool TablePage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) {
   assert(cur_rid.GetPageId() == GetPageId());
-  for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
+  for (int i = GetNextUsedSlot(cur_rid.GetSlotNum() + 1); i < GetTupleCount();
+       i = GetNextUsedSlot(i + 1)) {
     if (GetTupleSize(i) > 0) { // valid tuple
       next_rid.Set(GetPageId(), i);
       return true;
@@ -386,22 +435,85 @@ bool TablePage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) {
 /**
  * helper functions
  */
+/*
+ * Move tuples(including deleted ones not applied yet) next to each other at
+ * the end of page, holes join free space. Tuples move in order of offset from
+ * the end of page, so each one moves toward the end, over holes only.
+ */
+void TablePage::PackTuples() {
+  std::vector<std::pair<int32_t, int>> tuples; // offset, slot
+  for (int i = 0; i < GetTupleCount(); ++i) {
+    if (GetTupleSize(i) != 0)
+      tuples.emplace_back(GetTupleOffset(i), i);
+  }
+  std::sort(tuples.begin(), tuples.end(),
+            std::greater<std::pair<int32_t, int>>());
+  int32_t free_space_pointer = PAGE_SIZE;
+  for (auto &tuple : tuples) {
+    int32_t tuple_size = std::abs(GetTupleSize(tuple.second));
+    free_space_pointer -= tuple_size;
+    if (free_space_pointer != tuple.first)
+      memmove(GetData() + free_space_pointer, GetData() + tuple.first,
+              tuple_size);
+    SetTupleOffset(tuple.second, free_space_pointer);
+  }
+  SetFreeSpacePointer(free_space_pointer);
+}
+
+// first empty slot, tuple count if there is none
+int TablePage::GetFreeSlot() {
+  int tuple_count = GetTupleCount();
+  uint64_t *bitmap = GetSlotBitmap();
+  for (int word = 0; word * 64 < tuple_count; word++) {
+    if (bitmap[word] != UINT64_MAX)
+      return std::min(tuple_count, word * 64 + __builtin_ctzll(~bitmap[word]));
+  }
+  return tuple_count;
+}
+
+int TablePage::GetNextUsedSlot(int slot_num) {
+  int tuple_count = GetTupleCount();
+  if (slot_num >= tuple_count)
+    return tuple_count;
+  uint64_t *bitmap = GetSlotBitmap();
+  int word = slot_num / 64;
+  // bits of slots before slot_num are masked off
+  uint64_t bits = bitmap[word] & (UINT64_MAX << (slot_num % 64));
+  while (bits == 0) {
+    if (++word * 64 >= tuple_count)
+      return tuple_count;
+    bits = bitmap[word];
+  }
+  return std::min(tuple_count, word * 64 + __builtin_ctzll(bits));
+}
+
+uint64_t *TablePage::GetSlotBitmap() {
+  return reinterpret_cast<uint64_t *>(GetData() + 24);
+}
+
 
 // tuple slots
 int32_t TablePage::GetTupleOffset(int slot_num) {
-  return *reinterpret_cast<int32_t *>(GetData() + 24 + 8 * slot_num);
+  return *reinterpret_cast<int32_t *>(GetData() + HEADER_SIZE + 8 * slot_num);
 }
 
 int32_t TablePage::GetTupleSize(int slot_num) {
-  return *reinterpret_cast<int32_t *>(GetData() + 28 + 8 * slot_num);
+  return *reinterpret_cast<int32_t *>(GetData() + HEADER_SIZE + 4 +
+                                      8 * slot_num);
 }
 
 void TablePage::SetTupleOffset(int slot_num, int32_t offset) {
-  memcpy(GetData() + 24 + 8 * slot_num, &offset, 4);
+  memcpy(GetData() + HEADER_SIZE + 8 * slot_num, &offset, 4);
 }
 
+// keeps slot bitmap up to date as well
 void TablePage::SetTupleSize(int slot_num, int32_t offset) {
-  memcpy(GetData() + 28 + 8 * slot_num, &offset, 4);
+  memcpy(GetData() + HEADER_SIZE + 4 + 8 * slot_num, &offset, 4);
+  uint64_t bit = uint64_t(1) << (slot_num % 64);
+  if (offset != 0)
+    GetSlotBitmap()[slot_num / 64] |= bit;
+  else
+    GetSlotBitmap()[slot_num / 64] &= ~bit;
 }
 
 // free space
@@ -423,9 +535,18 @@ void TablePage::SetTupleCount(int32_t tuple_count) {
 }
 
 // for free space calculation
+/*
+ * A new tuple takes a free slot, or a new one next to free space, and holes
+ * between tuples once they are packed
+ */
+int32_t TablePage::GetMaxInsertSize() {
+  int32_t size = GetFreeSpaceSize() + GetFragmentedSize();
+  return GetFreeSlot() < GetTupleCount() ? size : size - 8;
+}
+
 int32_t TablePage::GetFreeSpaceSize() {
   int32_t tupleCount = GetTupleCount();
   int32_t freeSpacePtr = GetFreeSpacePointer();
-  return freeSpacePtr - 24 - tupleCount * 8;
+  return freeSpacePtr - HEADER_SIZE - tupleCount * 8;
 }
 } // namespace cmudb
@@ -0,0 +1,140 @@
+/**
+ * batch_filter.cpp
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "table/batch_filter.h"
+
+namespace cmudb {
+
+/*
+ * Copy column at offset of each tuple of batch into values, widened to U,
+ * deselecting the tuples where it is null
+ */
+template <typename T, typename U>
+static void ExtractColumn(const std::vector<TupleView> &batch, int32_t offset,
+                          T null_value, U *values, uint8_t *selection) {
+  for (size_t i = 0; i < batch.size(); i++) {
+    T value;
+    memcpy(&value, batch[i].GetData() + offset, sizeof(T));
+    values[i] = value;
+    selection[i] &= value != null_value;
+  }
+}
+
+/*
+ * Deselect tuples whose value fails comparison with constant. Loops have no
+ * branches nor calls in them, so each is vectorized
+ */
+template <typename T>
+static void Compare(const T *values, CompareOp op, T constant, size_t size,
+                    uint8_t *selection) {
+  switch (op) {
+  case CompareOp::EQ:
+    for (size_t i = 0; i < size; i++)
+      selection[i] &= values[i] == constant;
+    break;
+  case CompareOp::LT:
+    for (size_t i = 0; i < size; i++)
+      selection[i] &= values[i] < constant;
+    break;
+  case CompareOp::LE:
+    for (size_t i = 0; i < size; i++)
+      selection[i] &= values[i] <= constant;
+    break;
+  case CompareOp::GT:
+    for (size_t i = 0; i < size; i++)
+      selection[i] &= values[i] > constant;
+    break;
+  case CompareOp::GE:
+    for (size_t i = 0; i < size; i++)
+      selection[i] &= values[i] >= constant;
+    break;
+  }
+}
+
+BatchFilter::BatchFilter(Schema *schema,
+                         const std::vector<ScanPredicate> &predicates)
+    : schema_(schema), predicates_(predicates) {
+  std::stable_sort(predicates_.begin(), predicates_.end(),
+                   [](const ScanPredicate &a, const ScanPredicate &b) {
+                     return a.column_id < b.column_id;
+                   });
+}
+
+bool BatchFilter::IsSupported(Schema *schema, int column_id) {
+  switch (schema->GetType(column_id)) {
+  case TypeId::TINYINT:
+  case TypeId::SMALLINT:
+  case TypeId::INTEGER:
+  case TypeId::BIGINT:
+  case TypeId::DECIMAL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void BatchFilter::Apply(std::vector<TupleView> &batch) {
+  size_t size = batch.size();
+  selection_.assign(size, 1);
+  for (size_t i = 0; i < predicates_.size(); i++) {
+    const ScanPredicate &predicate = predicates_[i];
+    bool is_decimal = schema_->GetType(predicate.column_id) == TypeId::DECIMAL;
+    if (i == 0 || predicates_[i - 1].column_id != predicate.column_id) {
+      if (is_decimal)
+        ExtractDecimals(batch, predicate.column_id);
+      else
+        ExtractIntegers(batch, predicate.column_id);
+    }
+    if (is_decimal)
+      Compare(decimals_.data(), predicate.op, predicate.decimal, size,
+              selection_.data());
+    else
+      Compare(integers_.data(), predicate.op, predicate.integer, size,
+              selection_.data());
+  }
+
+  // move the selected ones to the front, without branches either
+  size_t count = 0;
+  for (size_t i = 0; i < size; i++) {
+    batch[count] = batch[i];
+    count += selection_[i];
+  }
+  batch.resize(count);
+}
+
+void BatchFilter::ExtractIntegers(const std::vector<TupleView> &batch,
+                                  int column_id) {
+  integers_.resize(batch.size());
+  int32_t offset = schema_->GetOffset(column_id);
+  switch (schema_->GetType(column_id)) {
+  case TypeId::TINYINT:
+    ExtractColumn(batch, offset, PELOTON_INT8_NULL, integers_.data(),
+                  selection_.data());
+    break;
+  case TypeId::SMALLINT:
+    ExtractColumn(batch, offset, PELOTON_INT16_NULL, integers_.data(),
+                  selection_.data());
+    break;
+  case TypeId::INTEGER:
+    ExtractColumn(batch, offset, PELOTON_INT32_NULL, integers_.data(),
+                  selection_.data());
+    break;
+  default:
+    ExtractColumn(batch, offset, PELOTON_INT64_NULL, integers_.data(),
+                  selection_.data());
+    break;
+  }
+}
+
+void BatchFilter::ExtractDecimals(const std::vector<TupleView> &batch,
+                                  int column_id) {
+  decimals_.resize(batch.size());
+  ExtractColumn(batch, schema_->GetOffset(column_id), PELOTON_DECIMAL_NULL,
+                decimals_.data(), selection_.data());
+}
+
+} // namespace cmudb
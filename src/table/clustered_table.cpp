@@ -0,0 +1,221 @@
+/**
+ * clustered_table.cpp
+ */
+
+#include "common/exception.h"
+#include "table/clustered_table.h"
+#include "table/overflow_chain.h"
+
+namespace cmudb {
+
+ClusteredTable::ClusteredTable(IndexMetadata *metadata, Schema *schema,
+                               BufferPoolManager *buffer_pool_manager,
+                               page_id_t root_page_id)
+    : metadata_(metadata), schema_(schema),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(metadata->GetEntrySchema(),
+                  metadata->GetIndexColumnCount()),
+      tree_(metadata->GetName(), buffer_pool_manager, comparator_,
+            root_page_id) {
+  entry_columns_.assign(schema_->GetColumnCount(), -1);
+  int entry_column = 0;
+  for (auto &i : metadata_->GetKeyAttrs())
+    entry_columns_[i] = entry_column++;
+  for (auto &i : metadata_->GetIncludedAttrs())
+    entry_columns_[i] = entry_column++;
+}
+
+/*
+ * Primary key column is an integer one(see ParseIndexStatement())
+ */
+int64_t ClusteredTable::GetRowId(const Tuple &tuple) const {
+  int column = metadata_->GetKeyAttrs()[0];
+  Value value = tuple.GetValue(schema_, column);
+  switch (schema_->GetType(column)) {
+  case TypeId::TINYINT:
+    return value.GetAs<int8_t>();
+  case TypeId::SMALLINT:
+    return value.GetAs<int16_t>();
+  case TypeId::INTEGER:
+    return value.GetAs<int32_t>();
+  case TypeId::BIGINT:
+    return value.GetAs<int64_t>();
+  default:
+    throw Exception(EXCEPTION_TYPE_MISMATCH_TYPE,
+                    "primary key of clustered table is not an integer");
+  }
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Row goes into leaf whole if it is short enough, otherwise into overflow
+ * pages, which are freed again if primary key turns out to be taken
+ */
+bool ClusteredTable::InsertTuple(const Tuple &tuple, Transaction *txn) {
+  std::vector<Value> entry_values;
+  for (auto &i : metadata_->GetKeyAttrs())
+    entry_values.push_back(tuple.GetValue(schema_, i));
+  for (auto &i : metadata_->GetIncludedAttrs())
+    entry_values.push_back(tuple.GetValue(schema_, i));
+  Tuple entry(entry_values, metadata_->GetEntrySchema());
+
+  GenericKey<CLUSTERED_KEY_SIZE> key;
+  RID value;
+  if (entry.GetLength() <= CLUSTERED_INLINE_SIZE) {
+    key.SetFromKey(entry);
+  } else {
+    key = MakeKey(GetRowId(tuple));
+    value = RID(WriteOverflow(tuple), 0);
+  }
+  if (!tree_.Insert(key, value, txn)) {
+    if (value.GetPageId() != INVALID_PAGE_ID)
+      OverflowChain::Delete(buffer_pool_manager_, value.GetPageId());
+    return false;
+  }
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+bool ClusteredTable::DeleteTuple(int64_t row_id, Transaction *txn) {
+  GenericKey<CLUSTERED_KEY_SIZE> key = MakeKey(row_id);
+  std::vector<RID> result;
+  if (!tree_.GetValue(key, result, txn))
+    return false;
+  tree_.Remove(key, txn);
+  if (result[0].GetPageId() != INVALID_PAGE_ID)
+    OverflowChain::Delete(buffer_pool_manager_, result[0].GetPageId());
+  return true;
+}
+
+/*****************************************************************************
+ * UPDATE
+ *****************************************************************************/
+/*
+ * Leaf key holds the row, so an update is a delete and an insert
+ */
+bool ClusteredTable::UpdateTuple(const Tuple &tuple, int64_t row_id,
+                                 Transaction *txn) {
+  int64_t new_row_id = GetRowId(tuple);
+  if (new_row_id != row_id) {
+    std::vector<RID> result;
+    if (tree_.GetValue(MakeKey(new_row_id), result, txn))
+      return false;
+  }
+  DeleteTuple(row_id, txn);
+  return InsertTuple(tuple, txn);
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+bool ClusteredTable::GetTuple(int64_t row_id, Tuple &tuple,
+                              Transaction *txn) {
+  return Lookup(MakeKey(row_id), tuple, txn);
+}
+
+bool ClusteredTable::GetTuple(const Tuple &key, Tuple &tuple,
+                              Transaction *txn) {
+  GenericKey<CLUSTERED_KEY_SIZE> index_key;
+  index_key.SetFromKey(key);
+  return Lookup(index_key, tuple, txn);
+}
+
+/*
+ * Leaf key found is the row, unless it is kept in overflow pages
+ */
+bool ClusteredTable::Lookup(const GenericKey<CLUSTERED_KEY_SIZE> &key,
+                            Tuple &tuple, Transaction *txn) {
+  std::vector<RID> result;
+  GenericKey<CLUSTERED_KEY_SIZE> stored_key;
+  bool has_stored_key;
+  if (!tree_.GetValue(key, result, stored_key, has_stored_key, txn))
+    return false;
+  ReadRow(stored_key, result[0], tuple);
+  return true;
+}
+
+ClusteredTableIterator ClusteredTable::begin() {
+  return ClusteredTableIterator(this, tree_.Begin());
+}
+
+/*****************************************************************************
+ * HELPER METHODS
+ *****************************************************************************/
+/*
+ * Leaf key with nothing but primary key, it equals the one of the row under
+ * comparator
+ */
+GenericKey<CLUSTERED_KEY_SIZE> ClusteredTable::MakeKey(int64_t row_id) const {
+  Schema *key_schema = metadata_->GetKeySchema();
+  TypeId type = key_schema->GetType(0);
+  std::vector<Value> key_values;
+  if (type == TypeId::BIGINT)
+    key_values.push_back(Value(type, row_id));
+  else
+    key_values.push_back(Value(type, static_cast<int32_t>(row_id)));
+  GenericKey<CLUSTERED_KEY_SIZE> key;
+  key.SetFromKey(Tuple(key_values, key_schema));
+  return key;
+}
+
+/*
+ * Rebuild the row in table column order from a leaf pair
+ */
+void ClusteredTable::ReadRow(const GenericKey<CLUSTERED_KEY_SIZE> &key,
+                             const RID &value, Tuple &tuple) const {
+  if (value.GetPageId() != INVALID_PAGE_ID) {
+    ReadOverflow(value.GetPageId(), tuple);
+    return;
+  }
+  Schema *entry_schema = metadata_->GetEntrySchema();
+  std::vector<Value> values;
+  for (int i = 0; i < schema_->GetColumnCount(); i++)
+    values.push_back(key.ToValue(entry_schema, entry_columns_[i]));
+  tuple = Tuple(values, schema_);
+}
+
+/*
+ * Store serialized tuple in a new chain of overflow pages
+ * @return : page id of the first page
+ */
+page_id_t ClusteredTable::WriteOverflow(const Tuple &tuple) {
+  std::vector<char> data(sizeof(int32_t) + tuple.GetLength());
+  tuple.SerializeTo(data.data());
+  return OverflowChain::Write(buffer_pool_manager_, data.data(), data.size());
+}
+
+void ClusteredTable::ReadOverflow(page_id_t page_id, Tuple &tuple) const {
+  std::vector<char> data;
+  OverflowChain::Read(buffer_pool_manager_, page_id, data);
+  tuple.DeserializeFrom(data.data());
+}
+
+/*****************************************************************************
+ * ITERATOR
+ *****************************************************************************/
+ClusteredTableIterator::ClusteredTableIterator(
+    ClusteredTable *table,
+    const IndexIterator<GenericKey<CLUSTERED_KEY_SIZE>, RID,
+                        GenericComparator<CLUSTERED_KEY_SIZE>> &iterator)
+    : table_(table), iterator_(iterator) {
+  Load();
+}
+
+ClusteredTableIterator &ClusteredTableIterator::operator++() {
+  ++iterator_;
+  Load();
+  return *this;
+}
+
+void ClusteredTableIterator::Load() {
+  if (iterator_.isEnd())
+    return;
+  auto item = *iterator_;
+  table_->ReadRow(item.first, item.second, tuple_);
+}
+
+} // namespace cmudb
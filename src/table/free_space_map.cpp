@@ -0,0 +1,161 @@
+/**
+ * free_space_map.cpp
+ */
+
+#include <algorithm>
+
+#include "table/free_space_map.h"
+
+namespace cmudb {
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager,
+                           page_id_t first_page_id)
+    : buffer_pool_manager_(buffer_pool_manager) {
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = reinterpret_cast<FreeSpaceMapPage *>(
+        buffer_pool_manager_->FetchPage(page_id)->GetData());
+    int max_bucket = 0;
+    for (int slot = 0; slot < page->GetSlotCount(); slot++) {
+      slots_[page->GetHeapPageId(slot)] = heap_page_ids_.size();
+      heap_page_ids_.push_back(page->GetHeapPageId(slot));
+      buckets_.push_back(page->GetBucket(slot));
+      claimed_.push_back(false);
+      max_bucket = std::max(max_bucket, page->GetBucket(slot));
+    }
+    map_page_ids_.push_back(page_id);
+    max_buckets_.push_back(max_bucket);
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager)
+    : buffer_pool_manager_(buffer_pool_manager) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr)
+    throw std::bad_alloc();
+  reinterpret_cast<FreeSpaceMapPage *>(page->GetData())->Init(page_id);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  map_page_ids_.push_back(page_id);
+  max_buckets_.push_back(0);
+}
+
+/*
+ * Skip map pages without a large enough bucket, then look for one in the
+ * first map page that has it
+ */
+page_id_t FreeSpaceMap::ClaimPage(int size) {
+  int bucket = (size + BYTES_PER_BUCKET - 1) / BYTES_PER_BUCKET;
+  std::lock_guard<std::mutex> lock(latch_);
+  for (size_t i = 0; i < map_page_ids_.size(); i++) {
+    if (max_buckets_[i] < bucket)
+      continue;
+    size_t end = std::min<size_t>(buckets_.size(),
+                                  (i + 1) * FreeSpaceMapPage::SLOT_COUNT);
+    for (size_t slot = i * FreeSpaceMapPage::SLOT_COUNT; slot < end; slot++) {
+      if (buckets_[slot] >= bucket && !claimed_[slot]) {
+        claimed_[slot] = true;
+        return heap_page_ids_[slot];
+      }
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::Update(page_id_t page_id, int free_size, bool claim) {
+  int bucket = GetBucket(free_size);
+  std::lock_guard<std::mutex> lock(latch_);
+  auto itr = slots_.find(page_id);
+  if (itr == slots_.end()) {
+    Append(page_id, bucket);
+    claimed_.back() = claim;
+    return;
+  }
+  SetBucket(itr->second, bucket);
+}
+
+void FreeSpaceMap::ReleasePage(page_id_t page_id, int free_size) {
+  int bucket = GetBucket(free_size);
+  std::lock_guard<std::mutex> lock(latch_);
+  auto itr = slots_.find(page_id);
+  if (itr != slots_.end()) {
+    SetBucket(itr->second, bucket);
+    claimed_[itr->second] = false;
+  }
+}
+
+/*
+ * Bucket rounds free bytes down
+ */
+int FreeSpaceMap::GetBucket(int free_size) {
+  return std::min<int>(UINT8_MAX, std::max(0, free_size) / BYTES_PER_BUCKET);
+}
+
+page_id_t FreeSpaceMap::GetLastPageId() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return heap_page_ids_.empty() ? INVALID_PAGE_ID : heap_page_ids_.back();
+}
+
+/*
+ * Record a heap page in the last map page, or in a new one linked after it
+ * when it is full
+ */
+void FreeSpaceMap::Append(page_id_t page_id, int bucket) {
+  page_id_t map_page_id = map_page_ids_.back();
+  auto *page = reinterpret_cast<FreeSpaceMapPage *>(
+      buffer_pool_manager_->FetchPage(map_page_id)->GetData());
+  if (!page->Append(page_id, bucket)) {
+    page_id_t new_page_id;
+    Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
+    if (new_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(map_page_id, false);
+      throw std::bad_alloc();
+    }
+    page->SetNextPageId(new_page_id);
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+    map_page_id = new_page_id;
+    page = reinterpret_cast<FreeSpaceMapPage *>(new_page->GetData());
+    page->Init(map_page_id);
+    page->Append(page_id, bucket);
+    map_page_ids_.push_back(map_page_id);
+    max_buckets_.push_back(0);
+  }
+  buffer_pool_manager_->UnpinPage(map_page_id, true);
+
+  slots_[page_id] = heap_page_ids_.size();
+  heap_page_ids_.push_back(page_id);
+  buckets_.push_back(bucket);
+  claimed_.push_back(false);
+  max_buckets_.back() = std::max(max_buckets_.back(), bucket);
+}
+
+/*
+ * Map page is written only when bucket of heap page changes
+ */
+void FreeSpaceMap::SetBucket(int slot, int bucket) {
+  if (buckets_[slot] == bucket)
+    return;
+  int map_page = slot / FreeSpaceMapPage::SLOT_COUNT;
+  page_id_t map_page_id = map_page_ids_[map_page];
+  auto *page = reinterpret_cast<FreeSpaceMapPage *>(
+      buffer_pool_manager_->FetchPage(map_page_id)->GetData());
+  page->SetBucket(slot % FreeSpaceMapPage::SLOT_COUNT, bucket);
+  buffer_pool_manager_->UnpinPage(map_page_id, true);
+
+  int old_bucket = buckets_[slot];
+  buckets_[slot] = bucket;
+  if (bucket > max_buckets_[map_page]) {
+    max_buckets_[map_page] = bucket;
+  } else if (old_bucket == max_buckets_[map_page]) {
+    auto begin = buckets_.begin() + map_page * FreeSpaceMapPage::SLOT_COUNT;
+    auto end = buckets_.begin() +
+               std::min<size_t>(buckets_.size(),
+                                (map_page + 1) * FreeSpaceMapPage::SLOT_COUNT);
+    max_buckets_[map_page] = *std::max_element(begin, end);
+  }
+}
+
+} // namespace cmudb
@@ -0,0 +1,85 @@
+/**
+ * overflow_chain.cpp
+ */
+
+#include "table/overflow_chain.h"
+#include "page/overflow_page.h"
+
+namespace cmudb {
+
+/*
+ * Written from the last piece backward, so each page knows the next one
+ */
+page_id_t OverflowChain::Write(BufferPoolManager *buffer_pool_manager,
+                               const char *data, int size, Transaction *txn,
+                               LogManager *log_manager) {
+  int piece_count =
+      (size + OverflowPage::GetMaxSize() - 1) / OverflowPage::GetMaxSize();
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  for (int piece = piece_count - 1; piece >= 0; piece--) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager->NewPage(page_id);
+    if (page == nullptr)
+      throw std::bad_alloc();
+    auto *overflow = reinterpret_cast<OverflowPage *>(page->GetData());
+    overflow->Init(page_id, next_page_id);
+    int offset = piece * OverflowPage::GetMaxSize();
+    overflow->Write(data + offset, size - offset);
+    if (ENABLE_LOGGING && log_manager != nullptr) {
+      LogRecord log(txn->GetTransactionId(), txn->GetPrevLSN(),
+                    LogRecordType::NEWOVERFLOWPAGE, page_id, next_page_id,
+                    overflow->GetData(), overflow->GetSize());
+      lsn_t lsn = log_manager->AppendLogRecord(log);
+      txn->SetPrevLSN(lsn);
+      page->SetLSN(lsn);
+    }
+    buffer_pool_manager->UnpinPage(page_id, true);
+    next_page_id = page_id;
+  }
+  return next_page_id;
+}
+
+void OverflowChain::Read(BufferPoolManager *buffer_pool_manager,
+                         page_id_t page_id, std::vector<char> &data) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager->FetchPage(page_id);
+    if (page == nullptr)
+      throw std::bad_alloc();
+    auto *overflow = reinterpret_cast<OverflowPage *>(page->GetData());
+    data.insert(data.end(), overflow->GetData(),
+                overflow->GetData() + overflow->GetSize());
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+/*
+ * A freed page is zeroed on disk right away, so its log record goes to disk
+ * first
+ */
+void OverflowChain::Delete(BufferPoolManager *buffer_pool_manager,
+                           page_id_t page_id, Transaction *txn,
+                           LogManager *log_manager) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager->FetchPage(page_id);
+    if (page == nullptr)
+      throw std::bad_alloc();
+    auto *overflow = reinterpret_cast<OverflowPage *>(page->GetData());
+    page_id_t next_page_id = overflow->GetNextPageId();
+    if (ENABLE_LOGGING && log_manager != nullptr) {
+      LogRecord log(txn->GetTransactionId(), txn->GetPrevLSN(),
+                    LogRecordType::DELETEOVERFLOWPAGE, page_id, next_page_id,
+                    overflow->GetData(), overflow->GetSize());
+      lsn_t lsn = log_manager->AppendLogRecord(log);
+      txn->SetPrevLSN(lsn);
+      while (lsn > log_manager->GetPersistentLSN())
+        log_manager->wakeUpFlushThread();
+    }
+    buffer_pool_manager->UnpinPage(page_id, false);
+    buffer_pool_manager->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+} // namespace cmudb
@@ -2,9 +2,13 @@
  * table_heap.cpp
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 
+#include "common/exception.h"
 #include "common/logger.h"
+#include "table/overflow_chain.h"
 #include "table/table_heap.h"
 
 namespace cmudb {
@@ -12,77 +16,273 @@ namespace cmudb {
 // open table
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
                      LockManager *lock_manager, LogManager *log_manager,
-                     page_id_t first_page_id)
+                     page_id_t first_page_id,
+                     page_id_t free_space_map_page_id, Schema *schema,
+                     PageLayout layout)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
-      log_manager_(log_manager), first_page_id_(first_page_id) {}
+      log_manager_(log_manager), first_page_id_(first_page_id),
+      schema_(schema), layout_(layout),
+      insert_targets_(INSERT_TARGET_COUNT, INVALID_PAGE_ID),
+      insert_target_latches_(INSERT_TARGET_COUNT) {
+  CheckLayout();
+  if (free_space_map_page_id != INVALID_PAGE_ID) {
+    free_space_map_ =
+        new FreeSpaceMap(buffer_pool_manager_, free_space_map_page_id);
+    return;
+  }
+  free_space_map_ = new FreeSpaceMap(buffer_pool_manager_);
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    free_space_map_->Update(page_id, GetMaxInsertSize(page));
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
 
 // create table
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
                      LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
+                     Transaction *txn, Schema *schema, PageLayout layout)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager), schema_(schema), layout_(layout),
+      insert_targets_(INSERT_TARGET_COUNT, INVALID_PAGE_ID),
+      insert_target_latches_(INSERT_TARGET_COUNT) {
+  CheckLayout();
   auto first_page =
       static_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
   assert(first_page != nullptr); // todo: abort table creation?
   first_page->WLatch();
   LOG_DEBUG("new table page created %d", first_page_id_);
 
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  InitPage(first_page, first_page_id_, INVALID_PAGE_ID, txn);
+  free_space_map_ = new FreeSpaceMap(buffer_pool_manager_);
+  free_space_map_->Update(first_page_id_, GetMaxInsertSize(first_page));
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
+/*
+ * Insert into the target page of this thread. Each target is a page claimed
+ * in free-space map, so threads with different targets latch different
+ * pages. A full target is released and another one claimed: the first page
+ * free-space map finds room in, or a page appended to page chain when none
+ * has room.
+ */
 bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) { // larger than one page size
+  Tuple toasted;
+  const Tuple &stored = Toast(tuple, toasted, txn) ? toasted : tuple;
+  // larger than one page size, or than declared for a PAX page
+  if (layout_ == PageLayout::PAX
+          ? !PaxPage::IsStorable(schema_, stored)
+          : stored.size_ + TablePage::HEADER_SIZE + 8 > PAGE_SIZE) {
+    DeleteToast(toasted, txn);
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
-    txn->SetState(TransactionState::ABORTED);
+  static std::atomic<int> thread_count(0);
+  static thread_local int target = thread_count++ % INSERT_TARGET_COUNT;
+  std::lock_guard<std::mutex> lock(insert_target_latches_[target]);
+  page_id_t &page_id = insert_targets_[target];
+  bool inserted = false;
+  while (!inserted) {
+    TablePage *cur_page;
+    if (page_id == INVALID_PAGE_ID) {
+      cur_page = ClaimPage(layout_ == PageLayout::PAX ? 1 : stored.size_, txn);
+    } else {
+      cur_page =
+          static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      if (cur_page != nullptr)
+        cur_page->WLatch();
+    }
+    if (cur_page == nullptr) {
+      DeleteToast(toasted, txn);
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page_id = cur_page->GetPageId();
+    if (layout_ == PageLayout::PAX)
+      inserted = AsPax(cur_page)->InsertTuple(schema_, stored, rid, txn,
+                                              lock_manager_);
+    else
+      inserted =
+          cur_page->InsertTuple(stored, rid, txn, lock_manager_, log_manager_);
+    if (!inserted) {
+      // let other inserters have what is left of it
+      free_space_map_->ReleasePage(page_id, GetMaxInsertSize(cur_page));
+      page_id = INVALID_PAGE_ID;
+    }
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), inserted);
+  }
+  txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
+  return true;
+}
+
+/*
+ * Toast tuple into toasted if it is longer than TOAST_THRESHOLD, moving its
+ * longest varchar values to overflow pages first
+ * @return : false if tuple is stored as it is
+ */
+bool TableHeap::Toast(const Tuple &tuple, Tuple &toasted,
+                      Transaction *txn) {
+  // a PAX page stores values as long as declared
+  if (schema_ == nullptr || layout_ == PageLayout::PAX ||
+      tuple.size_ <= TOAST_THRESHOLD)
     return false;
+  TupleView view(tuple);
+  std::vector<int> columns = schema_->GetUnlinedColumns();
+  // serialized length of each varchar value, data only. A toast pointer is
+  // there already when an update is rolled back, it is kept as it is
+  std::vector<uint32_t> lengths(schema_->GetColumnCount(), 0);
+  for (auto &i : columns) {
+    uint32_t len =
+        *reinterpret_cast<const uint32_t *>(view.GetDataPtr(schema_, i));
+    if (len == TOAST_MARKER)
+      lengths[i] = TOAST_POINTER_SIZE - sizeof(uint32_t);
+    else if (len != PELOTON_VALUE_NULL)
+      lengths[i] = len;
   }
+  std::stable_sort(columns.begin(), columns.end(),
+                   [&lengths](int a, int b) { return lengths[a] > lengths[b]; });
+  std::vector<bool> is_toasted(schema_->GetColumnCount(), false);
+  int32_t size = tuple.size_;
+  for (auto &i : columns) {
+    int32_t saving = sizeof(uint32_t) + lengths[i] - TOAST_POINTER_SIZE;
+    if (size <= TOAST_THRESHOLD || saving <= 0)
+      break;
+    is_toasted[i] = true;
+    size -= saving;
+  }
+  if (size == tuple.size_)
+    return false;
 
-  cur_page->WLatch();
-  while (!cur_page->InsertTuple(
-      tuple, rid, txn, lock_manager_,
-      log_manager_)) { // fail to insert due to not enough space
-    auto next_page_id = cur_page->GetNextPageId();
-    if (next_page_id != INVALID_PAGE_ID) { // valid next page
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = static_cast<TablePage *>(
-          buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else { // create new page
-      auto new_page =
-          static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
-      if (new_page == nullptr) {
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      new_page->WLatch();
-      // std::cout << "new table page " << next_page_id << " created" <<
-      // std::endl;
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetPageId(),
-                     log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
-      cur_page = new_page;
+  // inlined columns as they are, varchar ones or their pointers behind them
+  toasted.rid_ = tuple.rid_;
+  toasted.size_ = size;
+  toasted.data_ = new char[size];
+  toasted.allocated_ = true;
+  memcpy(toasted.data_, tuple.data_, schema_->GetLength());
+  int32_t offset = schema_->GetLength();
+  for (auto &i : schema_->GetUnlinedColumns()) {
+    *reinterpret_cast<int32_t *>(toasted.data_ + schema_->GetOffset(i)) =
+        offset;
+    const char *data_ptr = view.GetDataPtr(schema_, i);
+    char *pointer = toasted.data_ + offset;
+    if (is_toasted[i]) {
+      *reinterpret_cast<uint32_t *>(pointer) = TOAST_MARKER;
+      *reinterpret_cast<page_id_t *>(pointer + 4) =
+          OverflowChain::Write(buffer_pool_manager_, data_ptr + 4, lengths[i],
+                               txn, log_manager_);
+      *reinterpret_cast<uint32_t *>(pointer + 8) = lengths[i];
+      offset += TOAST_POINTER_SIZE;
+    } else {
+      memcpy(pointer, data_ptr, sizeof(uint32_t) + lengths[i]);
+      offset += sizeof(uint32_t) + lengths[i];
     }
   }
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
-  txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
+// read toasted values of tuple back, if any
+void TableHeap::Detoast(Tuple &tuple) {
+  if (schema_ == nullptr)
+    return;
+  TupleView view(tuple);
+  bool has_toasted = false;
+  for (auto &i : schema_->GetUnlinedColumns())
+    has_toasted = has_toasted || IsToasted(view, i);
+  if (!has_toasted)
+    return;
+  std::vector<Value> values;
+  for (int i = 0; i < schema_->GetColumnCount(); i++)
+    values.push_back(GetValue(view, i));
+  Tuple detoasted(values, schema_);
+  detoasted.rid_ = tuple.rid_;
+  // swap data, so that tuple frees the old one
+  std::swap(tuple.data_, detoasted.data_);
+  std::swap(tuple.size_, detoasted.size_);
+  std::swap(tuple.allocated_, detoasted.allocated_);
+}
+
+// free overflow pages of a tuple version gone for good
+void TableHeap::DeleteToast(const Tuple &tuple, Transaction *txn) {
+  if (schema_ == nullptr || tuple.data_ == nullptr)
+    return;
+  TupleView view(tuple);
+  for (auto &i : schema_->GetUnlinedColumns()) {
+    if (IsToasted(view, i))
+      OverflowChain::Delete(buffer_pool_manager_,
+                            *reinterpret_cast<const page_id_t *>(
+                                view.GetDataPtr(schema_, i) + 4),
+                            txn, log_manager_);
+  }
+}
+
+bool TableHeap::IsToasted(const TupleView &tuple, int column_id) {
+  return schema_ != nullptr && !schema_->IsInlined(column_id) &&
+         *reinterpret_cast<const uint32_t *>(
+             tuple.GetDataPtr(schema_, column_id)) == TOAST_MARKER;
+}
+
+/*
+ * Claim a page with room for size bytes, or append a new one to the end of
+ * page chain, unless another thread appended one meanwhile
+ * Return write latched and pinned page, nullptr if buffer pool has no page
+ */
+TablePage *TableHeap::ClaimPage(int size, Transaction *txn) {
+  page_id_t page_id = free_space_map_->ClaimPage(size);
+  if (page_id == INVALID_PAGE_ID) {
+    append_latch_.lock();
+    page_id = free_space_map_->ClaimPage(size);
+  }
+  if (page_id != INVALID_PAGE_ID) {
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page != nullptr)
+      page->WLatch();
+    return page;
+  }
+  std::lock_guard<std::mutex> lock(append_latch_, std::adopt_lock);
+
+  auto last_page = static_cast<TablePage *>(
+      buffer_pool_manager_->FetchPage(free_space_map_->GetLastPageId()));
+  if (last_page == nullptr)
+    return nullptr;
+  last_page->WLatch();
+  // map pages are not logged, map may miss the last pages after a crash
+  while (last_page->GetNextPageId() != INVALID_PAGE_ID) {
+    auto next_page = static_cast<TablePage *>(
+        buffer_pool_manager_->FetchPage(last_page->GetNextPageId()));
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), false);
+    if (next_page == nullptr)
+      return nullptr;
+    next_page->WLatch();
+    free_space_map_->Update(next_page->GetPageId(),
+                            GetMaxInsertSize(next_page));
+    last_page = next_page;
+  }
+
+  auto new_page =
+      static_cast<TablePage *>(buffer_pool_manager_->NewPage(page_id));
+  if (new_page == nullptr) {
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), false);
+    return nullptr;
+  }
+  new_page->WLatch();
+  last_page->SetNextPageId(page_id);
+  InitPage(new_page, page_id, last_page->GetPageId(), txn);
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+  free_space_map_->Update(page_id, GetMaxInsertSize(new_page), true);
+  return new_page;
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // todo: remove empty page
   auto page = reinterpret_cast<TablePage *>(
@@ -92,13 +292,21 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
     return false;
   }
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (layout_ == PageLayout::PAX)
+    AsPax(page)->MarkDelete(rid, txn, lock_manager_);
+  else
+    page->MarkDelete(rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
 }
 
+/*
+ * Old version keeps its overflow pages until commit, unless this is the
+ * rollback of an update(transaction is aborted then), which replaces a
+ * version that is gone for good
+ */
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid,
                             Transaction *txn) {
   auto page = reinterpret_cast<TablePage *>(
@@ -107,13 +315,31 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid,
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  Tuple toasted;
+  const Tuple &stored = Toast(tuple, toasted, txn) ? toasted : tuple;
+  if (layout_ == PageLayout::PAX && !PaxPage::IsStorable(schema_, stored)) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
   Tuple old_tuple;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, old_tuple, rid, txn, lock_manager_,
-                                      log_manager_);
+  bool is_updated;
+  if (layout_ == PageLayout::PAX)
+    is_updated = AsPax(page)->UpdateTuple(schema_, stored, old_tuple, rid, txn,
+                                          lock_manager_);
+  else
+    is_updated = page->UpdateTuple(stored, old_tuple, rid, txn, lock_manager_,
+                                   log_manager_);
+  if (is_updated)
+    free_space_map_->Update(page->GetPageId(), GetMaxInsertSize(page));
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(), is_updated);
-  if (is_updated && txn->GetState() != TransactionState::ABORTED)
+  if (!is_updated)
+    DeleteToast(toasted, txn);
+  else if (txn->GetState() == TransactionState::ABORTED)
+    DeleteToast(old_tuple, txn);
+  else
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
   return is_updated;
 }
@@ -122,11 +348,18 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   auto page = reinterpret_cast<TablePage *>(
       buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
+  Tuple deleted_tuple;
   page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  if (layout_ == PageLayout::PAX)
+    AsPax(page)->ApplyDelete(rid, txn);
+  else
+    page->ApplyDelete(rid, txn, log_manager_,
+                      schema_ != nullptr ? &deleted_tuple : nullptr);
   lock_manager_->Unlock(txn, rid);
+  free_space_map_->Update(page->GetPageId(), GetMaxInsertSize(page));
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  DeleteToast(deleted_tuple, txn);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
@@ -134,11 +367,19 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
       buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
   page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
+  if (layout_ == PageLayout::PAX)
+    AsPax(page)->RollbackDelete(rid, txn);
+  else
+    page->RollbackDelete(rid, txn, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 }
 
+// replaced version of an updated tuple is gone for good
+void TableHeap::ApplyUpdate(const Tuple &old_tuple, Transaction *txn) {
+  DeleteToast(old_tuple, txn);
+}
+
 // called by tuple iterator
 bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
   auto page = static_cast<TablePage *>(
@@ -148,17 +389,88 @@ bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
     return false;
   }
   page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool res = layout_ == PageLayout::PAX
+                 ? AsPax(page)->GetTuple(schema_, rid, tuple, txn, lock_manager_)
+                 : page->GetTuple(rid, tuple, txn, lock_manager_);
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  if (res)
+    Detoast(tuple);
   return res;
 }
 
+Value TableHeap::GetValue(const TupleView &tuple, int column_id) {
+  if (!IsToasted(tuple, column_id))
+    return tuple.GetValue(schema_, column_id);
+  const char *data_ptr = tuple.GetDataPtr(schema_, column_id);
+  std::vector<char> data;
+  data.reserve(*reinterpret_cast<const uint32_t *>(data_ptr + 8));
+  OverflowChain::Read(buffer_pool_manager_,
+                      *reinterpret_cast<const page_id_t *>(data_ptr + 4), data);
+  return Value(schema_->GetType(column_id), data.data(), data.size(), true);
+}
+
 bool TableHeap::DeleteTableHeap() {
   // todo: real delete
   return true;
 }
 
+/*
+ * Walk page chain, one page latched at a time
+ */
+int TableHeap::Vacuum() {
+  int count = 0;
+  // PAX pages have no holes
+  if (layout_ == PageLayout::PAX)
+    return count;
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page =
+        static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr)
+      break;
+    page->WLatch();
+    bool is_compacted = page->GetFragmentedSize() >= VACUUM_THRESHOLD;
+    if (is_compacted) {
+      page->Compact();
+      free_space_map_->Update(page_id, page->GetMaxInsertSize());
+      count++;
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, is_compacted);
+    page_id = next_page_id;
+  }
+  return count;
+}
+
+void TableHeap::RunVacuumThread(std::chrono::milliseconds interval) {
+  StopVacuumThread();
+  vacuum_stopped_ = false;
+  vacuum_thread_ = new std::thread([this, interval] {
+    std::unique_lock<std::mutex> lock(vacuum_latch_);
+    while (!vacuum_cv_.wait_for(lock, interval,
+                                [this] { return vacuum_stopped_; })) {
+      lock.unlock();
+      Vacuum();
+      lock.lock();
+    }
+  });
+}
+
+void TableHeap::StopVacuumThread() {
+  if (vacuum_thread_ == nullptr)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(vacuum_latch_);
+    vacuum_stopped_ = true;
+  }
+  vacuum_cv_.notify_one();
+  vacuum_thread_->join();
+  delete vacuum_thread_;
+  vacuum_thread_ = nullptr;
+}
+
 TableIterator TableHeap::begin(Transaction *txn) {
   auto page =
       static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
@@ -166,7 +478,10 @@ TableIterator TableHeap::begin(Transaction *txn) {
   RID rid;
   // if failed (no tuple), rid will be the result of default
   // constructor, which means eof
-  page->GetFirstTupleRid(rid);
+  if (layout_ == PageLayout::PAX)
+    AsPax(page)->GetFirstTupleRid(rid);
+  else
+    page->GetFirstTupleRid(rid);
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, false);
   return TableIterator(this, rid, txn);
@@ -176,4 +491,32 @@ TableIterator TableHeap::end() {
   return TableIterator(this, RID(INVALID_PAGE_ID, -1), nullptr);
 }
 
+/*****************************************************************************
+ * PAGE LAYOUT
+ *****************************************************************************/
+void TableHeap::CheckLayout() {
+  if (layout_ != PageLayout::PAX)
+    return;
+  if (schema_ == nullptr || PaxPage::GetCapacity(schema_) == 0)
+    throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                    "PAX table heap needs a schema whose row fits in a page");
+  // it could not be recovered
+  if (ENABLE_LOGGING)
+    throw Exception(EXCEPTION_TYPE_NOT_IMPLEMENTED,
+                    "PAX pages are not logged, turn logging off first");
+}
+
+void TableHeap::InitPage(TablePage *page, page_id_t page_id,
+                         page_id_t prev_page_id, Transaction *txn) {
+  if (layout_ == PageLayout::PAX)
+    AsPax(page)->Init(page_id, prev_page_id, schema_);
+  else
+    page->Init(page_id, PAGE_SIZE, prev_page_id, log_manager_, txn);
+}
+
+int32_t TableHeap::GetMaxInsertSize(TablePage *page) {
+  return layout_ == PageLayout::PAX ? AsPax(page)->GetMaxInsertSize()
+                                    : page->GetMaxInsertSize();
+}
+
 } // namespace cmudb
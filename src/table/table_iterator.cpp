@@ -32,9 +32,12 @@ TableIterator &TableIterator::operator++() {
   cur_page->RLatch();
   assert(cur_page != nullptr); // all pages are pinned
 
+  bool is_pax = table_heap_->layout_ == PageLayout::PAX;
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 next_tuple_rid)) { // end of this page
+  if (!(is_pax ? table_heap_->AsPax(cur_page)->GetNextTupleRid(tuple_->rid_,
+                                                                next_tuple_rid)
+               : cur_page->GetNextTupleRid(tuple_->rid_,
+                                           next_tuple_rid))) { // end of page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
       auto next_page = static_cast<TablePage *>(
           buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
@@ -42,18 +45,28 @@ TableIterator &TableIterator::operator++() {
       buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(next_tuple_rid))
+      if (is_pax ? table_heap_->AsPax(cur_page)->GetFirstTupleRid(next_tuple_rid)
+                 : cur_page->GetFirstTupleRid(next_tuple_rid))
         break;
     }
   }
   tuple_->rid_ = next_tuple_rid;
 
+  // copy from page latched already, instead of fetching it again
   if (*this != table_heap_->end()) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+    if (is_pax)
+      table_heap_->AsPax(cur_page)->GetTuple(table_heap_->schema_, tuple_->rid_,
+                                             *tuple_, txn_,
+                                             table_heap_->lock_manager_);
+    else
+      cur_page->GetTuple(tuple_->rid_, *tuple_, txn_,
+                         table_heap_->lock_manager_);
   }
   // release until copy the tuple
   cur_page->RUnlatch();
   buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
+  if (*this != table_heap_->end())
+    table_heap_->Detoast(*tuple_);
   return *this;
 }
 
@@ -63,4 +76,46 @@ TableIterator TableIterator::operator++(int) {
   return clone;
 }
 
+TableBatchIterator::TableBatchIterator(TableHeap *table_heap,
+                                       Transaction *txn,
+                                       const std::vector<int> &column_ids,
+                                       BatchFilter *filter)
+    : table_heap_(table_heap), txn_(txn), column_ids_(column_ids),
+      filter_(filter), next_page_id_(table_heap->GetFirstPageId()) {
+  LoadBatch();
+}
+
+TableBatchIterator &TableBatchIterator::operator++() {
+  assert(!IsEnd());
+  if (++offset_ == batch_.size())
+    LoadBatch();
+  return *this;
+}
+
+void TableBatchIterator::LoadBatch() {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  batch_.clear();
+  offset_ = 0;
+  while (batch_.empty() && next_page_id_ != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(
+        buffer_pool_manager->FetchPage(next_page_id_));
+    assert(page != nullptr);
+    page->RLatch();
+    if (table_heap_->layout_ == PageLayout::PAX)
+      table_heap_->AsPax(page)->GetTuples(table_heap_->schema_, column_ids_,
+                                          pax_data_, batch_, txn_,
+                                          table_heap_->lock_manager_);
+    else
+      page->GetTuples(page_data_, batch_);
+    if (filter_ != nullptr)
+      filter_->Apply(batch_);
+    if (table_heap_->layout_ == PageLayout::ROW)
+      page->LockTuples(batch_, txn_, table_heap_->lock_manager_);
+    page_id_t page_id = next_page_id_;
+    next_page_id_ = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(page_id, false);
+  }
+}
+
 } // namespace cmudb
@@ -11,16 +11,20 @@
 
 namespace cmudb {
 
-Tuple::Tuple(std::vector<Value> values, Schema *schema) : allocated_(true) {
+Tuple::Tuple(std::vector<Value> values, Schema *schema)
+    : Tuple(values.data(), schema, nullptr) {
   assert((int)values.size() == schema->GetColumnCount());
+}
 
+Tuple::Tuple(const Value *values, Schema *schema, Arena *arena)
+    : allocated_(arena == nullptr) {
   // step1: calculate size of the tuple
   int32_t tuple_size = schema->GetLength();
   for (auto &i : schema->GetUnlinedColumns())
     tuple_size += (values[i].GetLength() + sizeof(uint32_t));
-  // allocate memory using new, allocated_ flag set as true
+  // allocate memory using new, allocated_ flag set as true, or from arena
   size_ = tuple_size;
-  data_ = new char[size_];
+  data_ = allocated_ ? new char[size_] : arena->Allocate(size_);
 
   // step2: Serialize each column(attribute) based on input value
   int column_count = schema->GetColumnCount();
@@ -0,0 +1,32 @@
+/**
+ * tuple_view.cpp
+ */
+
+#include <cassert>
+
+#include "table/tuple_view.h"
+
+namespace cmudb {
+
+Value TupleView::GetValue(Schema *schema, const int column_id) const {
+  const TypeId column_type = schema->GetType(column_id);
+  const char *data_ptr = GetDataPtr(schema, column_id);
+  if (schema->IsInlined(column_id))
+    return Value::DeserializeFrom(data_ptr, column_type);
+  uint32_t len = *reinterpret_cast<const uint32_t *>(data_ptr);
+  if (len == PELOTON_VALUE_NULL)
+    return Value(column_type, nullptr, len, false);
+  return Value(column_type, data_ptr + sizeof(uint32_t), len, false);
+}
+
+const char *TupleView::GetDataPtr(Schema *schema, const int column_id) const {
+  assert(schema);
+  assert(data_);
+  const char *data_ptr = data_ + schema->GetOffset(column_id);
+  if (schema->IsInlined(column_id))
+    return data_ptr;
+  // varchar data is at relative offset stored inline
+  return data_ + *reinterpret_cast<const int32_t *>(data_ptr);
+}
+
+} // namespace cmudb
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <sstream>
 #include <sys/stat.h>
 #include <vector>
 
@@ -38,20 +39,31 @@ int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
 
   // parse arg[4](string that defines table index)
   Index *index = nullptr;
+  ClusteredTable *clustered_table = nullptr;
   if (argc > 4) {
     std::string index_string(argv[4]);
     index_string = index_string.substr(1, (index_string.size() - 2));
     // create index object, allocate memory space
     IndexMetadata *index_metadata =
         ParseIndexStatement(index_string, std::string(argv[2]), schema);
-    index = ConstructIndex(index_metadata, buffer_pool_manager);
+    if (index_metadata->IsClustered())
+      clustered_table =
+          new ClusteredTable(index_metadata, schema, buffer_pool_manager);
+    else
+      index = ConstructIndex(index_metadata, buffer_pool_manager);
   }
   // create table object, allocate memory space
-  VirtualTable *table = new VirtualTable(schema, buffer_pool_manager,
-                                         lock_manager, log_manager, index);
-
-  // insert table root page info into header page
-  header_page->InsertRecord(std::string(argv[2]), table->GetFirstPageId());
+  VirtualTable *table =
+      new VirtualTable(schema, buffer_pool_manager, lock_manager, log_manager,
+                       index, INVALID_PAGE_ID, INVALID_PAGE_ID, clustered_table);
+
+  // insert table root page info into header page, and the first page of its
+  // free-space map. A clustered table is found by root page of its index
+  if (clustered_table == nullptr) {
+    header_page->InsertRecord(std::string(argv[2]), table->GetFirstPageId());
+    header_page->InsertRecord(std::string(argv[2]) + "_fsm",
+                              table->GetFreeSpaceMapPageId());
+  }
   buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, true);
 
   // register virtual table within sqlite system
@@ -79,10 +91,15 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   // Retrieve table root page info from header page
   HeaderPage *header_page =
       static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
-  page_id_t table_root_id;
+  page_id_t table_root_id = INVALID_PAGE_ID;
   header_page->GetRootId(std::string(argv[2]), table_root_id);
+  page_id_t free_space_map_page_id = INVALID_PAGE_ID;
+  header_page->GetRootId(std::string(argv[2]) + "_fsm",
+                         free_space_map_page_id);
   // parse arg[4](string that defines table index)
   Index *index = nullptr;
+  ClusteredTable *clustered_table = nullptr;
+  bool build_index = false;
   if (argc > 4) {
     std::string index_string(argv[4]);
     index_string = index_string.substr(1, (index_string.size() - 2));
@@ -90,13 +107,24 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
     IndexMetadata *index_metadata =
         ParseIndexStatement(index_string, std::string(argv[2]), schema);
     // Retrieve index root page info from header page
-    page_id_t index_root_id;
+    page_id_t index_root_id = INVALID_PAGE_ID;
     header_page->GetRootId(index_metadata->GetName(), index_root_id);
-    index = ConstructIndex(index_metadata, buffer_pool_manager, index_root_id);
+    if (index_metadata->IsClustered()) {
+      clustered_table = new ClusteredTable(index_metadata, schema,
+                                           buffer_pool_manager, index_root_id);
+    } else {
+      index =
+          ConstructIndex(index_metadata, buffer_pool_manager, index_root_id);
+      // index was never materialized, build it from the existing tuples
+      build_index = (index_root_id == INVALID_PAGE_ID);
+    }
   }
   VirtualTable *table =
       new VirtualTable(schema, buffer_pool_manager, lock_manager, log_manager,
-                       index, table_root_id);
+                       index, table_root_id, free_space_map_page_id,
+                       clustered_table);
+  if (build_index)
+    table->BuildIndex();
 
   // register virtual table within sqlite system
   schema_string = "CREATE TABLE X(" + schema_string + ");";
@@ -107,21 +135,80 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   return SQLITE_OK;
 }
 
+/*
+ * Comparisons of integer and decimal columns with constants, evaluated by
+ * sequential scan a page of tuples at a time(see include/table/batch_filter.h)
+ * idxNum 3 is such a scan, idxStr lists column and operator of each
+ * constraint passed in argv. SQLite checks them again, as a constant of
+ * another type is left to it(see VtabFilter())
+ */
+static void PushDownPredicates(VirtualTable *table,
+                               sqlite3_index_info *pIdxInfo) {
+  // a scan of a clustered table reads leaves one row at a time
+  if (table->GetClusteredTable() != nullptr)
+    return;
+  std::string predicates;
+  int argc = 0;
+  for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+    const auto &constraint = pIdxInfo->aConstraint[i];
+    // left by index scan not chosen
+    pIdxInfo->aConstraintUsage[i].argvIndex = 0;
+    if (constraint.usable == 0 || constraint.iColumn < 0 ||
+        !BatchFilter::IsSupported(table->GetSchema(), constraint.iColumn))
+      continue;
+    CompareOp op;
+    switch (constraint.op) {
+    case SQLITE_INDEX_CONSTRAINT_EQ:
+      op = CompareOp::EQ;
+      break;
+    case SQLITE_INDEX_CONSTRAINT_LT:
+      op = CompareOp::LT;
+      break;
+    case SQLITE_INDEX_CONSTRAINT_LE:
+      op = CompareOp::LE;
+      break;
+    case SQLITE_INDEX_CONSTRAINT_GT:
+      op = CompareOp::GT;
+      break;
+    case SQLITE_INDEX_CONSTRAINT_GE:
+      op = CompareOp::GE;
+      break;
+    default:
+      continue;
+    }
+    pIdxInfo->aConstraintUsage[i].argvIndex = ++argc;
+    predicates += std::to_string(constraint.iColumn) + " " +
+                  std::to_string(static_cast<int>(op)) + " ";
+  }
+  if (argc == 0)
+    return;
+  pIdxInfo->idxNum = 3;
+  pIdxInfo->idxStr = sqlite3_mprintf("%s", predicates.c_str());
+  pIdxInfo->needToFreeIdxStr = 1;
+}
+
 /*
  * we only support
  * (1) equlity check. e.g select * from foo where a = 1
  * (2) indexed column == predicated column
+ * idxNum 1 is an index scan, 2 one that reads only columns index entries
+ * hold(index-only scan). Otherwise predicates are pushed down to sequential
+ * scan if possible
  */
 int VtabBestIndex(sqlite3_vtab *tab, sqlite3_index_info *pIdxInfo) {
   // LOG_DEBUG("VtabBestIndex");
   VirtualTable *table = reinterpret_cast<VirtualTable *>(tab);
-  if (table->GetIndex() == nullptr)
+  if (table->GetIndex() == nullptr && table->GetClusteredTable() == nullptr) {
+    PushDownPredicates(table, pIdxInfo);
     return SQLITE_OK;
-  const std::vector<int> key_attrs = table->GetIndex()->GetKeyAttrs();
+  }
+  const std::vector<int> key_attrs = table->GetKeyAttrs();
   // make sure indexed column == predicate column
   // e.g select * from foo where a = 1 and b =2; indexed column must be {a,b}
-  if (pIdxInfo->nConstraint != (int)(key_attrs.size()))
+  if (pIdxInfo->nConstraint != (int)(key_attrs.size())) {
+    PushDownPredicates(table, pIdxInfo);
     return SQLITE_OK;
+  }
 
   int counter = 0;
   bool is_index_scan = true;
@@ -143,7 +230,9 @@ int VtabBestIndex(sqlite3_vtab *tab, sqlite3_index_info *pIdxInfo) {
   }
 
   if (counter == (int)key_attrs.size() && is_index_scan) {
-    pIdxInfo->idxNum = 1;
+    pIdxInfo->idxNum = table->IndexCovers(pIdxInfo->colUsed) ? 2 : 1;
+  } else {
+    PushDownPredicates(table, pIdxInfo);
   }
   return SQLITE_OK;
 }
@@ -190,12 +279,16 @@ int VtabFilter(sqlite3_vtab_cursor *pVtabCursor, int idxNum, const char *idxStr,
   Cursor *cursor = reinterpret_cast<Cursor *>(pVtabCursor);
   Schema *key_schema;
   // if indexed scan
-  if (idxNum == 1) {
+  if (idxNum == 1 || idxNum == 2) {
     cursor->SetScanFlag(true);
+    cursor->SetIndexOnly(idxNum == 2);
     // Construct the tuple for point query
     key_schema = cursor->GetKeySchema();
     Tuple scan_tuple = ConstructTuple(key_schema, argv);
     cursor->ScanKey(scan_tuple);
+  } else if (idxNum == 3) {
+    cursor->SetPredicates(ConstructPredicates(
+        cursor->GetVirtualTable()->GetSchema(), idxStr, argc, argv));
   }
   return SQLITE_OK;
 }
@@ -238,7 +331,12 @@ int VtabColumn(sqlite3_vtab_cursor *cur, sqlite3_context *ctx, int i) {
     sqlite3_result_double(ctx, v.GetAs<double>());
     break;
   case TypeId::VARCHAR:
-    sqlite3_result_text(ctx, v.GetData(), -1, SQLITE_TRANSIENT);
+    // length stored counts the terminating null
+    if (v.IsNull())
+      sqlite3_result_null(ctx);
+    else
+      sqlite3_result_text(ctx, v.GetData(), v.GetLength() - 1,
+                          SQLITE_TRANSIENT);
     break;
   default:
     return SQLITE_ERROR;
@@ -258,43 +356,52 @@ int VtabUpdate(sqlite3_vtab *pVTab, int argc, sqlite3_value **argv,
                sqlite_int64 *pRowid) {
   // LOG_DEBUG("VtabUpdate");
   VirtualTable *table = reinterpret_cast<VirtualTable *>(pVTab);
-  // The single row with rowid equal to argv[0] is deleted
-  if (argc == 1) {
-    const RID rid(sqlite3_value_int64(argv[0]));
-    // delete entry from index
-    table->DeleteEntry(rid);
-    // delete tuple from table heap
-    table->DeleteTuple(rid);
-  }
-  // A new row is inserted with a rowid argv[1] and column values in argv[2] and
-  // following. If argv[1] is an SQL NULL, the a new unique rowid is generated
-  // automatically.
-  else if (argc > 1 && sqlite3_value_type(argv[0]) == SQLITE_NULL) {
-    Schema *schema = table->GetSchema();
-    Tuple tuple = ConstructTuple(schema, (argv + 2));
-    // insert into table heap
-    RID rid;
-    table->InsertTuple(tuple, rid);
-    // insert into index
-    table->InsertEntry(tuple, rid);
-  }
-  // The row with rowid argv[0] is updated with new values in argv[2] and
-  // following parameters.
-  else if (argc > 1 && sqlite3_value_type(argv[0]) != SQLITE_NULL) {
-    Schema *schema = table->GetSchema();
-    Tuple tuple = ConstructTuple(schema, (argv + 2));
-    RID rid(sqlite3_value_int64(argv[0]));
-    // for update, index always delete and insert
-    // because you have no clue key has been updated or not
-    table->DeleteEntry(rid);
-    // if true, then update succeed, rid keep the same
-    // else, delete & insert
-    if (table->UpdateTuple(tuple, rid) == false) {
+  // nothing written by the previous call is needed any more
+  table->GetArena()->Reset();
+  try {
+    // The single row with rowid equal to argv[0] is deleted
+    if (argc == 1) {
+      const RID rid(sqlite3_value_int64(argv[0]));
+      // delete entry from index
+      table->DeleteEntry(rid);
+      // delete tuple from table heap
       table->DeleteTuple(rid);
-      // rid should be different
+    }
+    // A new row is inserted with a rowid argv[1] and column values in argv[2] and
+    // following. If argv[1] is an SQL NULL, the a new unique rowid is generated
+    // automatically.
+    else if (argc > 1 && sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+      Schema *schema = table->GetSchema();
+      Tuple tuple = ConstructTuple(schema, (argv + 2), table->GetArena());
+      // insert into table heap
+      RID rid;
       table->InsertTuple(tuple, rid);
+      // insert into index
+      table->InsertEntry(tuple, rid);
     }
-    table->InsertEntry(tuple, rid);
+    // The row with rowid argv[0] is updated with new values in argv[2] and
+    // following parameters.
+    else if (argc > 1 && sqlite3_value_type(argv[0]) != SQLITE_NULL) {
+      Schema *schema = table->GetSchema();
+      Tuple tuple = ConstructTuple(schema, (argv + 2), table->GetArena());
+      RID rid(sqlite3_value_int64(argv[0]));
+      // for update, index always delete and insert
+      // because you have no clue key has been updated or not
+      table->DeleteEntry(rid);
+      // if true, then update succeed, rid keep the same
+      // else, delete & insert
+      if (table->UpdateTuple(tuple, rid) == false) {
+        table->DeleteTuple(rid);
+        // rid should be different
+        table->InsertTuple(tuple, rid);
+      }
+      table->InsertEntry(tuple, rid);
+    }
+  } catch (Exception &e) {
+    // tuple is constructed before anything is written
+    sqlite3_free(pVTab->zErrMsg);
+    pVTab->zErrMsg = sqlite3_mprintf("%s", e.what());
+    return SQLITE_CONSTRAINT;
   }
   return SQLITE_OK;
 }
@@ -436,12 +543,39 @@ Schema *ParseCreateStatement(const std::string &sql_base) {
   return schema;
 }
 
+/*
+ * Remove a whitespace separated option(e.g. "nonunique") from index statement
+ * @return: true if the option was present
+ */
+static bool ExtractIndexOption(std::string &sql, const std::string &option) {
+  std::string::size_type n = 0;
+  while ((n = sql.find(option, n)) != std::string::npos) {
+    std::string::size_type end = n + option.size();
+    if ((n == 0 || sql[n - 1] == ' ') &&
+        (end == sql.size() || sql[end] == ' ')) {
+      sql.erase(n, end - n);
+      return true;
+    }
+    n = end;
+  }
+  return false;
+}
+
+/*
+ * Index statement format:
+ * "index_name column[,column...] [include column[,column...]] [nonunique]
+ *  [using btree|hash] [clustered]"
+ * Included columns are stored in B+ tree entries next to the key, queries
+ * that read no other column are answered by index only
+ * A clustered index stores the table itself, keyed by one integer column
+ */
 IndexMetadata *ParseIndexStatement(std::string &sql,
                                    const std::string &table_name,
                                    Schema *schema) {
   std::string::size_type n;
   std::string index_name;
   std::vector<int> key_attrs;
+  std::vector<int> included_attrs;
   int column_id = -1;
   // prepocess, transform sql string into lower case
   std::transform(sql.begin(), sql.end(), sql.begin(), ::tolower);
@@ -450,6 +584,22 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
   assert(n != std::string::npos);
   index_name = sql.substr(0, n);
   sql = sql.substr(n + 1);
+  // many tuples may share one key, index keeps posting lists
+  bool is_unique = !ExtractIndexOption(sql, "nonunique");
+  // rows live in index leaves instead of a table heap
+  bool is_clustered = ExtractIndexOption(sql, "clustered");
+  // hash index only serves equality lookups, which is all vtable asks for
+  IndexType index_type = IndexType::BPLUS_TREE_INDEX;
+  if (ExtractIndexOption(sql, "using hash"))
+    index_type = IndexType::HASH_INDEX;
+  else
+    ExtractIndexOption(sql, "using btree");
+  std::string included;
+  n = sql.find(" include ");
+  if (n != std::string::npos) {
+    included = sql.substr(n + std::string(" include ").size());
+    sql = sql.substr(0, n);
+  }
 
   std::vector<std::string> tok = StringUtility::Split(sql, ',');
   // iterate through returned result
@@ -461,18 +611,54 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
   }
   if ((int)key_attrs.size() > schema->GetColumnCount())
     throw Exception(EXCEPTION_TYPE_INDEX, "can't create index, format error");
+  for (std::string &t : StringUtility::Split(included, ',')) {
+    StringUtility::Trim(t);
+    column_id = schema->GetColumnID(t);
+    // key columns are in every entry already
+    if (column_id != -1 &&
+        std::find(key_attrs.begin(), key_attrs.end(), column_id) ==
+            key_attrs.end() &&
+        std::find(included_attrs.begin(), included_attrs.end(), column_id) ==
+            included_attrs.end())
+      included_attrs.emplace_back(column_id);
+  }
+  // hash buckets tell keys apart by all of their bytes
+  if (index_type == IndexType::HASH_INDEX && !included_attrs.empty())
+    throw Exception(EXCEPTION_TYPE_INDEX,
+                    "can't create index, hash index has no included columns");
+  if (is_clustered) {
+    // primary key is rowid too
+    if (index_type != IndexType::BPLUS_TREE_INDEX || !is_unique ||
+        key_attrs.size() != 1 ||
+        (schema->GetType(key_attrs[0]) != TypeId::TINYINT &&
+         schema->GetType(key_attrs[0]) != TypeId::SMALLINT &&
+         schema->GetType(key_attrs[0]) != TypeId::INTEGER &&
+         schema->GetType(key_attrs[0]) != TypeId::BIGINT))
+      throw Exception(EXCEPTION_TYPE_INDEX,
+                      "can't create index, clustered index is a unique B+ "
+                      "tree on one integer column");
+    // every other column rides along in leaves
+    included_attrs.clear();
+    for (int i = 0; i < schema->GetColumnCount(); i++) {
+      if (i != key_attrs[0])
+        included_attrs.emplace_back(i);
+    }
+  }
 
   IndexMetadata *metadata =
-      new IndexMetadata(index_name, table_name, schema, key_attrs);
+      new IndexMetadata(index_name, table_name, schema, key_attrs, is_unique,
+                        index_type, included_attrs, is_clustered);
 
   // LOG_DEBUG("%s", metadata->ToString().c_str());
   return metadata;
 }
 
-Tuple ConstructTuple(Schema *schema, sqlite3_value **argv) {
+Tuple ConstructTuple(Schema *schema, sqlite3_value **argv, Arena *arena) {
   int column_count = schema->GetColumnCount();
   Value v(TypeId::INVALID);
-  std::vector<Value> values;
+  std::vector<Value, ArenaAllocator<Value>> values{
+      ArenaAllocator<Value>(arena)};
+  values.reserve(column_count);
   // iterate through schema, generate column value to insert
   for (int i = 0; i < column_count; i++) {
     TypeId type = schema->GetType(i);
@@ -490,46 +676,113 @@ Tuple ConstructTuple(Schema *schema, sqlite3_value **argv) {
     case TypeId::DECIMAL:
       v = Value(type, sqlite3_value_double(argv[i]));
       break;
-    case TypeId::VARCHAR:
-      v = Value(type, std::string(reinterpret_cast<const char *>(
-                          sqlite3_value_text(argv[i]))));
+    case TypeId::VARCHAR: {
+      // text first, bytes then counts the converted text
+      const char *text =
+          reinterpret_cast<const char *>(sqlite3_value_text(argv[i]));
+      int bytes = sqlite3_value_bytes(argv[i]);
+      // index key size is derived from declared length, see ConstructIndex()
+      if (bytes > schema->GetVariableLength(i))
+        throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                        "value is longer than declared varchar length");
+      // no copy, text stays valid until tuple is serialized below
+      v = Value(type, text, bytes + 1, false);
       break;
+    }
     default:
       break;
     } // End of switch
     values.emplace_back(v);
   }
-  Tuple tuple(values, schema);
+  Tuple tuple(values.data(), schema, arena);
 
   return tuple;
 }
 
+/*
+ * Predicates listed in idxStr by PushDownPredicates(), compared with argv.
+ * A constant has to be of the type of its column, an integer one of a
+ * decimal column as well while double holds it exactly. One that is not
+ * is left to SQLite
+ */
+std::vector<ScanPredicate> ConstructPredicates(Schema *schema,
+                                               const char *idxStr, int argc,
+                                               sqlite3_value **argv) {
+  // largest integer a double holds exactly
+  const int64_t max_exact_integer = int64_t(1) << 53;
+  std::vector<ScanPredicate> predicates;
+  std::istringstream stream(idxStr);
+  for (int i = 0; i < argc; i++) {
+    ScanPredicate predicate;
+    int op;
+    stream >> predicate.column_id >> op;
+    predicate.op = static_cast<CompareOp>(op);
+    int value_type = sqlite3_value_type(argv[i]);
+    if (schema->GetType(predicate.column_id) != TypeId::DECIMAL) {
+      if (value_type != SQLITE_INTEGER)
+        continue;
+      predicate.integer = sqlite3_value_int64(argv[i]);
+    } else if (value_type == SQLITE_FLOAT) {
+      predicate.decimal = sqlite3_value_double(argv[i]);
+    } else if (value_type == SQLITE_INTEGER) {
+      int64_t integer = sqlite3_value_int64(argv[i]);
+      if (integer > max_exact_integer || integer < -max_exact_integer)
+        continue;
+      predicate.decimal = static_cast<double>(integer);
+    } else {
+      continue;
+    }
+    predicates.push_back(predicate);
+  }
+  return predicates;
+}
+
+template <size_t KeySize>
+static Index *NewIndex(IndexMetadata *metadata,
+                       BufferPoolManager *buffer_pool_manager,
+                       page_id_t root_id) {
+  if (metadata->GetIndexType() == IndexType::HASH_INDEX)
+    return new HashIndex<GenericKey<KeySize>, RID>(metadata,
+                                                  buffer_pool_manager, root_id);
+  return new BPlusTreeIndex<GenericKey<KeySize>, RID,
+                            GenericComparator<KeySize>>(
+      metadata, buffer_pool_manager, root_id);
+}
+
 // serve the functionality of index factory
 Index *ConstructIndex(IndexMetadata *metadata,
                       BufferPoolManager *buffer_pool_manager,
                       page_id_t root_id) {
-  // The size of the key in bytes
-  Schema *key_schema = metadata->GetKeySchema();
+  // The size of the key in bytes, included columns are stored in key too
+  Schema *key_schema = metadata->GetEntrySchema();
   int key_size = key_schema->GetLength();
-  // for each varchar attribute, we assume the largest size is 16 bytes
-  key_size += 16 * key_schema->GetUnlinedColumnCount();
+  // each varchar attribute is stored after inlined ones, 4 bytes of length
+  // then at most declared length of characters plus terminating null.
+  // Pages do not store trailing zero bytes of a key, so a larger key size only
+  // costs space for keys that are actually that long
+  for (int column_id : key_schema->GetUnlinedColumns())
+    key_size += sizeof(uint32_t) + key_schema->GetVariableLength(column_id) + 1;
 
   if (key_size <= 4) {
-    return new BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>(
-        metadata, buffer_pool_manager, root_id);
+    return NewIndex<4>(metadata, buffer_pool_manager, root_id);
   } else if (key_size <= 8) {
-    return new BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(
-        metadata, buffer_pool_manager, root_id);
+    return NewIndex<8>(metadata, buffer_pool_manager, root_id);
   } else if (key_size <= 16) {
-    return new BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>(
-        metadata, buffer_pool_manager, root_id);
+    return NewIndex<16>(metadata, buffer_pool_manager, root_id);
   } else if (key_size <= 32) {
-    return new BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>(
-        metadata, buffer_pool_manager, root_id);
-  } else {
-    return new BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>(
-        metadata, buffer_pool_manager, root_id);
+    return NewIndex<32>(metadata, buffer_pool_manager, root_id);
+  } else if (key_size <= 64) {
+    return NewIndex<64>(metadata, buffer_pool_manager, root_id);
+  } else if (key_size <= 128) {
+    return NewIndex<128>(metadata, buffer_pool_manager, root_id);
+  } else if (key_size <= 224) {
+    // NOTE: with 512 byte pages, a leaf holds just one pair of the longest
+    // key and an internal page just two children, next to a high key that
+    // may be as long
+    return NewIndex<256>(metadata, buffer_pool_manager, root_id);
   }
+  throw Exception(EXCEPTION_TYPE_INDEX,
+                  "can't create index, key is longer than 224 bytes");
 }
 
 Transaction *GetTransaction() { return global_transaction_; }
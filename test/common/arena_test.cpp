@@ -0,0 +1,54 @@
+/**
+ * arena_test.cpp
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "common/arena.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ArenaTest, AllocateResetTest) {
+  Arena arena(64);
+  char *first = arena.Allocate(3);
+  char *second = arena.Allocate(8);
+  // aligned, and apart from each other
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 8, 0u);
+  EXPECT_EQ(second - first, 8);
+  memset(first, 'a', 3);
+  memset(second, 'b', 8);
+  EXPECT_EQ(first[2], 'a');
+  EXPECT_EQ(arena.GetBlockCount(), 1u);
+
+  // a larger allocation gets a block of its own
+  char *large = arena.Allocate(200);
+  memset(large, 'c', 200);
+  EXPECT_EQ(arena.GetBlockCount(), 2u);
+  EXPECT_EQ(second[7], 'b');
+
+  // blocks are kept and handed out again
+  arena.Reset();
+  EXPECT_EQ(arena.Allocate(3), first);
+  arena.Allocate(100);
+  EXPECT_EQ(arena.GetBlockCount(), 2u);
+}
+
+TEST(ArenaTest, AllocatorTest) {
+  Arena arena;
+  std::vector<int, ArenaAllocator<int>> values{ArenaAllocator<int>(&arena)};
+  for (int i = 0; i < 1000; i++)
+    values.push_back(i);
+  for (int i = 0; i < 1000; i++)
+    EXPECT_EQ(values[i], i);
+
+  // no arena, global heap
+  std::vector<int, ArenaAllocator<int>> heap_values{
+      ArenaAllocator<int>(nullptr)};
+  heap_values.assign(values.begin(), values.end());
+  EXPECT_EQ(heap_values.back(), 999);
+}
+
+} // namespace cmudb
@@ -668,6 +668,55 @@ TEST(LockManagerTest, DeadlockTest3) {
   thread1.join();
 }
 
+// an uncontended shared lock must be recorded in the transaction, or commit
+// never releases it, and must reset the mode left by a released exclusive lock
+TEST(LockManagerTest, UncontendedSharedTest) {
+  LockManager lock_mgr{true};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID rid{0, 0};
+
+  Transaction txn0(0);
+  EXPECT_EQ(lock_mgr.LockExclusive(&txn0, rid), true);
+  txn_mgr.Commit(&txn0);
+
+  Transaction txn1(1);
+  EXPECT_EQ(lock_mgr.LockShared(&txn1, rid), true);
+  EXPECT_EQ(txn1.GetSharedLockSet()->count(rid), 1U);
 
+  // shares the lock instead of dying behind an exclusive one
+  Transaction txn2(2);
+  EXPECT_EQ(lock_mgr.LockShared(&txn2, rid), true);
+  EXPECT_EQ(txn2.GetState(), TransactionState::GROWING);
+
+  txn_mgr.Commit(&txn1);
+  txn_mgr.Commit(&txn2);
+
+  // younger writer gets the lock once readers are gone
+  Transaction txn3(3);
+  EXPECT_EQ(lock_mgr.LockExclusive(&txn3, rid), true);
+  EXPECT_EQ(txn3.GetState(), TransactionState::GROWING);
+  txn_mgr.Commit(&txn3);
+}
+
+// under strict 2PL commit releases every lock, not only the first one
+TEST(LockManagerTest, CommitReleasesAllTest) {
+  LockManager lock_mgr{true};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID rid{0, 0};
+  RID rid2{0, 1};
+
+  Transaction txn0(0);
+  EXPECT_EQ(lock_mgr.LockExclusive(&txn0, rid), true);
+  EXPECT_EQ(lock_mgr.LockExclusive(&txn0, rid2), true);
+  txn_mgr.Commit(&txn0);
+  EXPECT_EQ(txn0.GetState(), TransactionState::COMMITTED);
+  EXPECT_EQ(txn0.GetExclusiveLockSet()->size(), 0U);
+
+  Transaction txn1(1);
+  EXPECT_EQ(lock_mgr.LockExclusive(&txn1, rid), true);
+  EXPECT_EQ(lock_mgr.LockExclusive(&txn1, rid2), true);
+  EXPECT_EQ(txn1.GetState(), TransactionState::GROWING);
+  txn_mgr.Commit(&txn1);
+}
 
 } // namespace cmudb
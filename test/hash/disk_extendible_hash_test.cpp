@@ -0,0 +1,302 @@
+/**
+ * disk_extendible_hash_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+#include "buffer/buffer_pool_manager.h"
+#include "hash/disk_extendible_hash.h"
+#include "index/b_plus_tree.h"
+#include "page/header_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(DiskExtendibleHashTest, InsertTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  DiskExtendibleHash<GenericKey<8>, RID> table("foo_pk", bpm);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+
+  std::vector<int64_t> keys;
+  int64_t scale = 10000;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table.Insert(index_key, RID(0, key)));
+  }
+  // unique key goes in once
+  index_key.SetFromInteger(1);
+  EXPECT_FALSE(table.Insert(index_key, RID(0, 2)));
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= scale + 10; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(table.GetValue(index_key, rids), key <= scale);
+    if (key <= scale) {
+      EXPECT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+  }
+
+  // every directory slot points to a bucket with no more bits than directory
+  int global_depth = table.GetGlobalDepth();
+  EXPECT_GT(global_depth, 0);
+  int slots = 0;
+  for (uint32_t i = 0; i < (1u << global_depth); i++) {
+    int local_depth = table.GetLocalDepth(i);
+    EXPECT_GE(local_depth, 0);
+    EXPECT_LE(local_depth, global_depth);
+    if (i < (1u << local_depth))
+      slots += 1 << (global_depth - local_depth);
+  }
+  EXPECT_EQ(slots, 1 << global_depth);
+  EXPECT_EQ(table.GetLocalDepth(1u << global_depth), -1);
+  std::cout << "global depth " << global_depth << ", "
+            << table.GetNumBuckets() << " buckets" << std::endl;
+
+  // reopen from directory page id recorded in header page
+  page_id_t directory_page_id;
+  EXPECT_TRUE(static_cast<HeaderPage *>(header_page)
+                  ->GetRootId("foo_pk", directory_page_id));
+  DiskExtendibleHash<GenericKey<8>, RID> reopened("foo_pk", bpm,
+                                                  directory_page_id);
+  rids.clear();
+  index_key.SetFromInteger(scale / 2);
+  EXPECT_TRUE(reopened.GetValue(index_key, rids));
+  EXPECT_EQ(rids[0].GetSlotNum(), scale / 2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskExtendibleHashTest, DeleteTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  DiskExtendibleHash<GenericKey<8>, RID> table("foo_pk", bpm);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+
+  int64_t scale = 5000;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= scale; key++) {
+    index_key.SetFromInteger(key);
+    table.Insert(index_key, RID(0, key));
+  }
+  int buckets = table.GetNumBuckets();
+
+  // wrong value leaves the key alone
+  std::vector<RID> rids;
+  index_key.SetFromInteger(1);
+  table.Remove(index_key, RID(0, 2));
+  EXPECT_TRUE(table.GetValue(index_key, rids));
+
+  for (int64_t key = 1; key <= scale; key += 2) {
+    index_key.SetFromInteger(key);
+    table.Remove(index_key, RID(0, key));
+  }
+  for (int64_t key = 1; key <= scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(table.GetValue(index_key, rids), key % 2 == 0);
+  }
+  EXPECT_LE(table.GetNumBuckets(), buckets);
+
+  // emptied buckets merge back and directory shrinks
+  for (int64_t key = 2; key <= scale; key += 2) {
+    index_key.SetFromInteger(key);
+    table.Remove(index_key, RID(0, key));
+  }
+  EXPECT_EQ(table.GetGlobalDepth(), 0);
+  EXPECT_EQ(table.GetNumBuckets(), 1);
+
+  // and grows again
+  for (int64_t key = 1; key <= scale; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table.Insert(index_key, RID(0, key)));
+  }
+  for (int64_t key = 1; key <= scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table.GetValue(index_key, rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskExtendibleHashTest, NonUniqueKeyTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  DiskExtendibleHash<GenericKey<8>, RID> table("foo_b", bpm, INVALID_PAGE_ID,
+                                               false);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+
+  // values of one key outgrow a page, no hash bit tells them apart
+  int64_t keys = 3;
+  int values = 200;
+  GenericKey<8> index_key;
+  for (int i = 0; i < values; i++) {
+    for (int64_t key = 0; key < keys; key++) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(table.Insert(index_key, RID(key, i)));
+    }
+  }
+  index_key.SetFromInteger(0);
+  EXPECT_FALSE(table.Insert(index_key, RID(0, 0)));
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table.GetValue(index_key, rids));
+    EXPECT_EQ(rids.size(), values);
+    for (auto &rid : rids)
+      EXPECT_EQ(rid.GetPageId(), key);
+  }
+
+  index_key.SetFromInteger(1);
+  for (int i = 0; i < values; i += 2)
+    table.Remove(index_key, RID(1, i));
+  rids.clear();
+  EXPECT_TRUE(table.GetValue(index_key, rids));
+  EXPECT_EQ(rids.size(), values / 2);
+  for (auto &rid : rids)
+    EXPECT_EQ(rid.GetSlotNum() % 2, 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskExtendibleHashTest, ConcurrentTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  DiskExtendibleHash<GenericKey<8>, RID> table("foo_pk", bpm);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+
+  int64_t scale = 8000;
+  int num_threads = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.push_back(std::thread([&table, scale, num_threads, t]() {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t key = t + 1; key <= scale; key += num_threads) {
+        index_key.SetFromInteger(key);
+        table.Insert(index_key, RID(0, key));
+        rids.clear();
+        table.GetValue(index_key, rids);
+        EXPECT_EQ(rids.size(), 1);
+        // drop every other key again
+        if (key % 2 == 0)
+          table.Remove(index_key, RID(0, key));
+      }
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(table.GetValue(index_key, rids), key % 2 == 1);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskExtendibleHashTest, PointLookupBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  DiskExtendibleHash<GenericKey<8>, RID> table("foo_hash", bpm);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+  Transaction *transaction = new Transaction(0);
+
+  int64_t scale = 10000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key), transaction);
+    table.Insert(index_key, RID(0, key));
+  }
+
+  std::random_shuffle(keys.begin(), keys.end());
+  std::vector<RID> rids;
+  auto start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, rids, transaction);
+    EXPECT_EQ(rids.size(), 1);
+  }
+  double tree_time = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+  start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    table.GetValue(index_key, rids);
+    EXPECT_EQ(rids.size(), 1);
+  }
+  double hash_time = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  std::cout << "B+ tree " << (int64_t)(scale / tree_time)
+            << " lookups/s, extendible hash "
+            << (int64_t)(scale / hash_time) << " lookups/s" << std::endl;
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
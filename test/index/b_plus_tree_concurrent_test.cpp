@@ -3,10 +3,12 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdio>
 #include <functional>
 #include <iostream>
+#include <set>
 #include <thread>
 
 #include "buffer/buffer_pool_manager.h"
@@ -95,12 +97,124 @@ void DeleteHelperSplit(
     if ((uint64_t) key%total_threads == thread_itr) {
       index_key.SetFromInteger(key);
       tree.Remove(index_key, transaction);
-      std::cout << "removing " << key << std::endl;
     }
   }
   delete transaction;
 }
 
+// helper function to insert keys split among threads in batches
+void InsertBatchHelperSplit(
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> &tree,
+    const std::vector<int64_t> &keys, int total_threads, size_t batch_size,
+    uint64_t thread_itr) {
+  std::vector<std::pair<GenericKey<8>, RID>> batch;
+  GenericKey<8> index_key;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+  for (auto key : keys) {
+    if ((uint64_t) key % total_threads == thread_itr) {
+      index_key.SetFromInteger(key);
+      batch.emplace_back(index_key, RID((int32_t) (key >> 32),
+                                        key & 0xFFFFFFFF));
+    }
+    if (batch.size() == batch_size) {
+      tree.InsertBatch(batch, transaction);
+      batch.clear();
+    }
+  }
+  tree.InsertBatch(batch, transaction);
+  delete transaction;
+}
+
+// helper function to look up keys that stay in tree until stop is set
+void LookupHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> &tree,
+                  const std::vector<int64_t> &keys, std::atomic<bool> &stop,
+                  std::atomic<int64_t> &lookups, std::atomic<int64_t> &misses,
+                  __attribute__((unused)) uint64_t thread_itr = 0) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+  while (!stop) {
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      if (!tree.GetValue(index_key, rids, transaction)) {
+        misses++;
+      }
+      lookups++;
+    }
+  }
+  delete transaction;
+}
+
+// helper function to look up keys that stay in tree in batches
+void MultiGetHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> &tree,
+                    const std::vector<int64_t> &keys, std::atomic<bool> &stop,
+                    std::atomic<int64_t> &lookups,
+                    std::atomic<int64_t> &misses) {
+  std::vector<GenericKey<8>> batch(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    batch[i].SetFromInteger(keys[i]);
+  }
+  std::vector<std::vector<RID>> results;
+  Transaction *transaction = new Transaction(0);
+  while (!stop) {
+    tree.MultiGet(batch, results, transaction);
+    for (auto &values : results) {
+      if (values.empty()) {
+        misses++;
+      }
+    }
+    lookups += batch.size();
+  }
+  delete transaction;
+}
+
+// helper function to scan forward or backward until stop is set, every key
+// that stays in tree must be seen once and in order
+void ScanHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> &tree,
+                const std::vector<int64_t> &keys, std::atomic<bool> &stop,
+                std::atomic<int64_t> &misses, uint64_t thread_itr) {
+  std::set<int64_t> expected(keys.begin(), keys.end());
+  do {
+    std::vector<int64_t> seen;
+    if (thread_itr % 2 == 0) {
+      for (auto iterator = tree.Begin(); !iterator.isEnd(); ++iterator) {
+        seen.push_back((*iterator).second.GetSlotNum());
+      }
+    } else {
+      for (auto iterator = tree.RBegin(); !iterator.isEnd(); --iterator) {
+        seen.push_back((*iterator).second.GetSlotNum());
+      }
+      std::reverse(seen.begin(), seen.end());
+    }
+    size_t found = 0;
+    for (size_t i = 0; i < seen.size(); i++) {
+      if (i > 0 && seen[i - 1] >= seen[i]) {
+        misses++;
+      }
+      found += expected.count(seen[i]);
+    }
+    if (found != expected.size()) {
+      misses++;
+    }
+  } while (!stop);
+}
+
+// helper function to scan one partition, counting keys seen in order
+void PartitionScanHelper(
+    IndexIterator<GenericKey<8>, RID, GenericComparator<8>> &iterator,
+    int64_t &count, std::atomic<int64_t> &misses) {
+  int64_t last = 0;
+  for (; !iterator.isEnd(); ++iterator) {
+    int64_t key = (*iterator).second.GetSlotNum();
+    if (key <= last) {
+      misses++;
+    }
+    last = key;
+    count++;
+  }
+}
 
 TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
@@ -217,6 +331,46 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, InsertBatchTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  // ascending keys, threads append to the same leaves
+  std::vector<int64_t> keys;
+  int64_t scale = 10000;
+  for (int64_t key = 1; key <= scale; key++) {
+    keys.push_back(key);
+  }
+  LaunchParallelTest(4, InsertBatchHelperSplit, std::ref(tree), keys, 4, 100);
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, rids);
+    EXPECT_EQ(rids.size(), 1);
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator.isEnd() == false; ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, scale + 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
@@ -429,6 +583,317 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
 }
 
 
+/*
+ * Insert and delete throughput with 1..8 threads writing disjoint keys.
+ * Writers only write latch the leaf page unless it may split or underflow, so
+ * throughput should not collapse as threads are added.
+ */
+TEST(BPlusTreeConcurrentTest, ThroughputBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  int64_t scale = 10000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++) {
+    keys.push_back(key);
+  }
+  std::random_shuffle(keys.begin(), keys.end());
+
+  for (int threads = 1; threads <= 8; threads *= 2) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    page_id_t page_id;
+    bpm->NewPage(page_id);
+
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallelTest(threads, InsertHelperSplit, std::ref(tree), keys,
+                       threads);
+    double insert_time = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+    std::vector<RID> rids;
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, rids);
+      EXPECT_EQ(rids.size(), 1);
+    }
+
+    std::vector<int64_t> remove_keys(keys.begin(), keys.begin() + scale / 2);
+    start = std::chrono::steady_clock::now();
+    LaunchParallelTest(threads, DeleteHelperSplit, std::ref(tree),
+                       remove_keys, threads);
+    double remove_time = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    for (size_t i = 0; i < keys.size(); i++) {
+      rids.clear();
+      index_key.SetFromInteger(keys[i]);
+      EXPECT_EQ(tree.GetValue(index_key, rids), i >= remove_keys.size());
+    }
+
+    std::cout << threads << " threads: " << (int64_t)(scale / insert_time)
+              << " inserts/s, " << (int64_t)(remove_keys.size() / remove_time)
+              << " deletes/s" << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+/*
+ * Delete half of the keys with eager and with lazy merges(rebalanced by a
+ * background thread) while other threads look up the other half
+ */
+TEST(BPlusTreeConcurrentTest, LazyMergeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  std::vector<int64_t> stay_keys;
+  std::vector<int64_t> delete_keys;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 10000; key++) {
+    (key % 2 == 0 ? stay_keys : delete_keys).push_back(key);
+    keys.push_back(key);
+  }
+  std::random_shuffle(keys.begin(), keys.end());
+  std::random_shuffle(delete_keys.begin(), delete_keys.end());
+
+  for (int lazy = 0; lazy < 2; lazy++) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    tree.SetLazyMerge(lazy);
+    page_id_t page_id;
+    bpm->NewPage(page_id);
+    InsertHelper(tree, keys);
+
+    std::atomic<bool> stop(false);
+    std::atomic<int64_t> lookups(0);
+    std::atomic<int64_t> misses(0);
+    std::vector<std::thread> readers;
+    for (uint64_t i = 0; i < 2; i++) {
+      readers.push_back(std::thread(LookupHelper, std::ref(tree),
+                                    std::ref(stay_keys), std::ref(stop),
+                                    std::ref(lookups), std::ref(misses), i));
+    }
+    if (lazy) {
+      tree.RunRebalanceThread(std::chrono::milliseconds(1));
+    }
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallelTest(2, DeleteHelperSplit, std::ref(tree), delete_keys, 2);
+    double elapsed = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    tree.StopRebalanceThread();
+    stop = true;
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    EXPECT_EQ(misses, 0);
+    std::cout << (lazy ? "lazy" : "eager") << " merge: "
+              << (int64_t)(delete_keys.size() / elapsed) << " deletes/s"
+              << std::endl;
+
+    tree.Rebalance();
+    std::vector<RID> rids;
+    GenericKey<8> index_key;
+    for (int64_t key = 1; key <= 10000; key++) {
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(tree.GetValue(index_key, rids), key % 2 == 0);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+/*
+ * Scan the whole tree with 1 to 8 threads, one partition each
+ */
+TEST(BPlusTreeConcurrentTest, PartitionedScanBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  int64_t scale = 10000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++) {
+    keys.push_back(key);
+  }
+  std::random_shuffle(keys.begin(), keys.end());
+  InsertHelper(tree, keys);
+
+  int rounds = 20;
+  for (int threads = 1; threads <= 8; threads *= 2) {
+    std::atomic<int64_t> misses(0);
+    int64_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+      auto iterators = tree.BeginPartitions(threads);
+      std::vector<int64_t> counts(iterators.size(), 0);
+      std::vector<std::thread> scanners;
+      for (size_t i = 0; i < iterators.size(); i++) {
+        scanners.push_back(std::thread(PartitionScanHelper,
+                                       std::ref(iterators[i]),
+                                       std::ref(counts[i]), std::ref(misses)));
+      }
+      for (auto &scanner : scanners) {
+        scanner.join();
+      }
+      for (auto count : counts) {
+        total += count;
+      }
+    }
+    double elapsed = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    EXPECT_EQ(misses, 0);
+    EXPECT_EQ(total, scale * rounds);
+    std::cout << threads << " threads: " << (int64_t)(total / elapsed)
+              << " keys/s" << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Point queries(one key at a time or in batches) on keys that stay in tree
+ * never miss while other threads split pages by inserting and merge them by
+ * deleting. Readers hold one latch at a time and move right past concurrent
+ * splits.
+ */
+TEST(BPlusTreeConcurrentTest, ReadDuringWriteTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  // even keys are read all along, odd keys are inserted then deleted
+  std::vector<int64_t> stay_keys;
+  std::vector<int64_t> write_keys;
+  for (int64_t key = 1; key <= 5000; key++) {
+    (key % 2 == 0 ? stay_keys : write_keys).push_back(key);
+  }
+  std::random_shuffle(write_keys.begin(), write_keys.end());
+  InsertHelper(tree, stay_keys);
+
+  for (int phase = 0; phase < 2; phase++) {
+    std::atomic<bool> stop(false);
+    std::atomic<int64_t> lookups(0);
+    std::atomic<int64_t> misses(0);
+    std::vector<std::thread> readers;
+    for (uint64_t i = 0; i < 2; i++) {
+      readers.push_back(std::thread(LookupHelper, std::ref(tree),
+                                    std::ref(stay_keys), std::ref(stop),
+                                    std::ref(lookups), std::ref(misses), i));
+    }
+    readers.push_back(std::thread(MultiGetHelper, std::ref(tree),
+                                  std::ref(stay_keys), std::ref(stop),
+                                  std::ref(lookups), std::ref(misses)));
+    auto start = std::chrono::steady_clock::now();
+    if (phase == 0) {
+      LaunchParallelTest(2, InsertHelperSplit, std::ref(tree), write_keys, 2);
+    } else {
+      LaunchParallelTest(2, DeleteHelperSplit, std::ref(tree), write_keys, 2);
+    }
+    double elapsed = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    stop = true;
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    EXPECT_EQ(misses, 0);
+    std::cout << (phase == 0 ? "insert" : "delete") << " phase: "
+              << (int64_t)(lookups / elapsed) << " lookups/s" << std::endl;
+  }
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (auto key : write_keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_FALSE(tree.GetValue(index_key, rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+/*
+ * Forward and backward scans see every key that stays in tree exactly once
+ * and in order while other threads split and merge leaf pages
+ */
+TEST(BPlusTreeConcurrentTest, ScanDuringWriteTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  std::vector<int64_t> stay_keys;
+  std::vector<int64_t> write_keys;
+  for (int64_t key = 1; key <= 4000; key++) {
+    (key % 2 == 0 ? stay_keys : write_keys).push_back(key);
+  }
+  std::random_shuffle(write_keys.begin(), write_keys.end());
+  InsertHelper(tree, stay_keys);
+
+  for (int phase = 0; phase < 2; phase++) {
+    std::atomic<bool> stop(false);
+    std::atomic<int64_t> misses(0);
+    std::vector<std::thread> scanners;
+    for (uint64_t i = 0; i < 2; i++) {
+      scanners.push_back(std::thread(ScanHelper, std::ref(tree),
+                                     std::ref(stay_keys), std::ref(stop),
+                                     std::ref(misses), i));
+    }
+    if (phase == 0) {
+      LaunchParallelTest(2, InsertHelperSplit, std::ref(tree), write_keys, 2);
+    } else {
+      LaunchParallelTest(2, DeleteHelperSplit, std::ref(tree), write_keys, 2);
+    }
+    stop = true;
+    for (auto &scanner : scanners) {
+      scanner.join();
+    }
+    EXPECT_EQ(misses, 0);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 /*
 TEST(BPlusTreeConcurrentTest, MixTest3) {
   // create KeyComparator and index schema
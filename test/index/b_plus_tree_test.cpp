@@ -3,8 +3,11 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <map>
+#include <set>
 #include <sstream>
 
 #include "buffer/buffer_pool_manager.h"
@@ -1038,5 +1041,894 @@ TEST(BPlusTreeTests, RandomTestQuick) {
   remove("test.log");
 }
 
+TEST(BPlusTreeTests, BulkLoadTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+
+  int64_t scale = 10000;
+  std::vector<std::pair<GenericKey<8>, RID>> items;
+  for (int64_t key = 1; key < scale; key++) {
+    index_key.SetFromInteger(key);
+    rid.Set((int32_t) (key >> 32), key & 0xFFFFFFFF);
+    items.emplace_back(index_key, rid);
+  }
+
+  // unsorted input is rejected and leaves the tree empty
+  std::swap(items[10], items[20]);
+  EXPECT_FALSE(tree.BulkLoad(items));
+  EXPECT_TRUE(tree.IsEmpty());
+  std::swap(items[10], items[20]);
+
+  EXPECT_TRUE(tree.BulkLoad(items, 0.7));
+  // only an empty tree can be bulk loaded
+  EXPECT_FALSE(tree.BulkLoad(items));
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key < scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, rids);
+    EXPECT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator.isEnd() == false;
+       ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, scale);
+
+  // loaded tree keeps growing and shrinking like any other tree
+  for (int64_t key = scale; key < scale + 1000; key++) {
+    index_key.SetFromInteger(key);
+    rid.Set((int32_t) (key >> 32), key & 0xFFFFFFFF);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  for (int64_t key = 1; key < scale; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  int64_t size = 0;
+  current_key = scale;
+  for (auto iterator = tree.Begin(); iterator.isEnd() == false;
+       ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+    size = size + 1;
+  }
+  EXPECT_EQ(size, 1000);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Build time of bulk loading vs. one Insert per key. Scale matches the other
+ * tests so it runs with a 50 frame buffer pool, raise both for a real
+ * measurement.
+ */
+TEST(BPlusTreeTests, BulkLoadBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  int64_t scale = 10000;
+  std::vector<std::pair<GenericKey<8>, RID>> items;
+  for (int64_t key = 0; key < scale; key++) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    items.emplace_back(index_key, RID((int32_t) (key >> 32), key & 0xFFFFFFFF));
+  }
+
+  double elapsed[2];
+  for (int bulk = 0; bulk < 2; bulk++) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    Transaction *transaction = new Transaction(0);
+    page_id_t page_id;
+    bpm->NewPage(page_id);
+
+    auto start = std::chrono::steady_clock::now();
+    if (bulk) {
+      EXPECT_TRUE(tree.BulkLoad(items));
+    } else {
+      for (auto &item : items)
+        tree.Insert(item.first, item.second, transaction);
+    }
+    elapsed[bulk] = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+    std::vector<RID> rids;
+    EXPECT_TRUE(tree.GetValue(items[scale / 2].first, rids));
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  std::cout << "build " << scale << " keys: insert " << elapsed[0]
+            << " ms, bulk load " << elapsed[1] << " ms" << std::endl;
+  EXPECT_LT(elapsed[1], elapsed[0]);
+}
+
+
+TEST(BPlusTreeTests, NonUniqueKeyTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create non-unique b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree(
+      "foo_idx", bpm, comparator, INVALID_PAGE_ID, false);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+
+  // key k is shared by k * 40 record ids, spanning several posting pages
+  int64_t keys = 10;
+  for (int64_t slot = 0; slot < keys * 40; slot++) {
+    for (int64_t key = 1; key <= keys; key++) {
+      if (slot < key * 40) {
+        index_key.SetFromInteger(key);
+        rid.Set((int32_t) key, slot);
+        EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+      }
+    }
+  }
+  // key with a single record id stays inline
+  index_key.SetFromInteger(keys + 1);
+  rid.Set(0, 0);
+  EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  EXPECT_FALSE(tree.Insert(index_key, rid, transaction));
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= keys + 1; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, rids, transaction));
+    EXPECT_EQ(rids.size(), key <= keys ? key * 40 : 1);
+    std::sort(rids.begin(), rids.end(), [](const RID &lhs, const RID &rhs) {
+      return lhs.GetSlotNum() < rhs.GetSlotNum();
+    });
+    for (size_t i = 0; i < rids.size(); i++) {
+      EXPECT_EQ(rids[i].GetSlotNum(), i);
+    }
+  }
+
+  // remove every odd slot of key 5, missing values are ignored
+  index_key.SetFromInteger(5);
+  for (int64_t slot = 1; slot < 5 * 40; slot += 2) {
+    rid.Set(5, slot);
+    tree.Remove(index_key, rid, transaction);
+  }
+  rid.Set(6, 0);
+  tree.Remove(index_key, rid, transaction);
+  rids.clear();
+  tree.GetValue(index_key, rids, transaction);
+  EXPECT_EQ(rids.size(), 100);
+  for (auto &r : rids) {
+    EXPECT_EQ(r.GetSlotNum() % 2, 0);
+  }
+
+  // key 1 shrinks back to an inline value, then goes away with the last one
+  index_key.SetFromInteger(1);
+  for (int64_t slot = 0; slot < 40; slot++) {
+    rid.Set(1, slot);
+    tree.Remove(index_key, rid, transaction);
+    rids.clear();
+    EXPECT_EQ(tree.GetValue(index_key, rids, transaction), slot < 39);
+    EXPECT_EQ(rids.size(), 39 - slot);
+  }
+
+  // removing a key drops its whole posting list
+  index_key.SetFromInteger(keys);
+  tree.Remove(index_key, transaction);
+  rids.clear();
+  EXPECT_FALSE(tree.GetValue(index_key, rids, transaction));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+// iterators return every value of a non-unique key, not its posting list
+TEST(BPlusTreeTests, NonUniqueIteratorTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree(
+      "foo_idx", bpm, comparator, INVALID_PAGE_ID, false);
+  GenericKey<8> index_key;
+  GenericKey<8> end_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+
+  // keys up to 5 are shared by k * 50 record ids, from key 2 on spanning
+  // several posting pages, inserting any of them again changes nothing
+  int64_t keys = 400;
+  for (int64_t key = 1; key <= keys; key++) {
+    index_key.SetFromInteger(key);
+    for (int64_t slot = 0; slot < (key <= 5 ? key * 50 : 1); slot++) {
+      rid.Set((int32_t) key, slot);
+      EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+    }
+  }
+  for (int64_t key = 1; key <= 5; key++) {
+    index_key.SetFromInteger(key);
+    rid.Set((int32_t) key, key * 50 - 1);
+    EXPECT_FALSE(tree.Insert(index_key, rid, transaction));
+    rid.Set((int32_t) key, 0);
+    EXPECT_FALSE(tree.Insert(index_key, rid, transaction));
+  }
+
+  // slots of each key come in any order, but each of them exactly once
+  auto check = [](std::map<int64_t, std::set<int32_t>> &seen, int64_t from,
+                  int64_t to) {
+    EXPECT_EQ(seen.size(), to - from + 1);
+    for (int64_t key = from; key <= to; key++) {
+      EXPECT_EQ(seen[key].size(), key <= 5 ? key * 50 : 1);
+    }
+  };
+  std::map<int64_t, std::set<int32_t>> seen;
+  size_t count = 0;
+  int64_t last_key = 0;
+  for (auto iterator = tree.Begin(); !iterator.isEnd(); ++iterator, count++) {
+    RID value = (*iterator).second;
+    EXPECT_FALSE(BPlusTreePostingPage::IsReference(value));
+    EXPECT_GE(value.GetPageId(), last_key);
+    last_key = value.GetPageId();
+    seen[value.GetPageId()].insert(value.GetSlotNum());
+  }
+  EXPECT_EQ(count, 15 * 50 + keys - 5);
+  check(seen, 1, keys);
+
+  seen.clear();
+  count = 0;
+  last_key = keys;
+  for (auto iterator = tree.RBegin(); !iterator.isEnd(); --iterator, count++) {
+    RID value = (*iterator).second;
+    EXPECT_LE(value.GetPageId(), last_key);
+    last_key = value.GetPageId();
+    seen[value.GetPageId()].insert(value.GetSlotNum());
+  }
+  EXPECT_EQ(count, 15 * 50 + keys - 5);
+  check(seen, 1, keys);
+
+  seen.clear();
+  index_key.SetFromInteger(3);
+  end_key.SetFromInteger(6);
+  for (auto iterator = tree.Begin(index_key, end_key); !iterator.isEnd();
+       ++iterator) {
+    seen[(*iterator).second.GetPageId()].insert((*iterator).second.GetSlotNum());
+  }
+  check(seen, 3, 6);
+
+  seen.clear();
+  for (auto &iterator : tree.BeginPartitions(4)) {
+    for (; !iterator.isEnd(); ++iterator) {
+      seen[(*iterator).second.GetPageId()].insert(
+          (*iterator).second.GetSlotNum());
+    }
+  }
+  check(seen, 1, keys);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Keys sharing a long prefix, e.g. "key000042", are what prefix compression and
+ * suffix truncation of separators are for: more of them fit in a page and the
+ * tree stays flat.
+ */
+TEST(BPlusTreeTests, VarcharKeyTest) {
+  Schema *key_schema = ParseCreateStatement("a varchar(16)");
+  GenericComparator<64> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", bpm,
+                                                             comparator);
+  Transaction *transaction = new Transaction(0);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  int64_t scale = 10000;
+  std::vector<GenericKey<64>> index_keys(scale);
+  for (int64_t key = 0; key < scale; key++) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "key%06ld", (long) key);
+    Tuple tuple({Value(TypeId::VARCHAR, std::string(buffer))}, key_schema);
+    index_keys[key].SetFromKey(tuple);
+  }
+  std::vector<int64_t> order;
+  for (int64_t key = 0; key < scale; key++)
+    order.push_back(key);
+  std::random_shuffle(order.begin(), order.end());
+  for (auto key : order) {
+    RID rid((int32_t) (key >> 32), key & 0xFFFFFFFF);
+    EXPECT_TRUE(tree.Insert(index_keys[key], rid, transaction));
+  }
+
+  int height = tree.GetHeight();
+  std::vector<RID> rids;
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t key = 0; key < scale; key++) {
+    rids.clear();
+    tree.GetValue(index_keys[key], rids, transaction);
+    EXPECT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  double elapsed = std::chrono::duration<double, std::micro>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  std::cout << scale << " varchar keys: height " << height << ", lookup "
+            << elapsed / scale << " us" << std::endl;
+  EXPECT_LE(height, 3);
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator.isEnd() == false; ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, scale);
+
+  // remove every other key, separators of the ones left must still route
+  for (int64_t key = 0; key < scale; key += 2)
+    tree.Remove(index_keys[key], transaction);
+  for (int64_t key = 0; key < scale; key++) {
+    rids.clear();
+    EXPECT_EQ(tree.GetValue(index_keys[key], rids, transaction), key % 2 == 1);
+  }
+  current_key = 1;
+  for (auto iterator = tree.Begin(index_keys[1]); iterator.isEnd() == false;
+       ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key += 2;
+  }
+  EXPECT_EQ(current_key, scale + 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Bounded scans stop at end key, reverse scans walk leaf pages backward
+ */
+TEST(BPlusTreeTests, RangeScanTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+  Transaction *transaction = new Transaction(0);
+
+  int64_t scale = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  GenericKey<8> index_key;
+  GenericKey<8> end_key;
+  for (auto key : keys) {
+    RID rid((int32_t) (key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  index_key.SetFromInteger(100);
+  end_key.SetFromInteger(300);
+  int64_t current_key = 100;
+  for (auto iterator = tree.Begin(index_key, end_key);
+       iterator.isEnd() == false; ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, 301);
+
+  current_key = scale;
+  for (auto iterator = tree.RBegin(); iterator.isEnd() == false;
+       --iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key--;
+  }
+  EXPECT_EQ(current_key, 0);
+
+  // remove odd keys, reverse scan starts from the last key no larger
+  for (int64_t key = 1; key <= scale; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  index_key.SetFromInteger(501);
+  current_key = 500;
+  for (auto iterator = tree.RBegin(index_key); iterator.isEnd() == false;
+       --iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key -= 2;
+  }
+  EXPECT_EQ(current_key, 0);
+
+  index_key.SetFromInteger(0);
+  end_key.SetFromInteger(1);
+  EXPECT_TRUE(tree.Begin(index_key, end_key).isEnd());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, LazyMergeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  tree.SetLazyMerge(true);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+  Transaction *transaction = new Transaction(0);
+
+  int64_t scale = 5000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    RID rid((int32_t) (key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  int height = tree.GetHeight();
+
+  // keep every tenth key, leaves are left underfull or empty
+  for (auto key : keys) {
+    if (key % 10 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  EXPECT_EQ(tree.GetHeight(), height);
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, rids, transaction), key % 10 == 0);
+  }
+  int64_t current_key = scale;
+  for (auto iterator = tree.RBegin(); iterator.isEnd() == false;
+       --iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key -= 10;
+  }
+  EXPECT_EQ(current_key, 0);
+
+  EXPECT_GT(tree.Rebalance(), 0);
+  EXPECT_EQ(tree.Rebalance(), 0);
+  EXPECT_LT(tree.GetHeight(), height);
+  current_key = 10;
+  for (auto iterator = tree.Begin(); iterator.isEnd() == false; ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key += 10;
+  }
+  EXPECT_EQ(current_key, scale + 10);
+
+  // deleting everything empties the tree once rebalanced
+  for (int64_t key = 10; key <= scale; key += 10) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  tree.Rebalance();
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, InsertBatchTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  int64_t scale = 10000;
+  int batch_size = 1000;
+
+  // append-heavy ingest, one key at a time and in batches
+  double insert_time[2];
+  int height[2];
+  for (int batched = 0; batched < 2; batched++) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(page_id);
+    (void) header_page;
+    Transaction *transaction = new Transaction(0);
+
+    GenericKey<8> index_key;
+    std::vector<std::pair<GenericKey<8>, RID>> batch;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t key = 1; key <= scale; key++) {
+      RID rid((int32_t) (key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      if (batched) {
+        batch.emplace_back(index_key, rid);
+        if (batch.size() == (size_t) batch_size || key == scale) {
+          EXPECT_EQ(tree.InsertBatch(batch, transaction), batch.size());
+          batch.clear();
+        }
+      } else {
+        tree.Insert(index_key, rid, transaction);
+      }
+    }
+    insert_time[batched] = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    height[batched] = tree.GetHeight();
+
+    int64_t current_key = 1;
+    for (auto iterator = tree.Begin(); iterator.isEnd() == false;
+         ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key++;
+    }
+    EXPECT_EQ(current_key, scale + 1);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  std::cout << "Insert " << (int64_t)(scale / insert_time[0])
+            << " inserts/s, height " << height[0] << ", InsertBatch of "
+            << batch_size << " keys " << (int64_t)(scale / insert_time[1])
+            << " inserts/s, height " << height[1] << std::endl;
+  EXPECT_LE(height[1], height[0]);
+
+  // unsorted batches into a tree with keys already, duplicates are rejected
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+  Transaction *transaction = new Transaction(0);
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  std::vector<std::pair<GenericKey<8>, RID>> batch;
+  GenericKey<8> index_key;
+  int inserted = 0;
+  for (size_t i = 0; i < keys.size(); i++) {
+    RID rid((int32_t) (keys[i] >> 32), keys[i] & 0xFFFFFFFF);
+    index_key.SetFromInteger(keys[i]);
+    batch.emplace_back(index_key, rid);
+    if (i % 3 == 0) {
+      batch.emplace_back(index_key, rid);
+    }
+    if (batch.size() >= (size_t) batch_size || i + 1 == keys.size()) {
+      inserted += tree.InsertBatch(batch, transaction);
+      batch.clear();
+    }
+  }
+  EXPECT_EQ(inserted, scale);
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, rids, transaction));
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, MultiGetTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+  Transaction *transaction = new Transaction(0);
+
+  // even keys exist, odd keys do not
+  int64_t scale = 10000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    if (key % 2 == 0) {
+      RID rid((int32_t) (key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+  }
+
+  int batch_size = 1000;
+  std::vector<GenericKey<8>> batch;
+  std::vector<std::vector<RID>> results;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < keys.size(); i += batch_size) {
+    batch.clear();
+    for (size_t j = i; j < i + batch_size && j < keys.size(); j++) {
+      index_key.SetFromInteger(keys[j]);
+      batch.push_back(index_key);
+    }
+    tree.MultiGet(batch, results, transaction);
+    EXPECT_EQ(results.size(), batch.size());
+    for (size_t j = 0; j < results.size(); j++) {
+      int64_t key = keys[i + j];
+      EXPECT_EQ(results[j].size(), key % 2 == 0 ? 1 : 0);
+      if (!results[j].empty()) {
+        EXPECT_EQ(results[j][0].GetSlotNum(), key);
+      }
+    }
+  }
+  double multi_get_time = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+
+  std::vector<RID> rids;
+  start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, rids, transaction);
+  }
+  double get_value_time = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+  std::cout << "GetValue " << (int64_t)(scale / get_value_time)
+            << " lookups/s, MultiGet of " << batch_size << " keys "
+            << (int64_t)(scale / multi_get_time) << " lookups/s" << std::endl;
+
+  // the same key twice, and an empty batch
+  batch.assign(2, index_key);
+  index_key.SetFromInteger(2);
+  batch.push_back(index_key);
+  tree.MultiGet(batch, results, transaction);
+  EXPECT_EQ(results[0].size(), results[1].size());
+  EXPECT_EQ(results[2][0].GetSlotNum(), 2);
+  batch.clear();
+  tree.MultiGet(batch, results, transaction);
+  EXPECT_TRUE(results.empty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, PartitionTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+  Transaction *transaction = new Transaction(0);
+
+  GenericKey<8> index_key;
+  GenericKey<8> end_key;
+  EXPECT_EQ(tree.BeginPartitions(4).size(), 1);
+  EXPECT_TRUE(tree.BeginPartitions(4)[0].isEnd());
+
+  int64_t scale = 5000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  for (auto key : keys) {
+    RID rid((int32_t) (key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // partitions are disjoint and cover the whole tree in key order
+  auto iterators = tree.BeginPartitions(8);
+  EXPECT_EQ(iterators.size(), 8);
+  int64_t current_key = 1;
+  for (auto &iterator : iterators) {
+    EXPECT_FALSE(iterator.isEnd());
+    for (; iterator.isEnd() == false; ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key++;
+    }
+  }
+  EXPECT_EQ(current_key, scale + 1);
+
+  // bounds are kept, ask for more partitions than there are separators
+  index_key.SetFromInteger(1000);
+  end_key.SetFromInteger(1100);
+  iterators = tree.BeginPartitions(index_key, end_key, 1000);
+  EXPECT_GT(iterators.size(), 1);
+  EXPECT_LT(iterators.size(), 100);
+  current_key = 1000;
+  for (auto &iterator : iterators) {
+    for (; iterator.isEnd() == false; ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key++;
+    }
+  }
+  EXPECT_EQ(current_key, 1101);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, UpperLevelCacheTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+  Transaction *transaction = new Transaction(0);
+
+  int64_t scale = 20000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    RID rid((int32_t) (key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // latency of each lookup, going down from root and from the copy
+  std::vector<RID> rids;
+  std::random_shuffle(keys.begin(), keys.end());
+  double mean[2];
+  double p99[2];
+  for (int cached = 0; cached < 2; cached++) {
+    tree.SetUpperLevelCache(cached ? 64 : 0);
+    std::vector<double> latencies;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      auto start = std::chrono::steady_clock::now();
+      tree.GetValue(index_key, rids, transaction);
+      latencies.push_back(std::chrono::duration<double, std::micro>(
+                              std::chrono::steady_clock::now() - start)
+                              .count());
+      EXPECT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    mean[cached] = 0;
+    for (auto latency : latencies)
+      mean[cached] += latency / latencies.size();
+    p99[cached] = latencies[latencies.size() * 99 / 100];
+  }
+  std::cout << "GetValue mean " << mean[0] << "us p99 " << p99[0]
+            << "us, with upper level cache mean " << mean[1] << "us p99 "
+            << p99[1] << "us" << std::endl;
+
+  // merges make the copy stale, splits make it fall behind
+  for (int64_t key = 1; key <= scale; key += 3) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+    rids.clear();
+    index_key.SetFromInteger(key + 1);
+    EXPECT_TRUE(tree.GetValue(index_key, rids, transaction));
+  }
+  for (int64_t key = scale + 1; key <= scale * 2; key++) {
+    RID rid((int32_t) (key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+    rids.clear();
+    index_key.SetFromInteger(key / 2);
+    EXPECT_EQ(tree.GetValue(index_key, rids, transaction),
+              (key / 2) % 3 != 1);
+  }
+  for (int64_t key = 1; key <= scale * 2; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, rids, transaction),
+              key > scale || key % 3 != 1);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
 
 } // namespace cmudb
@@ -1,6 +1,7 @@
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
 
 #include "logging/common.h"
 #include "logging/log_recovery.h"
@@ -291,4 +292,98 @@ TEST(LogManagerTest, RedoDeleteTest) {
   remove("test.log");
 }
 
+// overflow pages of a committed toasted tuple are redone, those of an
+// uncommitted one undone along with it
+TEST(LogManagerTest, RedoToastTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+
+  Schema *schema = ParseCreateStatement("a int, b varchar(2000)");
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  TableHeap *test_table = new TableHeap(
+      storage_engine->buffer_pool_manager_, storage_engine->lock_manager_,
+      storage_engine->log_manager_, txn, schema);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+
+  // each value takes a chain of 3 overflow pages
+  auto make_tuple = [schema](int32_t a) {
+    std::vector<Value> values;
+    values.push_back(Value(TypeId::INTEGER, a));
+    values.push_back(Value(TypeId::VARCHAR, std::string(1200, 'a' + a)));
+    return Tuple(values, schema);
+  };
+  RID rid, rid2;
+  EXPECT_TRUE(test_table->InsertTuple(make_tuple(0), rid, txn));
+  storage_engine->transaction_manager_->Commit(txn);
+  delete txn;
+
+  Transaction *txn2 = storage_engine->transaction_manager_->Begin();
+  EXPECT_TRUE(test_table->InsertTuple(make_tuple(1), rid2, txn2));
+  delete txn2;
+  delete test_table;
+  LOG_DEBUG("Crash before Commit txn2...");
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  delete storage_engine;
+
+  // restart system, no page reached disk
+  storage_engine = new StorageEngine("test.db");
+  LogRecovery *log_recovery = new LogRecovery(
+      storage_engine->disk_manager_, storage_engine->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  Tuple tuple;
+  txn = storage_engine->transaction_manager_->Begin();
+  test_table = new TableHeap(storage_engine->buffer_pool_manager_,
+                             storage_engine->lock_manager_,
+                             storage_engine->log_manager_, first_page_id,
+                             INVALID_PAGE_ID, schema);
+  EXPECT_TRUE(test_table->GetTuple(rid, tuple, txn));
+  EXPECT_EQ(tuple.GetValue(schema, 1).ToString(), std::string(1200, 'a'));
+  EXPECT_FALSE(test_table->GetTuple(rid2, tuple, txn));
+  storage_engine->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete log_recovery;
+  delete storage_engine;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// records appended faster than flush thread writes them are neither lost nor
+// written twice, buffers are swapped only once flushed
+TEST(LogManagerTest, BufferSwapTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->RunFlushThread();
+
+  // a BEGIN record is header only
+  const int record_size = 20;
+  int record_count = 10 * LOG_BUFFER_SIZE / record_size;
+  for (int i = 0; i < record_count; i++) {
+    LogRecord log_record(0, i - 1, LogRecordType::BEGIN);
+    EXPECT_EQ(storage_engine->log_manager_->AppendLogRecord(log_record), i);
+  }
+  // the last records are written at time out
+  std::this_thread::sleep_for(LOG_TIMEOUT * 2);
+  storage_engine->log_manager_->StopFlushThread();
+
+  std::vector<char> buffer(record_count * record_size);
+  EXPECT_TRUE(
+      storage_engine->disk_manager_->ReadLog(buffer.data(), buffer.size(), 0));
+  EXPECT_FALSE(storage_engine->disk_manager_->ReadLog(
+      buffer.data(), record_size, buffer.size()));
+  for (int i = 0; i < record_count; i++) {
+    // size, then lsn
+    EXPECT_EQ(*reinterpret_cast<int32_t *>(buffer.data() +
+                                           i * record_size + 4),
+              i);
+  }
+
+  delete storage_engine;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
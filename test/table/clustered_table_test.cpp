@@ -0,0 +1,234 @@
+/**
+ * clustered_table_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/header_page.h"
+#include "table/clustered_table.h"
+#include "table/table_heap.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+// every 10th row is too long for a leaf and goes to overflow pages
+static Tuple MakeRow(Schema *schema, int64_t a, const std::string &tag) {
+  std::string b = tag + std::to_string(a);
+  if (a % 10 == 0)
+    b += std::string(250, 'x');
+  std::vector<Value> values;
+  values.push_back(Value(TypeId::VARCHAR, b));
+  values.push_back(Value(TypeId::BIGINT, a));
+  values.push_back(Value(TypeId::INTEGER, static_cast<int32_t>(a * 2)));
+  return Tuple(values, schema);
+}
+
+static void CheckRow(Schema *schema, const Tuple &tuple, int64_t a,
+                     const std::string &tag) {
+  std::string b = tag + std::to_string(a);
+  if (a % 10 == 0)
+    b += std::string(250, 'x');
+  EXPECT_EQ(tuple.GetValue(schema, 0).ToString(), b);
+  EXPECT_EQ(tuple.GetValue(schema, 1).GetAs<int64_t>(), a);
+  EXPECT_EQ(tuple.GetValue(schema, 2).GetAs<int32_t>(), a * 2);
+}
+
+TEST(ClusteredTableTest, InsertScanTest) {
+  // primary key is not the first column
+  Schema *schema = ParseCreateStatement("b varchar(300), a bigint, c int");
+  std::string index_string = "foo_pk a clustered";
+  IndexMetadata *metadata = ParseIndexStatement(index_string, "foo", schema);
+  EXPECT_TRUE(metadata->IsClustered());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  Transaction *transaction = new Transaction(0);
+  ClusteredTable *table = new ClusteredTable(metadata, schema, bpm);
+
+  std::vector<int64_t> keys;
+  int64_t scale = 1000;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  for (auto key : keys)
+    EXPECT_TRUE(table->InsertTuple(MakeRow(schema, key, "b"), transaction));
+  // primary key goes in once
+  EXPECT_FALSE(table->InsertTuple(MakeRow(schema, 10, "c"), transaction));
+
+  Tuple tuple;
+  for (int64_t key = 1; key <= scale; key++) {
+    EXPECT_TRUE(table->GetTuple(key, tuple, transaction));
+    CheckRow(schema, tuple, key, "b");
+  }
+  EXPECT_FALSE(table->GetTuple(scale + 1, tuple, transaction));
+
+  // scan reads rows in primary key order
+  int64_t current_key = 0;
+  for (auto itr = table->begin(); !itr.IsEnd(); ++itr) {
+    current_key++;
+    EXPECT_EQ(itr.GetRowId(), current_key);
+    CheckRow(schema, *itr, current_key, "b");
+  }
+  EXPECT_EQ(current_key, scale);
+  delete table;
+
+  // reopen from root page id recorded in header page
+  page_id_t root_page_id;
+  EXPECT_TRUE(static_cast<HeaderPage *>(header_page)
+                  ->GetRootId("foo_pk", root_page_id));
+  // statement is consumed by parser
+  index_string = "foo_pk a clustered";
+  metadata = ParseIndexStatement(index_string, "foo", schema);
+  table = new ClusteredTable(metadata, schema, bpm, root_page_id);
+  EXPECT_TRUE(table->GetTuple(scale / 2, tuple, transaction));
+  CheckRow(schema, tuple, scale / 2, "b");
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete table;
+  delete transaction;
+  delete schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ClusteredTableTest, DeleteUpdateTest) {
+  Schema *schema = ParseCreateStatement("b varchar(300), a bigint, c int");
+  std::string index_string = "foo_pk a clustered";
+  IndexMetadata *metadata = ParseIndexStatement(index_string, "foo", schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+  ClusteredTable *table = new ClusteredTable(metadata, schema, bpm);
+
+  int64_t scale = 500;
+  for (int64_t key = 1; key <= scale; key++)
+    table->InsertTuple(MakeRow(schema, key, "b"), transaction);
+
+  for (int64_t key = 2; key <= scale; key += 2)
+    EXPECT_TRUE(table->DeleteTuple(key, transaction));
+  EXPECT_FALSE(table->DeleteTuple(2, transaction));
+  // rows stay in leaves or overflow pages as their new length asks for
+  for (int64_t key = 1; key <= scale; key += 2) {
+    EXPECT_TRUE(
+        table->UpdateTuple(MakeRow(schema, key, "new"), key, transaction));
+  }
+  // primary key may move to a free one only
+  EXPECT_FALSE(table->UpdateTuple(MakeRow(schema, 3, "new"), 1, transaction));
+  EXPECT_TRUE(table->UpdateTuple(MakeRow(schema, 2, "new"), 1, transaction));
+
+  Tuple tuple;
+  for (int64_t key = 1; key <= scale; key++) {
+    bool exists = key == 2 || (key % 2 == 1 && key != 1);
+    EXPECT_EQ(table->GetTuple(key, tuple, transaction), exists);
+    if (exists)
+      CheckRow(schema, tuple, key, "new");
+  }
+  int count = 0;
+  for (auto itr = table->begin(); !itr.IsEnd(); ++itr)
+    count++;
+  EXPECT_EQ(count, scale / 2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete table;
+  delete transaction;
+  delete schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ClusteredTableTest, PointLookupBenchmark) {
+  Schema *schema = ParseCreateStatement("b varchar(64), a bigint, c int");
+  std::string index_string = "foo_pk a clustered";
+  IndexMetadata *metadata = ParseIndexStatement(index_string, "foo", schema);
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+  Transaction *transaction = new Transaction(0);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *heap =
+      new TableHeap(bpm, lock_manager, log_manager, transaction);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_a", bpm,
+                                                           comparator);
+  ClusteredTable *table = new ClusteredTable(metadata, schema, bpm);
+
+  int64_t scale = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key++)
+    keys.push_back(key);
+  std::random_shuffle(keys.begin(), keys.end());
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    std::vector<Value> values;
+    values.push_back(Value(TypeId::VARCHAR, "b" + std::to_string(key)));
+    values.push_back(Value(TypeId::BIGINT, key));
+    values.push_back(Value(TypeId::INTEGER, static_cast<int32_t>(key)));
+    Tuple tuple(values, schema);
+    RID rid;
+    heap->InsertTuple(tuple, rid, transaction);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+    table->InsertTuple(tuple, transaction);
+  }
+
+  std::random_shuffle(keys.begin(), keys.end());
+  std::vector<RID> rids;
+  Tuple tuple;
+  auto start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, rids);
+    EXPECT_TRUE(heap->GetTuple(rids[0], tuple, transaction));
+  }
+  double heap_time = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+  start = std::chrono::steady_clock::now();
+  for (auto key : keys)
+    EXPECT_TRUE(table->GetTuple(key, tuple, transaction));
+  double clustered_time = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+  std::cout << "heap and B+ tree " << (int64_t)(scale / heap_time)
+            << " lookups/s, clustered table "
+            << (int64_t)(scale / clustered_time) << " lookups/s" << std::endl;
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete table;
+  delete heap;
+  delete log_manager;
+  delete lock_manager;
+  delete transaction;
+  delete key_schema;
+  delete schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
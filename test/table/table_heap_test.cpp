@@ -0,0 +1,715 @@
+/**
+ * table_heap_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "table/table_heap.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+static Tuple MakeRow(Schema *schema, int32_t a) {
+  std::vector<Value> values;
+  values.push_back(Value(TypeId::INTEGER, a));
+  values.push_back(Value(TypeId::VARCHAR, "b" + std::to_string(a)));
+  return Tuple(values, schema);
+}
+
+static int CountPages(TableHeap *table, BufferPoolManager *bpm) {
+  int count = 0;
+  page_id_t page_id = table->GetFirstPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+    count++;
+  }
+  return count;
+}
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  Schema *schema = ParseCreateStatement("a int, b varchar(16)");
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(false);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table =
+      new TableHeap(bpm, lock_manager, log_manager, transaction);
+
+  // more map pages than one
+  int scale = 30000;
+  RID rid;
+  std::vector<RID> rids;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->InsertTuple(MakeRow(schema, i), rid, transaction));
+    rids.push_back(rid);
+  }
+  int page_count = CountPages(table, bpm);
+  int slot_count = FreeSpaceMapPage::SLOT_COUNT;
+  EXPECT_GT(page_count, slot_count);
+
+  // room freed by deletes is taken again before the chain grows
+  for (int i = 0; i < scale; i += 10) {
+    EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+    table->ApplyDelete(rids[i], transaction);
+  }
+  for (int i = 0; i < scale; i += 10)
+    EXPECT_TRUE(table->InsertTuple(MakeRow(schema, i), rid, transaction));
+  EXPECT_EQ(CountPages(table, bpm), page_count);
+
+  // map is persisted, or rebuilt from page chain
+  page_id_t first_page_id = table->GetFirstPageId();
+  page_id_t map_page_id = table->GetFreeSpaceMapPageId();
+  for (int reopen = 0; reopen < 2; reopen++) {
+    EXPECT_TRUE(table->MarkDelete(rids[reopen + 1], transaction));
+    table->ApplyDelete(rids[reopen + 1], transaction);
+    delete table;
+    table = new TableHeap(bpm, lock_manager, log_manager, first_page_id,
+                          reopen == 0 ? map_page_id : INVALID_PAGE_ID);
+    EXPECT_TRUE(
+        table->InsertTuple(MakeRow(schema, reopen + 1), rid, transaction));
+    EXPECT_EQ(CountPages(table, bpm), page_count);
+  }
+
+  int count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    count++;
+  EXPECT_EQ(count, scale);
+
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete transaction;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(TableHeapTest, CompactionTest) {
+  Schema *schema = ParseCreateStatement("a int, b varchar(32)");
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(false);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table =
+      new TableHeap(bpm, lock_manager, log_manager, transaction);
+
+  int scale = 2000;
+  RID rid;
+  std::vector<RID> rids;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->InsertTuple(MakeRow(schema, i), rid, transaction));
+    rids.push_back(rid);
+  }
+  int page_count = CountPages(table, bpm);
+
+  // rows grow in place over holes deletes left, keeping their RIDs
+  for (int i = 1; i < scale; i += 2) {
+    EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+    table->ApplyDelete(rids[i], transaction);
+  }
+  std::string padding(10, 'y');
+  for (int i = 0; i < scale; i += 2) {
+    std::vector<Value> values;
+    values.push_back(Value(TypeId::INTEGER, i));
+    values.push_back(Value(TypeId::VARCHAR, "b" + std::to_string(i) + padding));
+    EXPECT_TRUE(table->UpdateTuple(Tuple(values, schema), rids[i],
+                                   transaction));
+  }
+  Tuple tuple;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_EQ(table->GetTuple(rids[i], tuple, transaction), i % 2 == 0);
+    if (i % 2 == 0) {
+      EXPECT_EQ(tuple.GetValue(schema, 1).ToString(),
+                "b" + std::to_string(i) + padding);
+    }
+  }
+  EXPECT_EQ(CountPages(table, bpm), page_count);
+
+  // vacuum compacts pages sparse enough once
+  for (int i = 2; i < scale; i += 4) {
+    EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+    table->ApplyDelete(rids[i], transaction);
+  }
+  EXPECT_GT(table->Vacuum(), 0);
+  EXPECT_EQ(table->Vacuum(), 0);
+
+  // and so does vacuum thread
+  table->RunVacuumThread(std::chrono::milliseconds(10));
+  for (int i = 4; i < scale; i += 8) {
+    EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+    table->ApplyDelete(rids[i], transaction);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  table->StopVacuumThread();
+  EXPECT_EQ(table->Vacuum(), 0);
+
+  int count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    EXPECT_EQ(itr->GetValue(schema, 0).GetAs<int32_t>() % 8, 0);
+    count++;
+  }
+  EXPECT_EQ(count, scale / 8);
+
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete transaction;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(TableHeapTest, InsertBenchmark) {
+  Schema *schema = ParseCreateStatement("a int, b varchar(16)");
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(false);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table =
+      new TableHeap(bpm, lock_manager, log_manager, transaction);
+
+  // throughput of every 100k inserts stays flat as the table grows
+  int scale = 1000000;
+  int step = 100000;
+  RID rid;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->InsertTuple(MakeRow(schema, i), rid, transaction));
+    if ((i + 1) % step == 0) {
+      double elapsed = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+      std::cout << "rows " << i + 1 - step << "-" << i + 1 << ": "
+                << (int64_t)(step / elapsed) << " inserts/s" << std::endl;
+      start = std::chrono::steady_clock::now();
+      transaction->GetWriteSet()->clear();
+    }
+  }
+
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete transaction;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(TableHeapTest, SlotReuseBenchmark) {
+  Schema *schema = ParseCreateStatement("a int");
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(false);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table =
+      new TableHeap(bpm, lock_manager, log_manager, transaction);
+
+  // short rows, so pages have many slots, nine in ten of them emptied
+  int scale = 400000;
+  RID rid;
+  std::vector<RID> rids;
+  for (int i = 0; i < scale; i++) {
+    std::vector<Value> values{Value(TypeId::INTEGER, i)};
+    EXPECT_TRUE(
+        table->InsertTuple(Tuple(values, schema), rid, transaction));
+    rids.push_back(rid);
+  }
+  int page_count = CountPages(table, bpm);
+  for (int i = 0; i < scale; i++) {
+    if (i % 10 != 0) {
+      EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+      table->ApplyDelete(rids[i], transaction);
+    }
+  }
+  transaction->GetWriteSet()->clear();
+
+  int rounds = 10;
+  int count = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+      count++;
+  }
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  EXPECT_EQ(count, rounds * scale / 10);
+  std::cout << "scan " << (int64_t)(count / elapsed) << " rows/s"
+            << std::endl;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < scale; i++) {
+    if (i % 10 != 0) {
+      std::vector<Value> values{Value(TypeId::INTEGER, i)};
+      EXPECT_TRUE(
+          table->InsertTuple(Tuple(values, schema), rid, transaction));
+    }
+  }
+  elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                          start)
+                .count();
+  std::cout << "insert into emptied slots "
+            << (int64_t)(scale / 10 * 9 / elapsed) << " rows/s" << std::endl;
+  EXPECT_EQ(CountPages(table, bpm), page_count);
+
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete transaction;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(TableHeapTest, ScanBenchmark) {
+  Schema *schema = ParseCreateStatement("a int, b varchar(16)");
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(false);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table =
+      new TableHeap(bpm, lock_manager, log_manager, transaction);
+
+  int scale = 200000;
+  RID rid;
+  std::vector<RID> rids;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->InsertTuple(MakeRow(schema, i), rid, transaction));
+    rids.push_back(rid);
+  }
+  // batches skip deleted tuples and pages left empty
+  for (int i = 0; i < scale; i++) {
+    if (i % 3 == 0 || (i >= 1000 && i < 2000)) {
+      EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+      if (i % 2 == 0)
+        table->ApplyDelete(rids[i], transaction);
+    }
+  }
+  transaction->GetWriteSet()->clear();
+  int row_count = 0;
+  for (int i = 0; i < scale; i++) {
+    if (i % 3 != 0 && (i < 1000 || i >= 2000))
+      row_count++;
+  }
+
+  int rounds = 10;
+  int64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+      sum += itr->GetValue(schema, 0).GetAs<int32_t>();
+      sum += itr->GetValue(schema, 1).GetLength();
+    }
+  }
+  double tuple_time = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+
+  int64_t batch_sum = 0;
+  int count = 0;
+  start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (TableBatchIterator itr(table, transaction); !itr.IsEnd(); ++itr) {
+      batch_sum += itr->GetValue(schema, 0).GetAs<int32_t>();
+      batch_sum += itr->GetValue(schema, 1).GetLength();
+      count++;
+    }
+  }
+  double batch_time = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  EXPECT_EQ(count, rounds * row_count);
+  EXPECT_EQ(batch_sum, sum);
+  std::cout << "tuple at a time " << (int64_t)(count / tuple_time)
+            << " rows/s, page at a time " << (int64_t)(count / batch_time)
+            << " rows/s" << std::endl;
+
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete transaction;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(TableHeapTest, ConcurrentInsertBenchmark) {
+  Schema *schema = ParseCreateStatement("a int, b varchar(16)");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(false);
+  LogManager *log_manager = new LogManager(disk_manager);
+
+  // same number of rows split over more threads, each inserting into its own
+  // target page
+  int scale = 400000;
+  for (int thread_count = 1; thread_count <= 8; thread_count *= 2) {
+    Transaction *transaction = new Transaction(0);
+    TableHeap *table =
+        new TableHeap(bpm, lock_manager, log_manager, transaction);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < thread_count; t++) {
+      threads.push_back(std::thread([&, t] {
+        Transaction txn(t + 1);
+        RID rid;
+        for (int i = t; i < scale; i += thread_count)
+          EXPECT_TRUE(table->InsertTuple(MakeRow(schema, i), rid, &txn));
+      }));
+    }
+    for (auto &thread : threads)
+      thread.join();
+    double elapsed = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    std::cout << thread_count << " threads: " << (int64_t)(scale / elapsed)
+              << " inserts/s" << std::endl;
+
+    std::vector<bool> found(scale, false);
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+      int32_t a = itr->GetValue(schema, 0).GetAs<int32_t>();
+      EXPECT_FALSE(found[a]);
+      found[a] = true;
+    }
+    EXPECT_EQ(std::count(found.begin(), found.end(), true), scale);
+    delete table;
+    delete transaction;
+  }
+
+  delete log_manager;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(TableHeapTest, ToastTest) {
+  Schema *schema = ParseCreateStatement("a int, b varchar(2000), c varchar(8)");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(false);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TransactionManager transaction_manager(lock_manager, log_manager);
+  Transaction *transaction = transaction_manager.Begin();
+  TableHeap *table =
+      new TableHeap(bpm, lock_manager, log_manager, transaction, schema);
+
+  // every other row is longer than a page
+  auto make_row = [schema](int32_t a, const std::string &tag) {
+    std::string b = tag + std::to_string(a);
+    if (a % 2 == 0)
+      b += std::string(1000 + a, 'x');
+    std::vector<Value> values;
+    values.push_back(Value(TypeId::INTEGER, a));
+    values.push_back(Value(TypeId::VARCHAR, b));
+    values.push_back(Value(TypeId::VARCHAR, "c"));
+    return Tuple(values, schema);
+  };
+  auto check_row = [schema](const Tuple &tuple, int32_t a,
+                            const std::string &tag) {
+    std::string b = tag + std::to_string(a);
+    if (a % 2 == 0)
+      b += std::string(1000 + a, 'x');
+    EXPECT_EQ(tuple.GetValue(schema, 0).GetAs<int32_t>(), a);
+    EXPECT_EQ(tuple.GetValue(schema, 1).ToString(), b);
+    EXPECT_EQ(tuple.GetValue(schema, 2).ToString(), "c");
+  };
+
+  int scale = 100;
+  RID rid;
+  std::vector<RID> rids;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->InsertTuple(make_row(i, "b"), rid, transaction));
+    rids.push_back(rid);
+  }
+  transaction_manager.Commit(transaction);
+  delete transaction;
+
+  // tuples given out are read back whole
+  transaction = transaction_manager.Begin();
+  Tuple tuple;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->GetTuple(rids[i], tuple, transaction));
+    check_row(tuple, i, "b");
+  }
+  int count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    check_row(*itr, itr->GetValue(schema, 0).GetAs<int32_t>(), "b");
+    count++;
+  }
+  EXPECT_EQ(count, scale);
+  // views of pages hold toast pointers, read through table heap
+  count = 0;
+  for (TableBatchIterator itr(table, transaction); !itr.IsEnd(); ++itr) {
+    int32_t a = table->GetValue(*itr, 0).GetAs<int32_t>();
+    EXPECT_LE(itr->GetLength(), PAGE_SIZE / 4);
+    EXPECT_EQ(table->GetValue(*itr, 1).GetLength(),
+              make_row(a, "b").GetValue(schema, 1).GetLength());
+    EXPECT_EQ(table->GetValue(*itr, 2).ToString(), "c");
+    count++;
+  }
+  EXPECT_EQ(count, scale);
+  transaction_manager.Commit(transaction);
+  delete transaction;
+
+  // rolled back updates leave the old rows
+  transaction = transaction_manager.Begin();
+  for (int i = 0; i < scale; i++)
+    table->UpdateTuple(make_row(i, "n"), rids[i], transaction);
+  transaction_manager.Abort(transaction);
+  delete transaction;
+  transaction = transaction_manager.Begin();
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->GetTuple(rids[i], tuple, transaction));
+    check_row(tuple, i, "b");
+  }
+  transaction_manager.Commit(transaction);
+  delete transaction;
+
+  // committed ones and deletes stay
+  transaction = transaction_manager.Begin();
+  for (int i = 0; i < scale; i++) {
+    if (i % 3 == 0)
+      EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+    else
+      EXPECT_TRUE(
+          table->UpdateTuple(make_row(i, "n"), rids[i], transaction));
+  }
+  transaction_manager.Commit(transaction);
+  delete transaction;
+  transaction = transaction_manager.Begin();
+  for (int i = 0; i < scale; i++) {
+    EXPECT_EQ(table->GetTuple(rids[i], tuple, transaction), i % 3 != 0);
+    if (i % 3 != 0)
+      check_row(tuple, i, "n");
+  }
+  transaction_manager.Commit(transaction);
+  delete transaction;
+
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(TableHeapTest, PaxTest) {
+  Schema *schema = ParseCreateStatement("a int, b varchar(16), c bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(false);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TransactionManager transaction_manager(lock_manager, log_manager);
+  Transaction *transaction = transaction_manager.Begin();
+  // no schema, no minipages
+  EXPECT_THROW(TableHeap(bpm, lock_manager, log_manager, transaction, nullptr,
+                         PageLayout::PAX),
+               Exception);
+  // no log records, no recovery
+  ENABLE_LOGGING = true;
+  EXPECT_THROW(TableHeap(bpm, lock_manager, log_manager, transaction, schema,
+                         PageLayout::PAX),
+               Exception);
+  ENABLE_LOGGING = false;
+  TableHeap *table = new TableHeap(bpm, lock_manager, log_manager, transaction,
+                                   schema, PageLayout::PAX);
+
+  auto make_row = [schema](int32_t a, const std::string &tag) {
+    std::vector<Value> values;
+    values.push_back(Value(TypeId::INTEGER, a));
+    values.push_back(Value(TypeId::VARCHAR, tag + std::to_string(a)));
+    values.push_back(Value(TypeId::BIGINT, static_cast<int64_t>(a) * 3));
+    return Tuple(values, schema);
+  };
+  auto check_row = [schema](const Tuple &tuple, int32_t a,
+                            const std::string &tag) {
+    EXPECT_EQ(tuple.GetValue(schema, 0).GetAs<int32_t>(), a);
+    EXPECT_EQ(tuple.GetValue(schema, 1).ToString(), tag + std::to_string(a));
+    EXPECT_EQ(tuple.GetValue(schema, 2).GetAs<int64_t>(), a * 3);
+  };
+
+  int scale = 200;
+  RID rid;
+  std::vector<RID> rids;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->InsertTuple(make_row(i, "b"), rid, transaction));
+    rids.push_back(rid);
+  }
+  transaction_manager.Commit(transaction);
+  delete transaction;
+  // varchar value longer than declared
+  transaction = transaction_manager.Begin();
+  EXPECT_FALSE(table->InsertTuple(make_row(0, std::string(16, 'x')), rid,
+                                  transaction));
+  transaction_manager.Abort(transaction);
+  delete transaction;
+
+  transaction = transaction_manager.Begin();
+  Tuple tuple;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->GetTuple(rids[i], tuple, transaction));
+    check_row(tuple, i, "b");
+  }
+  int count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+    check_row(*itr, itr->GetValue(schema, 0).GetAs<int32_t>(), "b");
+    count++;
+  }
+  EXPECT_EQ(count, scale);
+  // columns not asked for are null
+  count = 0;
+  for (TableBatchIterator itr(table, transaction, {2}); !itr.IsEnd(); ++itr) {
+    EXPECT_TRUE(itr->IsNull(schema, 0));
+    EXPECT_TRUE(itr->IsNull(schema, 1));
+    EXPECT_EQ(itr->GetValue(schema, 2).GetAs<int64_t>() % 3, 0);
+    count++;
+  }
+  EXPECT_EQ(count, scale);
+  transaction_manager.Commit(transaction);
+  delete transaction;
+
+  // rolled back updates and deletes leave the old rows
+  transaction = transaction_manager.Begin();
+  for (int i = 0; i < scale; i++) {
+    if (i % 2 == 0)
+      EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+    else
+      EXPECT_TRUE(table->UpdateTuple(make_row(i, "n"), rids[i], transaction));
+  }
+  transaction_manager.Abort(transaction);
+  delete transaction;
+  transaction = transaction_manager.Begin();
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(table->GetTuple(rids[i], tuple, transaction));
+    check_row(tuple, i, "b");
+  }
+  transaction_manager.Commit(transaction);
+  delete transaction;
+
+  // committed ones stay, freed slots are taken again
+  transaction = transaction_manager.Begin();
+  for (int i = 0; i < scale; i++) {
+    if (i % 3 == 0)
+      EXPECT_TRUE(table->MarkDelete(rids[i], transaction));
+    else
+      EXPECT_TRUE(table->UpdateTuple(make_row(i, "n"), rids[i], transaction));
+  }
+  transaction_manager.Commit(transaction);
+  delete transaction;
+  transaction = transaction_manager.Begin();
+  for (int i = 0; i < scale; i++) {
+    EXPECT_EQ(table->GetTuple(rids[i], tuple, transaction), i % 3 != 0);
+    if (i % 3 != 0)
+      check_row(tuple, i, "n");
+  }
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    last_page_id = std::max(last_page_id, itr->GetRid().GetPageId());
+  for (int i = 0; i < scale; i += 3) {
+    EXPECT_TRUE(table->InsertTuple(make_row(i, "b"), rid, transaction));
+    EXPECT_LE(rid.GetPageId(), last_page_id);
+  }
+  transaction_manager.Commit(transaction);
+  delete transaction;
+
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(TableHeapTest, PaxScanBenchmark) {
+  Schema *schema = ParseCreateStatement(
+      "a int, b varchar(40), c varchar(40), d varchar(40), e bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LockManager *lock_manager = new LockManager(false);
+  LogManager *log_manager = new LogManager(disk_manager);
+  Transaction *transaction = new Transaction(0);
+  TableHeap *row_table = new TableHeap(bpm, lock_manager, log_manager,
+                                       transaction, schema, PageLayout::ROW);
+  TableHeap *pax_table = new TableHeap(bpm, lock_manager, log_manager,
+                                       transaction, schema, PageLayout::PAX);
+
+  int scale = 3000;
+  int64_t expected_sum = 0;
+  RID rid;
+  for (int i = 0; i < scale; i++) {
+    std::vector<Value> values;
+    values.push_back(Value(TypeId::INTEGER, i));
+    for (int j = 0; j < 3; j++)
+      values.push_back(Value(TypeId::VARCHAR, std::string(30, 'b' + j)));
+    values.push_back(Value(TypeId::BIGINT, static_cast<int64_t>(i)));
+    Tuple tuple(values, schema);
+    row_table->InsertTuple(tuple, rid, transaction);
+    pax_table->InsertTuple(tuple, rid, transaction);
+    expected_sum += i;
+  }
+
+  // sum of one column, read by a scan of each layout
+  double rates[2];
+  TableHeap *tables[2] = {row_table, pax_table};
+  for (int i = 0; i < 2; i++) {
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (TableBatchIterator itr(tables[i], transaction, {4}); !itr.IsEnd();
+         ++itr)
+      sum += itr->GetValue(schema, 4).GetAs<int64_t>();
+    double time = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    EXPECT_EQ(sum, expected_sum);
+    rates[i] = scale / time;
+  }
+  std::cout << "sum of a column: row pages " << (int64_t)rates[0]
+            << " rows/s, PAX pages " << (int64_t)rates[1] << " rows/s"
+            << std::endl;
+
+  delete pax_table;
+  delete row_table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
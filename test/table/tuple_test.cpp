@@ -12,6 +12,7 @@
 #include "logging/common.h"
 #include "table/table_heap.h"
 #include "table/tuple.h"
+#include "table/tuple_view.h"
 #include "vtable/virtual_table.h"
 #include "gtest/gtest.h"
 
@@ -61,4 +62,24 @@ TEST(TupleTest, TableHeapTest) {
   delete disk_manager;
 }
 
+TEST(TupleTest, TupleViewTest) {
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+  Tuple tuple = ConstructTuple(schema);
+  TupleView view(tuple);
+  EXPECT_EQ(view.GetLength(), tuple.GetLength());
+  for (int i = 0; i < schema->GetColumnCount(); i++) {
+    Value value = tuple.GetValue(schema, i);
+    Value view_value = view.GetValue(schema, i);
+    EXPECT_EQ(view_value.IsNull(), value.IsNull());
+    EXPECT_EQ(view_value.ToString(), value.ToString());
+  }
+  // varchar value points into tuple
+  Value varchar = view.GetValue(schema, 4);
+  EXPECT_GE(varchar.GetData(), tuple.GetData());
+  EXPECT_LT(varchar.GetData(), tuple.GetData() + tuple.GetLength());
+  delete schema;
+}
+
 } // namespace cmudb
@@ -1,8 +1,29 @@
 /**
  * virtual_table_test.cpp
  */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
 #include "vtable/testing_vtable_util.h"
 
+// global heap allocations made through operator new, by tests and by the
+// extension alike
+static std::atomic<int64_t> allocation_count(0);
+
+void *operator new(size_t size) {
+  allocation_count++;
+  void *ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
 namespace cmudb {
 /** Load the virtual table extension
  *  Ref: https://sqlite.org/c3ref/load_extension.html
@@ -78,4 +99,583 @@ TEST(VtableTest, CreateTest) {
   remove("vtable.db");
   return;
 }
+
+TEST(VtableTest, NonUniqueIndexTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  const char *zFile = "libvtable"; // shared library name
+  const char *zProc = 0;           // entry point within library
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, zFile, zProc, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable('a int, b "
+                          "int','foo_b b nonunique')"));
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo VALUES(" + std::to_string(i) +
+                                ", " + std::to_string(i % 3) + ")"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo WHERE a = 3"));
+
+  // every tuple sharing the key comes back from the index scan
+  sqlite3_stmt *stmt;
+  rc = sqlite3_prepare_v2(db, "SELECT a FROM foo WHERE b = 0", -1, &stmt,
+                          nullptr);
+  EXPECT_EQ(rc, SQLITE_OK);
+  int count = 0;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    EXPECT_EQ(sqlite3_column_int(stmt, 0) % 3, 0);
+    count++;
+  }
+  sqlite3_finalize(stmt);
+  EXPECT_EQ(count, 33);
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return;
+}
+TEST(VtableTest, VarcharIndexTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  const char *zFile = "libvtable"; // shared library name
+  const char *zProc = 0;           // entry point within library
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, zFile, zProc, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  // key size follows declared length, index on varchar(200) uses 256 bytes
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable('a "
+                          "varchar(200), b int','foo_pk a')"));
+  std::string padding(150, 'x');
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo VALUES('" + padding +
+                                std::to_string(i) + "', " + std::to_string(i) +
+                                ")"));
+  }
+  // values longer than declared length are rejected
+  EXPECT_FALSE(ExecSQL(db, "INSERT INTO foo VALUES('" + std::string(201, 'y') +
+                               "', 0)"));
+
+  sqlite3_stmt *stmt;
+  for (int i = 0; i < 100; i += 7) {
+    std::string sql =
+        "SELECT b FROM foo WHERE a = '" + padding + std::to_string(i) + "'";
+    rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    EXPECT_EQ(rc, SQLITE_OK);
+    EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), i);
+    EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+    sqlite3_finalize(stmt);
+  }
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return;
+}
+TEST(VtableTest, HashIndexTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  const char *zFile = "libvtable"; // shared library name
+  const char *zProc = 0;           // entry point within library
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, zFile, zProc, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable('a int, b "
+                          "varchar(16)','foo_b b nonunique using hash')"));
+  for (int i = 0; i < 300; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo VALUES(" + std::to_string(i) +
+                                ", 'key" + std::to_string(i % 7) + "')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo WHERE a < 7"));
+
+  sqlite3_stmt *stmt;
+  for (int k = 0; k < 7; k++) {
+    std::string sql =
+        "SELECT a FROM foo WHERE b = 'key" + std::to_string(k) + "'";
+    rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    EXPECT_EQ(rc, SQLITE_OK);
+    int count = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      EXPECT_EQ(sqlite3_column_int(stmt, 0) % 7, k);
+      count++;
+    }
+    sqlite3_finalize(stmt);
+    EXPECT_EQ(count, (300 - k + 6) / 7 - 1);
+  }
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return;
+}
+
+TEST(VtableTest, CoveringIndexTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  const char *zFile = "libvtable"; // shared library name
+  const char *zProc = 0;           // entry point within library
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, zFile, zProc, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable('a int, b "
+                          "varchar(16), c bigint','foo_a a include b "
+                          "nonunique')"));
+  // keys below 10 are shared by 11 tuples each, the rest by one
+  int scale = 300;
+  for (int i = 0; i < scale + 100; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo VALUES(" +
+                                std::to_string(i < scale ? i : i % 10) +
+                                ", 'b" + std::to_string(i) + "', " +
+                                std::to_string(i) + ")"));
+  }
+  // included columns follow updates and deletes
+  EXPECT_TRUE(ExecSQL(db, "UPDATE foo SET b = 'new' || b WHERE a % 3 = 0"));
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo WHERE a % 5 = 0"));
+
+  sqlite3_stmt *stmt;
+  for (int a = 0; a < scale; a++) {
+    // b alone is answered from index, c is read from table heap
+    for (std::string columns : {"b", "b, c"}) {
+      std::string sql = "SELECT " + columns + " FROM foo WHERE a = " +
+                        std::to_string(a);
+      rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+      EXPECT_EQ(rc, SQLITE_OK);
+      int count = 0;
+      while (sqlite3_step(stmt) == SQLITE_ROW) {
+        std::string b(
+            reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)));
+        std::string prefix = a % 3 == 0 ? "newb" : "b";
+        EXPECT_EQ(b.substr(0, prefix.size()), prefix);
+        int i = std::stoi(b.substr(prefix.size()));
+        EXPECT_EQ(i % (a < 10 ? 10 : scale), a);
+        if (columns == "b, c") {
+          EXPECT_EQ(sqlite3_column_int64(stmt, 1), i);
+        }
+        count++;
+      }
+      sqlite3_finalize(stmt);
+      EXPECT_EQ(count, a % 5 == 0 ? 0 : (a < 10 ? 11 : 1));
+    }
+  }
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return;
+}
+
+TEST(VtableTest, ClusteredTableTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  const char *zFile = "libvtable"; // shared library name
+  const char *zProc = 0;           // entry point within library
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, zFile, zProc, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable('b "
+                          "varchar(300), a bigint','foo_pk a clustered')"));
+  // rows with long b live in overflow pages
+  int scale = 300;
+  for (int i = scale - 1; i >= 0; i--) {
+    std::string b = "b" + std::to_string(i) + (i % 10 == 0 ? "long" : "");
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo VALUES('" + b +
+                                (i % 10 == 0 ? std::string(250, 'x') : "") +
+                                "', " + std::to_string(i) + ")"));
+  }
+  EXPECT_FALSE(ExecSQL(db, "INSERT INTO foo VALUES('dup', 1)"));
+  EXPECT_TRUE(ExecSQL(db, "UPDATE foo SET b = 'new' || b WHERE a % 3 = 0"));
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo WHERE a % 5 = 0"));
+  // primary key moves to a free one, and not to a taken one
+  EXPECT_TRUE(ExecSQL(db, "UPDATE foo SET a = 1001 WHERE a = 1"));
+  EXPECT_FALSE(ExecSQL(db, "UPDATE foo SET a = 2 WHERE a = 1001"));
+
+  sqlite3_stmt *stmt;
+  // table scan reads rows in primary key order
+  rc = sqlite3_prepare_v2(db, "SELECT a, b FROM foo", -1, &stmt, nullptr);
+  EXPECT_EQ(rc, SQLITE_OK);
+  int count = 0;
+  int64_t last = -1;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    int64_t a = sqlite3_column_int64(stmt, 0);
+    EXPECT_GT(a, last);
+    EXPECT_NE(a % 5, 0);
+    last = a;
+    count++;
+  }
+  sqlite3_finalize(stmt);
+  EXPECT_EQ(count, scale - scale / 5);
+  EXPECT_EQ(last, 1001);
+
+  for (int i = 0; i < scale; i++) {
+    std::string sql = "SELECT b FROM foo WHERE a = " + std::to_string(i);
+    rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    EXPECT_EQ(rc, SQLITE_OK);
+    int count = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      std::string b(
+          reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)));
+      EXPECT_EQ(b.substr(0, b.find("long")),
+                (i % 3 == 0 ? "newb" : "b") + std::to_string(i));
+      count++;
+    }
+    sqlite3_finalize(stmt);
+    EXPECT_EQ(count, i % 5 == 0 || i == 1 ? 0 : 1);
+  }
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return;
+}
+
+TEST(VtableTest, LongVarcharTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  const char *zFile = "libvtable"; // shared library name
+  const char *zProc = 0;           // entry point within library
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, zFile, zProc, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  // rows are longer than a page
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable('a int, b "
+                          "varchar(2000)','foo_a a')"));
+  int scale = 100;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo VALUES(" + std::to_string(i) +
+                                ", '" + std::string(1000 + i, 'b') + "')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "UPDATE foo SET b = 'short' WHERE a % 2 = 0"));
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo WHERE a % 3 = 0"));
+
+  sqlite3_stmt *stmt;
+  // by index and by scan
+  for (std::string sql : {"SELECT a, b FROM foo WHERE a = ?",
+                          "SELECT a, b FROM foo WHERE a + 0 = ?"}) {
+    rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    EXPECT_EQ(rc, SQLITE_OK);
+    for (int a = 0; a < scale; a++) {
+      sqlite3_bind_int(stmt, 1, a);
+      if (a % 3 == 0) {
+        EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+      } else {
+        EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+        EXPECT_EQ(std::string(reinterpret_cast<const char *>(
+                      sqlite3_column_text(stmt, 1))),
+                  a % 2 == 0 ? "short" : std::string(1000 + a, 'b'));
+      }
+      sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+  }
+  rc = sqlite3_prepare_v2(db, "SELECT count(*) FROM foo", -1, &stmt, nullptr);
+  EXPECT_EQ(rc, SQLITE_OK);
+  EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+  EXPECT_EQ(sqlite3_column_int(stmt, 0), scale - (scale + 2) / 3);
+  sqlite3_finalize(stmt);
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return;
+}
+
+TEST(VtableTest, InsertAllocationBenchmark) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  const char *zFile = "libvtable"; // shared library name
+  const char *zProc = 0;           // entry point within library
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, zFile, zProc, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable('a int, b "
+                          "varchar(32), c bigint','foo_a a')"));
+  sqlite3_stmt *stmt;
+  rc = sqlite3_prepare_v2(db, "INSERT INTO foo VALUES(?, ?, ?)", -1, &stmt,
+                          nullptr);
+  EXPECT_EQ(rc, SQLITE_OK);
+  // heap allocations per row made while inserting, sqlite allocates with
+  // malloc and is not counted
+  int scale = 50000;
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  int64_t start_count = allocation_count;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < scale; i++) {
+    std::string b = "row number " + std::to_string(i);
+    sqlite3_bind_int(stmt, 1, i);
+    sqlite3_bind_text(stmt, 2, b.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 3, i);
+    EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+    sqlite3_reset(stmt);
+  }
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  int64_t count = allocation_count - start_count;
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+  sqlite3_finalize(stmt);
+  std::cout << (double)count / scale << " allocations/row, "
+            << (int64_t)(scale / elapsed) << " inserts/s" << std::endl;
+
+  rc = sqlite3_prepare_v2(db, "SELECT b FROM foo WHERE a = 4242", -1, &stmt,
+                          nullptr);
+  EXPECT_EQ(rc, SQLITE_OK);
+  EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+  EXPECT_EQ(std::string(reinterpret_cast<const char *>(
+                sqlite3_column_text(stmt, 0))),
+            "row number 4242");
+  sqlite3_finalize(stmt);
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return;
+}
+
+TEST(VtableTest, PredicatePushdownTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  const char *zFile = "libvtable"; // shared library name
+  const char *zProc = 0;           // entry point within library
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, zFile, zProc, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  // index on b is of no use to range predicates
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable('a int, b "
+                          "bigint, c smallint, d double, e varchar(8)','foo_b "
+                          "b')"));
+  int scale = 1000;
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < scale; i++) {
+    // every 10th c is null
+    std::string c = i % 10 == 0 ? "NULL" : std::to_string(i % 100 - 50);
+    EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo VALUES(" + std::to_string(i) +
+                                ", " + std::to_string(i * 1000000000LL) +
+                                ", " + c + ", " + std::to_string(i * 0.5) +
+                                ", 'e')"));
+  }
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+
+  sqlite3_stmt *stmt;
+  // pushed down as column 0 and GT
+  rc = sqlite3_prepare_v2(
+      db, "EXPLAIN QUERY PLAN SELECT count(*) FROM foo WHERE a > 100", -1,
+      &stmt, nullptr);
+  EXPECT_EQ(rc, SQLITE_OK);
+  EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+  EXPECT_NE(std::string(reinterpret_cast<const char *>(
+                            sqlite3_column_text(stmt, 3)))
+                .find("INDEX 3:0 3"),
+            std::string::npos);
+  sqlite3_finalize(stmt);
+  // the same count with predicates pushed down and evaluated by SQLite
+  for (std::string predicate :
+       {"a > 100 AND a <= 200", "a >= 990", "a = 5", "a < 0", "b >= 5e11",
+        "b > 500000000000 AND a < 700", "c < -40", "c >= 0 AND a > 300",
+        "d > 100.25", "d <= 3", "d = 12.5", "a > 2.5", "a > '997'",
+        "c > -1000", "a > 10 AND e = 'e'", "a > NULL"}) {
+    int counts[2];
+    int j = 0;
+    for (std::string sql : {"SELECT count(*) FROM foo WHERE " + predicate,
+                            "SELECT count(*) FROM (SELECT * FROM foo LIMIT "
+                            "-1) WHERE " +
+                                predicate}) {
+      rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+      EXPECT_EQ(rc, SQLITE_OK);
+      EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+      counts[j++] = sqlite3_column_int(stmt, 0);
+      sqlite3_finalize(stmt);
+    }
+    EXPECT_EQ(counts[0], counts[1]) << predicate;
+  }
+  rc = sqlite3_prepare_v2(db, "SELECT a FROM foo WHERE a > ? AND a < ?", -1,
+                          &stmt, nullptr);
+  EXPECT_EQ(rc, SQLITE_OK);
+  // rewound for each binding
+  for (int i = 0; i < 3; i++) {
+    sqlite3_bind_int(stmt, 1, i * 100);
+    sqlite3_bind_int(stmt, 2, i * 100 + 3);
+    for (int a = i * 100 + 1; a < i * 100 + 3; a++) {
+      EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+      EXPECT_EQ(sqlite3_column_int(stmt, 0), a);
+    }
+    EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+    sqlite3_reset(stmt);
+  }
+  sqlite3_finalize(stmt);
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return;
+}
+
+TEST(VtableTest, PredicatePushdownBenchmark) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  const char *zFile = "libvtable"; // shared library name
+  const char *zProc = 0;           // entry point within library
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, zFile, zProc, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo USING vtable('a int, b "
+                          "varchar(32), c bigint','foo_a a')"));
+  sqlite3_stmt *stmt;
+  rc = sqlite3_prepare_v2(db, "INSERT INTO foo VALUES(?, ?, ?)", -1, &stmt,
+                          nullptr);
+  EXPECT_EQ(rc, SQLITE_OK);
+  int scale = 50000;
+  EXPECT_TRUE(ExecSQL(db, "BEGIN"));
+  for (int i = 0; i < scale; i++) {
+    std::string b = "row number " + std::to_string(i);
+    sqlite3_bind_int(stmt, 1, i);
+    sqlite3_bind_text(stmt, 2, b.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 3, i % 100);
+    EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+    sqlite3_reset(stmt);
+  }
+  EXPECT_TRUE(ExecSQL(db, "COMMIT"));
+  sqlite3_finalize(stmt);
+
+  // 1% of rows qualify, c + 0 is an expression SQLite evaluates itself
+  double rates[2];
+  int j = 0;
+  for (std::string sql : {"SELECT count(b) FROM foo WHERE c < 1",
+                          "SELECT count(b) FROM foo WHERE c + 0 < 1"}) {
+    rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    EXPECT_EQ(rc, SQLITE_OK);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    double elapsed = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), scale / 100);
+    sqlite3_finalize(stmt);
+    rates[j++] = scale / elapsed;
+  }
+  std::cout << "filtered scan: pushed down " << (int64_t)rates[0]
+            << " rows/s, by SQLite " << (int64_t)rates[1] << " rows/s"
+            << std::endl;
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  return;
+}
 } // namespace cmudb